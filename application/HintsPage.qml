@@ -29,18 +29,22 @@ Kirigami.Page {
     property var modelCreatedObject
     property var filteredModel
 
-    Component.onCompleted: {
-        createHintModel()
+    Mycroft.SkillIndex {
+        id: skillIndex
+        rootPath: '/opt/mycroft/skills'
+        metaFile: "README.md"
+        onScanned: {
+            createHintModel()
+            filteredModel = filterModel(filterHints.text.toLowerCase())
+        }
     }
 
     function createHintModel(){
         var hintList = []
-        var defaultFold = '/opt/mycroft/skills'
-        var fileToFind = "README.md"
-        var getList = Mycroft.FileReader.checkForMeta(defaultFold, fileToFind)
-        for(var i=0; i < getList.length; i++){
-            var fileName = getList[i] + "/" + fileToFind;
-            var fileParse = Mycroft.FileReader.read(fileName);
+        for(var i=0; i < skillIndex.count; i++){
+            var skill = skillIndex.get(i);
+            var fileName = skill.metaPath;
+            var fileParse = skill.metaContent;
             console.log("Loading hints from", fileName);
             var matchedRegex = getDataFromRegex(fileName, fileParse, /<img[^>]*src='([^']*)'.*\/>\s(.*)/g)
             var matchedExamples = getDataFromRegex(fileName, fileParse, /## Examples.*\n.*"(.*)"\n\*\s"(.*)"/g)
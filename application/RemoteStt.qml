@@ -31,6 +31,11 @@ Item {
     Connections {
         target: Mycroft.AudioRec
 
+        onSpeechEnded: {
+            // The recording already stopped by itself
+            audrectimer.running = false
+        }
+
         onMicAudioLevelChanged: {
             animatedCircle.width = Kirigami.Units.iconSizes.large + (Kirigami.Units.iconSizes.smallMedium * micLevel)
         }
@@ -39,8 +44,11 @@ Item {
             switch(recStatus){
             case "Completed":
                 console.log("In Completed")
-                Mycroft.AudioRec.readStream()
-                sendAudioClip()
+                // Streamed utterances are already on the other side
+                if (!Mycroft.AudioRec.streaming) {
+                    Mycroft.AudioRec.readStream()
+                    sendAudioClip()
+                }
                 audioRecorder.close()
                 break;
             case "Error":
@@ -134,5 +134,24 @@ Kirigami.ScrollablePage {
             checked: Mycroft.GlobalSettings.useHivemindProtocol
             onCheckedChanged: Mycroft.GlobalSettings.useHivemindProtocol = checked
         }
+
+        Controls.Switch {
+            text: "Stream Microphone"
+            checked: Mycroft.GlobalSettings.streamMicrophone
+            onCheckedChanged: Mycroft.GlobalSettings.streamMicrophone = checked
+            visible: Mycroft.GlobalSettings.displayRemoteConfig
+        }
+
+        Controls.Switch {
+            text: "Restore Last Screen"
+            checked: Mycroft.GlobalSettings.sessionSnapshot
+            onCheckedChanged: Mycroft.GlobalSettings.sessionSnapshot = checked
+        }
+
+        Controls.Switch {
+            text: "Hardware Video Decoding (after restart)"
+            checked: Mycroft.GlobalSettings.hardwareVideoDecoders
+            onCheckedChanged: Mycroft.GlobalSettings.hardwareVideoDecoders = checked
+        }
     }
 }
@@ -16,15 +16,19 @@
  *
  */
 
-#include <QQuickView>
 #include <QCommandLineParser>
 #include <QCommandLineOption>
 #include <QQmlContext>
 #include <QtQml>
 #include <QDebug>
 #include <QCursor>
+#include <QElapsedTimer>
+#include <QQuickWindow>
+#include <QTimer>
 #include <QtWebView/QtWebView>
 
+#include <cstdio>
+
 #ifdef Q_OS_ANDROID
 #include <QGuiApplication>
 #include <QtAndroid>
@@ -40,9 +44,29 @@
 #include "appsettings.h"
 #include "version.h"
 
+// Time since the process started, when --trace-startup is given
+static QElapsedTimer s_startupTimer;
+static bool s_traceStartup = false;
+
+static void traceStartup(const char *phase)
+{
+    static qint64 last = 0;
+    if (!s_traceStartup) {
+        return;
+    }
+
+    const qint64 now = s_startupTimer.nsecsElapsed() / 1000;
+    fprintf(stderr, "startup: %8.2fms (+%7.2fms) %s\n", now / 1000.0, (now - last) / 1000.0, phase);
+    last = now;
+}
+
 int main(int argc, char *argv[])
 {
+    s_startupTimer.start();
+
     QGuiApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+    // Lets the web view initialize after the first window, as it needs contexts shared with it
+    QGuiApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
 
     QStringList arguments;
     for (int a = 0; a < argc; ++a) {
@@ -58,12 +82,16 @@ int main(int argc, char *argv[])
     auto skillOption = QCommandLineOption(QStringLiteral("skill"), QStringLiteral("Single skill to load"), QStringLiteral("skill"));
     auto maximizeOption = QCommandLineOption(QStringLiteral("maximize"), QStringLiteral("When set, start maximized."));
     auto rotateScreen = QCommandLineOption(QStringLiteral("rotateScreen"), QStringLiteral("When set, rotate the screen by set degrees."), QStringLiteral("degrees"));
+    auto traceStartupOption = QCommandLineOption(QStringLiteral("trace-startup"), QStringLiteral("Print how long each phase of the startup takes"));
     auto helpOption = QCommandLineOption(QStringLiteral("help"), QStringLiteral("Show this help message"));
     parser.addOptions({widthOption, heightOption, hideTextInputOption, skillOption,
                        dpiOption, maximizeOption,
-                       rotateScreen, helpOption});
+                       rotateScreen, traceStartupOption, helpOption});
     parser.process(arguments);
 
+    s_traceStartup = parser.isSet(traceStartupOption);
+    traceStartup("arguments parsed");
+
 
     qputenv("QT_WAYLAND_FORCE_DPI", parser.value(dpiOption).toLatin1());
 
@@ -76,6 +104,7 @@ int main(int argc, char *argv[])
     app.setApplicationName(QStringLiteral("mycroft.gui"));
     app.setOrganizationDomain(QStringLiteral("kde.org"));
     app.setWindowIcon(QIcon::fromTheme(QStringLiteral("mycroft")));
+    traceStartup("application created");
     
 #ifdef Q_OS_ANDROID
     KeyFilter *kf = new KeyFilter;
@@ -90,16 +119,13 @@ int main(int argc, char *argv[])
         return 0;
     }
 
-    QtWebView::initialize();
-
-    QQuickView view;
-    view.setResizeMode(QQuickView::SizeRootObjectToView);
     int width = parser.value(widthOption).toInt();
     int height = parser.value(heightOption).toInt();
     int rotation = parser.value(rotateScreen).toInt();
     bool maximize = parser.isSet(maximizeOption);
 
     QQmlApplicationEngine engine;
+    traceStartup("qml engine created");
     engine.rootContext()->setContextProperty(QStringLiteral("deviceWidth"), width);
     engine.rootContext()->setContextProperty(QStringLiteral("deviceHeight"), height);
     engine.rootContext()->setContextProperty(QStringLiteral("deviceMaximized"), maximize);
@@ -132,12 +158,38 @@ int main(int argc, char *argv[])
     }
 #endif
 
-    AppSettings *appSettings = new AppSettings(&view);
+    AppSettings *appSettings = new AppSettings(&engine);
     engine.rootContext()->setContextProperty(QStringLiteral("applicationSettings"), appSettings);
 
     qmlRegisterType<SpeechIntent>("org.kde.private.mycroftgui", 1, 0, "SpeechIntent");
 
+    traceStartup("context set up");
     engine.load(QUrl(QStringLiteral("qrc:/main.qml")));
+    traceStartup("main.qml loaded");
+
+    // Loading the web view backend takes long and nothing needs it before a skill shows up:
+    // it waits until the first frame is on screen
+    QQuickWindow *window = engine.rootObjects().isEmpty() ? nullptr : qobject_cast<QQuickWindow *>(engine.rootObjects().first());
+    if (window) {
+        auto connection = QSharedPointer<QMetaObject::Connection>::create();
+        *connection = QObject::connect(window, &QQuickWindow::frameSwapped, &app, [connection]() {
+            // Other frames may have been queued already
+            if (!*connection) {
+                return;
+            }
+            QObject::disconnect(*connection);
+            *connection = QMetaObject::Connection();
+            traceStartup("first frame");
+            // Back to the event loop first, the frame is still being presented
+            QTimer::singleShot(0, []() {
+                QtWebView::initialize();
+                traceStartup("web view initialized");
+            });
+        }, Qt::QueuedConnection);
+    } else {
+        QtWebView::initialize();
+        traceStartup("web view initialized");
+    }
 
 #ifdef Q_OS_ANDROID
     QtAndroid::runOnAndroidThread([=]() {
@@ -250,6 +250,7 @@ Kirigami.ApplicationWindow {
             Mycroft.SkillView {
                 id: mainView
                 activeSkills.whiteList: singleSkill.length > 0 ? singleSkill : null
+                snapshotName: Mycroft.GlobalSettings.sessionSnapshot ? "main" : ""
                 Kirigami.Theme.colorSet: nightSwitch.checked ? Kirigami.Theme.Complementary : Kirigami.Theme.View
                 anchors.fill: parent
             }
@@ -301,6 +302,9 @@ Kirigami.ApplicationWindow {
 
                 Connections {
                     target: Mycroft.MycroftController
+                    // The controller only forwards the message types somebody asked for
+                    Component.onCompleted: Mycroft.MycroftController.subscribeIntent("recognizer_loop:utterance")
+                    Component.onDestruction: Mycroft.MycroftController.unsubscribeIntent("recognizer_loop:utterance")
                     onIntentRecevied: {
                         if(type == "recognizer_loop:utterance") {
                             inputQuery.text = data.utterances[0]
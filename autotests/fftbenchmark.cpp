@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <QtTest>
+
+#include "../import/thirdparty/fft.h"
+#include "../import/thirdparty/fftcalc.h"
+
+class FFTBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testRealTransform();
+    void testComplexTransform();
+    void benchmarkRecursive();
+    void benchmarkComplex();
+    void benchmarkReal();
+    void benchmarkBufferProcessor();
+
+private:
+    std::vector<double> m_samples;
+};
+
+void FFTBenchmark::initTestCase()
+{
+    // Something audio like: a couple of tones and some noise
+    m_samples.resize(SPECSIZE);
+    for (int i = 0; i < SPECSIZE; ++i) {
+        m_samples[i] = 0.6 * sin(2 * PI * 440 * i / 16000.0) + 0.3 * sin(2 * PI * 3000 * i / 16000.0)
+            + 0.1 * sin(0.37 * i * i);
+    }
+}
+
+void FFTBenchmark::testRealTransform()
+{
+    CArray reference(SPECSIZE);
+    for (int i = 0; i < SPECSIZE; ++i) {
+        reference[i] = Complex(m_samples[i], 0);
+    }
+    fft(reference);
+
+    FFTEngine engine(SPECSIZE);
+    std::vector<Complex> bins(SPECSIZE / 2 + 1);
+    engine.transformReal(m_samples.data(), bins.data());
+
+    for (int k = 0; k <= SPECSIZE / 2; ++k) {
+        QVERIFY2(std::abs(bins[k] - reference[k]) < 1e-9, qPrintable(QString::number(k)));
+    }
+}
+
+void FFTBenchmark::testComplexTransform()
+{
+    std::vector<Complex> values(SPECSIZE);
+    CArray reference(SPECSIZE);
+    for (int i = 0; i < SPECSIZE; ++i) {
+        values[i] = Complex(m_samples[i], m_samples[SPECSIZE - 1 - i]);
+        reference[i] = values[i];
+    }
+    fft(reference);
+
+    FFTEngine engine(SPECSIZE);
+    engine.transform(values.data());
+
+    for (int k = 0; k < SPECSIZE; ++k) {
+        QVERIFY2(std::abs(values[k] - reference[k]) < 1e-9, qPrintable(QString::number(k)));
+    }
+}
+
+void FFTBenchmark::benchmarkRecursive()
+{
+    CArray frame(SPECSIZE);
+
+    QBENCHMARK {
+        for (int i = 0; i < SPECSIZE; ++i) {
+            frame[i] = Complex(m_samples[i], 0);
+        }
+        fft(frame);
+    }
+}
+
+void FFTBenchmark::benchmarkComplex()
+{
+    FFTEngine engine(SPECSIZE);
+    std::vector<Complex> frame(SPECSIZE);
+
+    QBENCHMARK {
+        for (int i = 0; i < SPECSIZE; ++i) {
+            frame[i] = Complex(m_samples[i], 0);
+        }
+        engine.transform(frame.data());
+    }
+}
+
+void FFTBenchmark::benchmarkReal()
+{
+    FFTEngine engine(SPECSIZE);
+    std::vector<Complex> bins(SPECSIZE / 2 + 1);
+
+    QBENCHMARK {
+        engine.transformReal(m_samples.data(), bins.data());
+    }
+}
+
+void FFTBenchmark::benchmarkBufferProcessor()
+{
+    BufferProcessor processor;
+    std::vector<float> chunk(SPECSIZE);
+    for (int i = 0; i < SPECSIZE; ++i) {
+        chunk[i] = float(m_samples[i]);
+    }
+    processor.ringSampleRate.store(16000);
+
+    // A chunk played, then the tick of the processing timer picking it up
+    QBENCHMARK {
+        processor.ring.push(chunk.data(), chunk.size());
+        QMetaObject::invokeMethod(&processor, "run", Qt::DirectConnection);
+    }
+
+    QVERIFY(processor.spectrumPending.load());
+}
+
+QTEST_GUILESS_MAIN(FFTBenchmark);
+
+#include "fftbenchmark.moc"
@@ -0,0 +1,469 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQmlEngine>
+#include <QTemporaryDir>
+#include "../import/abstractdelegate.h"
+#include "../import/abstractskillview.h"
+#include "../import/activeskillsmodel.h"
+#include "../import/guimessage.h"
+#include "../import/sessiondatamodel.h"
+
+#include <cstdio>
+
+// In abstractskillview.cpp, not declared in any header
+QList<QVariantMap> variantListToOrderedMap(const QVariantList &data);
+
+class ImportBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkDispatch_data();
+    void benchmarkDispatch();
+    void benchmarkVariantListToOrderedMap_data();
+    void benchmarkVariantListToOrderedMap();
+    void benchmarkSessionInsertData_data();
+    void benchmarkSessionInsertData();
+    void benchmarkSessionUpdateData_data();
+    void benchmarkSessionUpdateData();
+    void benchmarkSessionMoveRows_data();
+    void benchmarkSessionMoveRows();
+    void benchmarkSessionData_data();
+    void benchmarkSessionData();
+    void benchmarkActiveSkillsInsertRemove_data();
+    void benchmarkActiveSkillsInsertRemove();
+    void benchmarkActiveSkillsMove_data();
+    void benchmarkActiveSkillsMove();
+
+private:
+    // Same steps as the socket thread and the view, without the thread hop
+    void dispatch(const QByteArray &frame);
+
+    QTemporaryDir m_dir;
+    QUrl m_delegateUrl;
+    QQmlEngine *m_engine = nullptr;
+    AbstractSkillView *m_view = nullptr;
+};
+
+static QVariantList variantRows(int count, const QString &title)
+{
+    QVariantList rows;
+    rows.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        QVariantMap row;
+        row[QStringLiteral("title")] = QStringLiteral("%1 %2").arg(title).arg(i);
+        row[QStringLiteral("subtitle")] = QStringLiteral("Subtitle %1").arg(i);
+        row[QStringLiteral("index")] = i;
+        row[QStringLiteral("selected")] = i % 2 == 0;
+        rows << row;
+    }
+
+    return rows;
+}
+
+static QList<QVariantMap> mapRows(int count, const QString &title)
+{
+    QList<QVariantMap> rows;
+    rows.reserve(count);
+
+    for (const auto &row : variantRows(count, title)) {
+        rows << row.toMap();
+    }
+
+    return rows;
+}
+
+static QStringList skillIds(int count)
+{
+    QStringList skills;
+    skills.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        skills << QStringLiteral("mycroft.bench.skill%1").arg(i);
+    }
+
+    return skills;
+}
+
+static QByteArray frame(const QString &type, const QString &skillId, QVariantMap fields)
+{
+    fields[QStringLiteral("type")] = type;
+    fields[QStringLiteral("namespace")] = skillId;
+
+    return QJsonDocument(QJsonObject::fromVariantMap(fields)).toJson(QJsonDocument::Compact);
+}
+
+static QVariantList skillList(const QStringList &skills)
+{
+    QVariantList list;
+    for (const auto &skillId : skills) {
+        list << QVariantMap({{QStringLiteral("skill_id"), skillId}});
+    }
+    return list;
+}
+
+static QVariantList urlList(const QUrl &url, int count)
+{
+    QVariantList list;
+    for (int i = 0; i < count; ++i) {
+        list << QVariantMap({{QStringLiteral("url"), url.toString()}});
+    }
+    return list;
+}
+
+static QtMessageHandler s_defaultMessageHandler = nullptr;
+
+// The handlers log every page they create: printed at every iteration, that
+// would be most of the output. Any other warning still shows up.
+static void filterChattyMessages(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    static const QStringList chatty = {
+        QStringLiteral("Arrived mycroft.gui.list.insert"),
+        QStringLiteral("Created a new DelegateLoader")
+    };
+
+    if (type == QtWarningMsg) {
+        for (const auto &prefix : chatty) {
+            if (message.startsWith(prefix)) {
+                return;
+            }
+        }
+    }
+
+    if (s_defaultMessageHandler) {
+        s_defaultMessageHandler(type, context, message);
+    } else {
+        fprintf(stderr, "%s\n", qPrintable(qFormatLogMessage(type, context, message)));
+    }
+}
+
+static void addRowCounts()
+{
+    QTest::addColumn<int>("rows");
+
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+static void addSkillCounts()
+{
+    QTest::addColumn<int>("skills");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+void ImportBenchmark::initTestCase()
+{
+    s_defaultMessageHandler = qInstallMessageHandler(filterChattyMessages);
+
+    qmlRegisterType<AbstractDelegate>("Mycroft", 1, 0, "AbstractDelegate");
+
+    QVERIFY(m_dir.isValid());
+    QFile delegateFile(m_dir.filePath(QStringLiteral("BenchDelegate.qml")));
+    QVERIFY(delegateFile.open(QIODevice::WriteOnly));
+    delegateFile.write("import Mycroft 1.0 as Mycroft\nMycroft.AbstractDelegate {}\n");
+    delegateFile.close();
+    m_delegateUrl = QUrl::fromLocalFile(delegateFile.fileName());
+
+    m_engine = new QQmlEngine(this);
+    m_view = new AbstractSkillView;
+    // As if the view was created from QML: the delegates get created in its engine
+    QQmlEngine::setContextForObject(m_view, m_engine->rootContext());
+
+    // Two skills, the first one with a list in its data and two pages
+    dispatch(frame(QStringLiteral("mycroft.session.list.insert"), QStringLiteral("mycroft.system.active_skills"),
+                   {{QStringLiteral("position"), 0},
+                    {QStringLiteral("data"), skillList({QStringLiteral("mycroft.bench"), QStringLiteral("mycroft.bench.second")})}}));
+    dispatch(frame(QStringLiteral("mycroft.session.set"), QStringLiteral("mycroft.bench"),
+                   {{QStringLiteral("data"), QVariantMap({{QStringLiteral("title"), QStringLiteral("Bench")},
+                                                          {QStringLiteral("items"), variantRows(1000, QStringLiteral("Item"))}})}}));
+    dispatch(frame(QStringLiteral("mycroft.gui.list.insert"), QStringLiteral("mycroft.bench"),
+                   {{QStringLiteral("position"), 0}, {QStringLiteral("data"), urlList(m_delegateUrl, 2)}}));
+
+    QCOMPARE(m_view->activeSkills()->rowCount(), 2);
+    QVERIFY(m_view->sessionDataForSkill(QStringLiteral("mycroft.bench"))->value(QStringLiteral("items")).value<SessionDataModel *>());
+}
+
+void ImportBenchmark::cleanupTestCase()
+{
+    delete m_view;
+}
+
+void ImportBenchmark::dispatch(const QByteArray &frame)
+{
+    m_view->dispatchGuiMessage(GuiMessage::fromJson(QJsonDocument::fromJson(frame).object()));
+}
+
+void ImportBenchmark::benchmarkDispatch_data()
+{
+    QTest::addColumn<QByteArrayList>("frames");
+    QTest::addColumn<bool>("resuming");
+
+    const QString skill = QStringLiteral("mycroft.bench");
+    const QString activeSkills = QStringLiteral("mycroft.system.active_skills");
+    const QString items = QStringLiteral("items");
+
+    // Every row leaves the view as it found it, or at least with the same size, for the next iteration
+    QTest::newRow("mycroft.session.set")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.set"), skill,
+                                 {{QStringLiteral("data"), QVariantMap({{QStringLiteral("temperature"), 21}, {QStringLiteral("condition"), QStringLiteral("Sunny")}})}}),
+                           frame(QStringLiteral("mycroft.session.set"), skill,
+                                 {{QStringLiteral("data"), QVariantMap({{QStringLiteral("temperature"), 22}, {QStringLiteral("condition"), QStringLiteral("Cloudy")}})}})})
+        << false;
+    QTest::newRow("mycroft.session.set (list)")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.set"), skill,
+                                 {{QStringLiteral("data"), QVariantMap({{QStringLiteral("forecast"), variantRows(100, QStringLiteral("Day"))}})}}),
+                           frame(QStringLiteral("mycroft.session.set"), skill,
+                                 {{QStringLiteral("data"), QVariantMap({{QStringLiteral("forecast"), variantRows(100, QStringLiteral("Night"))}})}})})
+        << false;
+    QTest::newRow("mycroft.session.delete")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.set"), skill,
+                                 {{QStringLiteral("data"), QVariantMap({{QStringLiteral("scratch"), 1}})}}),
+                           frame(QStringLiteral("mycroft.session.delete"), skill,
+                                 {{QStringLiteral("property"), QStringLiteral("scratch")}})})
+        << false;
+    QTest::newRow("mycroft.session.patch")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.patch"), skill,
+                                 {{QStringLiteral("data"), QVariantList({QVariantMap({{QStringLiteral("op"), QStringLiteral("replace")},
+                                                                                      {QStringLiteral("path"), QStringLiteral("/items/10/title")},
+                                                                                      {QStringLiteral("value"), QStringLiteral("Patched")}})})}})})
+        << false;
+    QTest::newRow("mycroft.session.list.insert")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.list.insert"), skill,
+                                 {{QStringLiteral("property"), items}, {QStringLiteral("position"), 0},
+                                  {QStringLiteral("data"), variantRows(10, QStringLiteral("New"))}}),
+                           frame(QStringLiteral("mycroft.session.list.remove"), skill,
+                                 {{QStringLiteral("property"), items}, {QStringLiteral("position"), 0}, {QStringLiteral("items_number"), 10}})})
+        << false;
+    QTest::newRow("mycroft.session.list.update")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.list.update"), skill,
+                                 {{QStringLiteral("property"), items}, {QStringLiteral("position"), 0},
+                                  {QStringLiteral("data"), variantRows(10, QStringLiteral("Updated"))}}),
+                           frame(QStringLiteral("mycroft.session.list.update"), skill,
+                                 {{QStringLiteral("property"), items}, {QStringLiteral("position"), 0},
+                                  {QStringLiteral("data"), variantRows(10, QStringLiteral("Item"))}})})
+        << false;
+    QTest::newRow("mycroft.session.list.move")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.list.move"), skill,
+                                 {{QStringLiteral("property"), items}, {QStringLiteral("from"), 999},
+                                  {QStringLiteral("to"), 0}, {QStringLiteral("items_number"), 1}})})
+        << false;
+    QTest::newRow("mycroft.session.list.paged")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.list.paged"), skill,
+                                 {{QStringLiteral("property"), QStringLiteral("paged")}, {QStringLiteral("items_number"), 1000},
+                                  {QStringLiteral("data"), variantRows(50, QStringLiteral("Page"))}})})
+        << false;
+    QTest::newRow("mycroft.system.active_skills insert")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.list.insert"), activeSkills,
+                                 {{QStringLiteral("position"), 2}, {QStringLiteral("data"), skillList({QStringLiteral("mycroft.bench.other")})}}),
+                           frame(QStringLiteral("mycroft.session.list.remove"), activeSkills,
+                                 {{QStringLiteral("position"), 2}, {QStringLiteral("items_number"), 1}})})
+        << false;
+    QTest::newRow("mycroft.system.active_skills move")
+        << QByteArrayList({frame(QStringLiteral("mycroft.session.list.move"), activeSkills,
+                                 {{QStringLiteral("from"), 1}, {QStringLiteral("to"), 0}, {QStringLiteral("items_number"), 1}})})
+        << false;
+    QTest::newRow("mycroft.gui.list.insert")
+        << QByteArrayList({frame(QStringLiteral("mycroft.gui.list.insert"), skill,
+                                 {{QStringLiteral("position"), 2}, {QStringLiteral("data"), urlList(m_delegateUrl, 1)}}),
+                           frame(QStringLiteral("mycroft.gui.list.remove"), skill,
+                                 {{QStringLiteral("position"), 2}, {QStringLiteral("items_number"), 1}})})
+        << false;
+    QTest::newRow("mycroft.gui.list.move")
+        << QByteArrayList({frame(QStringLiteral("mycroft.gui.list.move"), skill,
+                                 {{QStringLiteral("from"), 1}, {QStringLiteral("to"), 0}, {QStringLiteral("items_number"), 1}})})
+        << false;
+    QTest::newRow("mycroft.events.triggered")
+        << QByteArrayList({frame(QStringLiteral("mycroft.events.triggered"), skill,
+                                 {{QStringLiteral("event_name"), QStringLiteral("mycroft.bench.event")},
+                                  {QStringLiteral("data"), QVariantMap({{QStringLiteral("value"), 1}})}})})
+        << false;
+    QTest::newRow("mycroft.gui.resume")
+        << QByteArrayList({frame(QStringLiteral("mycroft.gui.resume"), QString(),
+                                 {{QStringLiteral("data"), QVariantMap({{QStringLiteral("accepted"), true}})}})})
+        << true;
+}
+
+void ImportBenchmark::benchmarkDispatch()
+{
+    QFETCH(QByteArrayList, frames);
+    QFETCH(bool, resuming);
+
+    QBENCHMARK {
+        for (const auto &bytes : frames) {
+            // Only expected after asking to resume, otherwise it's ignored
+            if (resuming) {
+                m_view->expectResumeReply();
+            }
+            dispatch(bytes);
+        }
+    }
+
+    QCOMPARE(m_view->activeSkills()->rowCount(), 2);
+
+    // The pages taken away during the run
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+void ImportBenchmark::benchmarkVariantListToOrderedMap_data()
+{
+    addRowCounts();
+}
+
+void ImportBenchmark::benchmarkVariantListToOrderedMap()
+{
+    QFETCH(int, rows);
+    const QVariantList data = variantRows(rows, QStringLiteral("Item"));
+
+    QBENCHMARK {
+        QCOMPARE(variantListToOrderedMap(data).count(), rows);
+    }
+}
+
+void ImportBenchmark::benchmarkSessionInsertData_data()
+{
+    addRowCounts();
+}
+
+void ImportBenchmark::benchmarkSessionInsertData()
+{
+    QFETCH(int, rows);
+    const QList<QVariantMap> data = mapRows(rows, QStringLiteral("Item"));
+
+    QBENCHMARK {
+        SessionDataModel model;
+        model.insertData(0, data);
+    }
+}
+
+void ImportBenchmark::benchmarkSessionUpdateData_data()
+{
+    addRowCounts();
+}
+
+void ImportBenchmark::benchmarkSessionUpdateData()
+{
+    QFETCH(int, rows);
+    SessionDataModel model;
+    model.insertData(0, mapRows(rows, QStringLiteral("Item")));
+
+    // Alternating, or from the second round on nothing would change
+    const QList<QVariantMap> updates[] = {mapRows(rows, QStringLiteral("Updated")), mapRows(rows, QStringLiteral("Item"))};
+    int round = 0;
+
+    QBENCHMARK {
+        model.updateData(0, updates[round++ % 2]);
+    }
+
+    QCOMPARE(model.rowCount(), rows);
+}
+
+void ImportBenchmark::benchmarkSessionMoveRows_data()
+{
+    addRowCounts();
+}
+
+void ImportBenchmark::benchmarkSessionMoveRows()
+{
+    QFETCH(int, rows);
+    SessionDataModel model;
+    model.insertData(0, mapRows(rows, QStringLiteral("Item")));
+
+    QBENCHMARK {
+        model.moveRows(QModelIndex(), rows - 1, 1, QModelIndex(), 0);
+    }
+
+    QCOMPARE(model.rowCount(), rows);
+}
+
+void ImportBenchmark::benchmarkSessionData_data()
+{
+    addRowCounts();
+}
+
+void ImportBenchmark::benchmarkSessionData()
+{
+    QFETCH(int, rows);
+    SessionDataModel model;
+    model.insertData(0, mapRows(rows, QStringLiteral("Item")));
+    const QList<int> roles = model.roleNames().keys();
+    int valid = 0;
+
+    // What a view scrolling through the whole list asks
+    QBENCHMARK {
+        for (int row = 0; row < rows; ++row) {
+            const QModelIndex index = model.index(row, 0);
+            for (const int role : roles) {
+                valid += model.data(index, role).isValid();
+            }
+        }
+    }
+
+    QVERIFY(valid > 0);
+}
+
+void ImportBenchmark::benchmarkActiveSkillsInsertRemove_data()
+{
+    addSkillCounts();
+}
+
+void ImportBenchmark::benchmarkActiveSkillsInsertRemove()
+{
+    QFETCH(int, skills);
+    ActiveSkillsModel model;
+    model.insertSkills(0, skillIds(skills));
+    const QStringList extra({QStringLiteral("mycroft.bench.extra")});
+
+    QBENCHMARK {
+        model.insertSkills(skills / 2, extra);
+        model.removeRows(skills / 2, 1);
+    }
+
+    QCOMPARE(model.rowCount(), skills);
+}
+
+void ImportBenchmark::benchmarkActiveSkillsMove_data()
+{
+    addSkillCounts();
+}
+
+void ImportBenchmark::benchmarkActiveSkillsMove()
+{
+    QFETCH(int, skills);
+    ActiveSkillsModel model;
+    model.insertSkills(0, skillIds(skills));
+
+    // The last one used coming back in front
+    QBENCHMARK {
+        model.moveRows(QModelIndex(), skills - 1, 1, QModelIndex(), 0);
+    }
+
+    QCOMPARE(model.rowCount(), skills);
+}
+
+QTEST_MAIN(ImportBenchmark);
+
+#include "importbenchmark.moc"
@@ -21,7 +21,11 @@
 #include <QAbstractItemModel>
 #include <QQuickView>
 #include <QQmlEngine>
+#include <QQmlComponent>
 #include <QAbstractItemModelTester>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
 #include "../import/mycroftcontroller.h"
 #include "../import/abstractdelegate.h"
 #include "../import/filereader.h"
@@ -31,6 +35,18 @@
 #include "../import/abstractskillview.h"
 #include "../import/sessiondatamap.h"
 #include "../import/sessiondatamodel.h"
+#include "../import/sessiondatapatch.h"
+#include "../import/sessionstore.h"
+#include "../import/componentcache.h"
+#include "../import/connectionmonitor.h"
+#include "../import/ttscache.h"
+#include "../import/sessionsnapshot.h"
+#include "../import/settingsstore.h"
+#include "../import/skillindex.h"
+#include "../import/imageprovider.h"
+#include "../import/metrics.h"
+#include "../import/trafficrecorder.h"
+#include "../import/ttsplayer.h"
 
 class ModelTest : public QObject
 {
@@ -43,6 +59,21 @@ private Q_SLOTS:
     void testActiveSkillsModel();
     void testDelegatesModel();
     void testSessionDataModel();
+    void testSessionDataModelReplace();
+    void testSessionDataModelPaged();
+    void testComponentCache();
+    void testSessionDataSerialize();
+    void testSessionDataPatch();
+    void testTtsWavHeader();
+    void testBackoffDelay();
+    void testSessionStore();
+    void testTtsCache();
+    void testSessionSnapshot();
+    void testSettingsStore();
+    void testSkillIndex();
+    void testImageProvider();
+    void testMetrics();
+    void testTrafficRecorder();
 
 private:
     AbstractSkillView *m_view;
@@ -73,6 +104,25 @@ void ModelTest::testActiveSkillsModel()
     m_skillsModel->moveRows(QModelIndex(), 0, 2, QModelIndex(), 4);
     m_skillsModel->removeRows(1, 2);
     m_skillsModel->insertSkills(2, QStringList({QStringLiteral("newSkill")}));
+
+    // The row index follows inserts, moves and removals
+    for (int i = 0; i < m_skillsModel->rowCount(); ++i) {
+        const QString skillId = m_skillsModel->data(m_skillsModel->index(i, 0)).toString();
+        QCOMPARE(m_skillsModel->skillIndex(skillId).row(), i);
+    }
+    QVERIFY(!m_skillsModel->skillIndex(QStringLiteral("skill1")).isValid());
+
+    // Skills already there, or repeated, are inserted only once
+    const int count = m_skillsModel->rowCount();
+    m_skillsModel->insertSkills(0, QStringList({QStringLiteral("newSkill"), QStringLiteral("other"), QStringLiteral("other")}));
+    QCOMPARE(m_skillsModel->rowCount(), count + 1);
+    QCOMPARE(m_skillsModel->skillIndex(QStringLiteral("other")).row(), 0);
+    QCOMPARE(m_skillsModel->skillIndex(QStringLiteral("newSkill")).row(), 3);
+
+    m_skillsModel->setBlackList({QStringLiteral("other")});
+    QVERIFY(!m_skillsModel->skillAllowed(QStringLiteral("other")));
+    QVERIFY(m_skillsModel->skillAllowed(QStringLiteral("newSkill")));
+    m_skillsModel->setBlackList({});
 }
 
 void ModelTest::testDelegatesModel()
@@ -97,6 +147,663 @@ void ModelTest::testSessionDataModel()
     m_sessionDataModel->removeRows(1, 2);
     m_sessionDataModel->insertData(2, QList<QVariantMap> ({{{QStringLiteral("prop"), QStringLiteral("newValue")}}}));
     QCOMPARE(m_sessionDataModel->data(m_sessionDataModel->index(2, 0), m_sessionDataModel->roleNames().key("prop")).toString(), QStringLiteral("newValue"));
+    QCOMPARE(m_sessionDataModel->rowData(2), QVariantMap({{QStringLiteral("prop"), QStringLiteral("newValue")}}));
+    QVERIFY(!m_sessionDataModel->data(m_sessionDataModel->index(2, 0), Qt::UserRole + 2).isValid());
+}
+
+static QList<QVariantMap> itemsList(const QStringList &ids, const QString &value)
+{
+    QList<QVariantMap> list;
+    for (const auto &id : ids) {
+        list << QVariantMap({{QStringLiteral("id"), id}, {QStringLiteral("value"), value}});
+    }
+    return list;
+}
+
+void ModelTest::testSessionDataModelReplace()
+{
+    SessionDataModel model;
+    new QAbstractItemModelTester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest, this);
+
+    QSignalSpy resetSpy(&model, &SessionDataModel::modelReset);
+    QSignalSpy insertedSpy(&model, &SessionDataModel::rowsInserted);
+    QSignalSpy removedSpy(&model, &SessionDataModel::rowsRemoved);
+    QSignalSpy changedSpy(&model, &SessionDataModel::dataChanged);
+
+    const int idRole = Qt::UserRole + 1;
+    auto ids = [&model, idRole]() -> QStringList {
+        QStringList result;
+        for (int i = 0; i < model.rowCount(); ++i) {
+            result << model.data(model.index(i, 0), idRole).toString();
+        }
+        return result;
+    };
+
+    model.insertData(0, itemsList({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"), QStringLiteral("d")}, QStringLiteral("1")));
+    QCOMPARE(model.roleNames().value(idRole), QByteArray("id"));
+    insertedSpy.clear();
+
+    // Positional: same data means no notification at all
+    model.replaceData(itemsList({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"), QStringLiteral("d")}, QStringLiteral("1")));
+    QCOMPARE(changedSpy.count(), 0);
+
+    // Positional: only the changed row is notified, extra rows get removed
+    QList<QVariantMap> list = itemsList({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c")}, QStringLiteral("1"));
+    list[1][QStringLiteral("value")] = QStringLiteral("2");
+    model.replaceData(list);
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy.first().first().toModelIndex().row(), 1);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(ids(), QStringList({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c")}));
+
+    // Keyed: reorder, remove and insert without resetting
+    removedSpy.clear();
+    model.replaceData(itemsList({QStringLiteral("c"), QStringLiteral("e"), QStringLiteral("a")}, QStringLiteral("1")), QStringLiteral("id"));
+    QCOMPARE(ids(), QStringList({QStringLiteral("c"), QStringLiteral("e"), QStringLiteral("a")}));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(model.data(model.index(1, 0), idRole + 1).toString(), QStringLiteral("1"));
+
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+void ModelTest::testSessionDataModelPaged()
+{
+    SessionDataModel model;
+    new QAbstractItemModelTester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest, this);
+    QSignalSpy fetchSpy(&model, &SessionDataModel::fetchMoreRequested);
+
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+
+    model.insertData(0, itemsList({QStringLiteral("a"), QStringLiteral("b")}, QStringLiteral("1")));
+    model.setPaged(5, 2);
+    QCOMPARE(model.totalCount(), 5);
+    QVERIFY(model.canFetchMore(QModelIndex()));
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(fetchSpy.count(), 1);
+    QCOMPARE(fetchSpy.first(), QVariantList({2, 2}));
+
+    // The page is on its way, don't ask for it again
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    QCOMPARE(fetchSpy.count(), 1);
+
+    model.insertData(2, itemsList({QStringLiteral("c"), QStringLiteral("d")}, QStringLiteral("1")));
+    model.fetchMore(QModelIndex());
+    QCOMPARE(fetchSpy.count(), 2);
+    QCOMPARE(fetchSpy.last(), QVariantList({4, 1}));
+
+    model.insertData(4, itemsList({QStringLiteral("e")}, QStringLiteral("1")));
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+
+    // Items the server adds or removes change the total, fetched or not
+    model.setPaged(8, 2);
+    model.insertData(0, itemsList({QStringLiteral("z")}, QStringLiteral("1")));
+    QCOMPARE(model.totalCount(), 9);
+    model.insertData(7, itemsList({QStringLiteral("y")}, QStringLiteral("1")));
+    QCOMPARE(model.totalCount(), 10);
+    QCOMPARE(model.rowCount(), 6);
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(fetchSpy.last(), QVariantList({6, 2}));
+
+    // Only the page clears the pending fetch
+    model.insertData(1, itemsList({QStringLiteral("x")}, QStringLiteral("1")));
+    QCOMPARE(model.totalCount(), 11);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    model.insertData(6, itemsList({QStringLiteral("f"), QStringLiteral("g")}, QStringLiteral("1")));
+    QCOMPARE(model.totalCount(), 11);
+    QCOMPARE(model.rowCount(), 9);
+    QVERIFY(model.canFetchMore(QModelIndex()));
+
+    QVERIFY(model.removeRows(9, 2));
+    QCOMPARE(model.totalCount(), 9);
+    QCOMPARE(model.rowCount(), 9);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    QVERIFY(model.removeRows(0, 1));
+    QCOMPARE(model.totalCount(), 8);
+    QCOMPARE(model.listCount(), 8);
+    QVERIFY(!model.removeRows(7, 2));
+
+    // A full replacement ends the paged mode
+    model.setPaged(10, 2);
+    model.replaceData(itemsList({QStringLiteral("a")}, QStringLiteral("1")));
+    QCOMPARE(model.totalCount(), -1);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+}
+
+void ModelTest::testComponentCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QList<QUrl> urls;
+    for (int i = 0; i < 3; ++i) {
+        QFile file(dir.filePath(QStringLiteral("delegate%1.qml").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("import QtQml 2.2\nQtObject {}\n");
+        file.close();
+        urls << QUrl::fromLocalFile(file.fileName());
+    }
+
+    QQmlEngine engine;
+    ComponentCache cache;
+    cache.setCapacity(2);
+
+    QQmlComponent *component = cache.acquire(&engine, urls[0]);
+    QVERIFY(component->isReady());
+    QCOMPARE(cache.acquire(&engine, urls[0]), component);
+    QCOMPARE(cache.misses(), quint64(1));
+    QCOMPARE(cache.hits(), quint64(1));
+    cache.release(&engine, urls[0]);
+    cache.release(&engine, urls[0]);
+
+    // urls[0] is now the coldest unused one
+    cache.acquire(&engine, urls[1]);
+    cache.acquire(&engine, urls[2]);
+    QCOMPARE(cache.count(), 2);
+    cache.acquire(&engine, urls[0]);
+    QCOMPARE(cache.misses(), quint64(4));
+
+    // Nothing gets evicted while still in use
+    QCOMPARE(cache.count(), 3);
+    cache.release(&engine, urls[1]);
+    QCOMPARE(cache.count(), 2);
+    cache.acquire(&engine, urls[2]);
+    QCOMPARE(cache.hits(), quint64(2));
+
+    // A preloaded component is already there when acquired
+    cache.setCapacity(3);
+    cache.preload(&engine, urls[1]);
+    QCOMPARE(cache.preloads(), quint64(1));
+    QQmlComponent *preloaded = cache.acquire(&engine, urls[1]);
+    QCOMPARE(cache.hits(), quint64(3));
+    QTRY_VERIFY(preloaded->isReady());
+
+    // The same url in another engine is another component, and the users of each are counted apart
+    QQmlEngine otherEngine;
+    QPointer<QQmlComponent> otherComponent = cache.acquire(&otherEngine, urls[1]);
+    QVERIFY(otherComponent != preloaded);
+    QCOMPARE(otherComponent->engine(), &otherEngine);
+    cache.release(&engine, urls[1]);
+    cache.release(&engine, urls[2]);
+    cache.release(&engine, urls[2]);
+    cache.release(&engine, urls[0]);
+    cache.setCapacity(0);
+    QVERIFY(otherComponent);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.acquire(&otherEngine, urls[1]), otherComponent.data());
+    cache.release(&otherEngine, urls[1]);
+    cache.release(&otherEngine, urls[1]);
+    QCOMPARE(cache.count(), 0);
+    QVERIFY(!otherComponent);
+}
+
+void ModelTest::testSessionDataSerialize()
+{
+    SessionDataMap map(QStringLiteral("mycroft.weather"), m_view);
+    map.insert(QStringLiteral("temperature"), QStringLiteral("24°C"));
+    SessionDataModel *model = new SessionDataModel(&map);
+    model->insertData(0, itemsList({QStringLiteral("a"), QStringLiteral("b")}, QStringLiteral("1")));
+    model->setPaged(10, 2);
+    map.insert(QStringLiteral("forecast"), QVariant::fromValue(model));
+
+    const QByteArray data = map.serialize();
+    QVERIFY(!data.isEmpty());
+
+    SessionDataMap restored(QStringLiteral("mycroft.weather"), m_view);
+    restored.restore(data);
+    QCOMPARE(restored.value(QStringLiteral("temperature")).toString(), QStringLiteral("24°C"));
+
+    SessionDataModel *restoredModel = restored.value(QStringLiteral("forecast")).value<SessionDataModel *>();
+    QVERIFY(restoredModel);
+    QCOMPARE(restoredModel->rowCount(), 2);
+    QCOMPARE(restoredModel->rowData(1), model->rowData(1));
+    QCOMPARE(restoredModel->roleNames(), model->roleNames());
+
+    // Still paged, the rest of the list is asked for again when scrolled to
+    QCOMPARE(restoredModel->totalCount(), 10);
+    QCOMPARE(restoredModel->pageSize(), 2);
+    QVERIFY(restoredModel->canFetchMore(QModelIndex()));
+    QSignalSpy fetchSpy(restoredModel, &SessionDataModel::fetchMoreRequested);
+    restoredModel->fetchMore(QModelIndex());
+    QCOMPARE(fetchSpy.count(), 1);
+    QCOMPARE(fetchSpy.first(), QVariantList({2, 2}));
+
+    // m_view isn't connected: the page isn't on its way, so it's asked again
+    restoredModel->fetchMore(QModelIndex());
+    QCOMPARE(fetchSpy.count(), 2);
+}
+
+void ModelTest::testSessionDataPatch()
+{
+    const auto patch = [](const QString &op, const QString &path) {
+        const QList<SessionDataPatch> patches = SessionDataPatch::fromVariant(QVariantList({QVariantMap({
+            {QStringLiteral("op"), op}, {QStringLiteral("path"), path}, {QStringLiteral("value"), 5}})}));
+        return patches.value(0);
+    };
+
+    QVariant details = QVariantMap({{QStringLiteral("wind"), QVariantMap({{QStringLiteral("speed"), 3}})}});
+
+    // Like remove, replace needs something already there, add doesn't
+    QVERIFY(!patch(QStringLiteral("replace"), QStringLiteral("/details/wind/direction")).applyTo(details, 1));
+    QVERIFY(!patch(QStringLiteral("remove"), QStringLiteral("/details/wind/direction")).applyTo(details, 1));
+    QVERIFY(!details.toMap().value(QStringLiteral("wind")).toMap().contains(QStringLiteral("direction")));
+    QVERIFY(patch(QStringLiteral("add"), QStringLiteral("/details/wind/direction")).applyTo(details, 1));
+    QVERIFY(patch(QStringLiteral("replace"), QStringLiteral("/details/wind/speed")).applyTo(details, 1));
+
+    const QVariantMap wind = details.toMap().value(QStringLiteral("wind")).toMap();
+    QCOMPARE(wind.value(QStringLiteral("direction")).toInt(), 5);
+    QCOMPARE(wind.value(QStringLiteral("speed")).toInt(), 5);
+}
+
+void ModelTest::testTtsWavHeader()
+{
+    const auto uint16 = [](quint16 value) {
+        const quint16 le = qToLittleEndian(value);
+        return QByteArray(reinterpret_cast<const char *>(&le), 2);
+    };
+    const auto uint32 = [](quint32 value) {
+        const quint32 le = qToLittleEndian(value);
+        return QByteArray(reinterpret_cast<const char *>(&le), 4);
+    };
+    const auto chunk = [&uint32](const QByteArray &id, quint32 size, const QByteArray &payload) {
+        return id + uint32(size) + payload;
+    };
+
+    // 16 bit mono at 22050 Hz, integer PCM
+    const QByteArray fmt = chunk("fmt ", 16, uint16(1) + uint16(1) + uint32(22050) + uint32(44100) + uint16(2) + uint16(16));
+    const QByteArray samples = QByteArray(8, '\x01');
+
+    QAudioFormat format;
+    QByteArray plain = "RIFF" + uint32(36 + samples.size()) + "WAVE" + fmt + chunk("data", samples.size(), samples);
+    QCOMPARE(TtsPlayer::parseWavHeader(plain, true, format), 44);
+    QCOMPARE(format.channelCount(), 1);
+    QCOMPARE(format.sampleRate(), 22050);
+    QCOMPARE(format.sampleSize(), 16);
+    QCOMPARE(format.sampleType(), QAudioFormat::SignedInt);
+
+    // Streamed: no sizes known, with an odd sized LIST chunk padded before the format
+    const QByteArray list = chunk("LIST", 3, QByteArray("abc") + '\0');
+    const QByteArray streamed = "RIFF" + uint32(0xffffffff) + "WAVE" + list + fmt + chunk("data", 0xffffffff, samples);
+    format = QAudioFormat();
+    QCOMPARE(TtsPlayer::parseWavHeader(streamed, false, format), 12 + list.size() + fmt.size() + 8);
+    QCOMPARE(format.sampleRate(), 22050);
+
+    // Cut in the middle of the header: more is needed, unless nothing more comes
+    const QByteArray head = streamed.left(12 + list.size() + 10);
+    QCOMPARE(TtsPlayer::parseWavHeader(head, false, format), 0);
+    QCOMPARE(TtsPlayer::parseWavHeader(head, true, format), -1);
+    QCOMPARE(TtsPlayer::parseWavHeader(streamed.left(6), false, format), 0);
+
+    // The samples before the format, a huge chunk before the samples, not WAV at all
+    QCOMPARE(TtsPlayer::parseWavHeader("RIFF" + uint32(0) + "WAVE" + chunk("data", 0, QByteArray()) + fmt, true, format), -1);
+    QCOMPARE(TtsPlayer::parseWavHeader("RIFF" + uint32(0) + "WAVE" + chunk("LIST", 0xfffffff0, QByteArray()) + fmt, false, format), -1);
+    QCOMPARE(TtsPlayer::parseWavHeader(QByteArrayLiteral("OggS and more than twelve bytes"), false, format), -1);
+
+    // Interleaved streams queue with their first piece. Nothing plays while the header
+    // of the first is incomplete, so this doesn't depend on having an audio device
+    TtsPlayer player;
+    player.appendChunk(QStringLiteral("a"), head.left(20), false);
+    player.appendChunk(QStringLiteral("b"), plain.left(10), false);
+    player.appendChunk(QStringLiteral("a"), head.mid(20), false);
+    QCOMPARE(player.queued(), 2);
+
+    // A finished stream id starts a new utterance
+    player.appendChunk(QStringLiteral("b"), plain.mid(10), true);
+    player.appendChunk(QStringLiteral("b"), plain, true);
+    QCOMPARE(player.queued(), 3);
+    QVERIFY(!player.isPlaying());
+
+    player.stop();
+    QCOMPARE(player.queued(), 0);
+
+    // A reserved place holds back what comes after it, until filled or released
+    player.reserve(QStringLiteral("first"));
+    player.appendChunk(QStringLiteral("second"), head.left(20), false);
+    player.appendChunk(QStringLiteral("first"), head.left(20), false);
+    QCOMPARE(player.queued(), 2);
+    player.release(QStringLiteral("second"));
+    QCOMPARE(player.queued(), 2);
+    player.reserve(QStringLiteral("third"));
+    player.release(QStringLiteral("third"));
+    QCOMPARE(player.queued(), 2);
+    player.stop();
+}
+
+void ModelTest::testBackoffDelay()
+{
+    for (int i = 0; i < 20; ++i) {
+        const int first = ConnectionMonitor::backoffDelay(0, 1000, 60000);
+        QVERIFY(first >= 500 && first <= 1000);
+
+        const int third = ConnectionMonitor::backoffDelay(2, 1000, 60000);
+        QVERIFY(third >= 2000 && third <= 4000);
+
+        // Capped, even for attempt counts that would overflow
+        const int late = ConnectionMonitor::backoffDelay(100, 1000, 60000);
+        QVERIFY(late >= 30000 && late <= 60000);
+    }
+}
+
+void ModelTest::testSessionStore()
+{
+    SessionStore store;
+    const QString skillId = QStringLiteral("mycroft.weather");
+
+    SessionDataMap *map = store.acquire(skillId, m_view);
+    QVERIFY(map);
+    QCOMPARE(map->view(), m_view);
+    QCOMPARE(store.acquire(skillId, m_view), map);
+    QCOMPARE(store.refCount(skillId), 2);
+
+    QPointer<SessionDataMap> guard(map);
+    store.release(skillId);
+    QCOMPARE(store.value(skillId), map);
+    store.release(skillId);
+    QCOMPARE(store.count(), 0);
+    QVERIFY(!store.value(skillId));
+    QTRY_VERIFY(!guard);
+}
+
+void ModelTest::testTtsCache()
+{
+    TtsCache cache;
+    cache.setCapacity(10);
+
+    const QString sorry = TtsCache::key(QStringLiteral("Sorry, I didn't understand"), QString(), QStringLiteral("en-us"));
+    QCOMPARE(TtsCache::key(QStringLiteral("Sorry, I didn't understand"), QString(), QStringLiteral("en-US")), sorry);
+    QVERIFY(TtsCache::key(QStringLiteral("Sorry, I didn't understand"), QStringLiteral("alan"), QStringLiteral("en-us")) != sorry);
+
+    QVERIFY(cache.lookup(sorry).isEmpty());
+    QCOMPARE(cache.misses(), 1);
+
+    cache.insert(sorry, QByteArrayLiteral("sorry"));
+    QVERIFY(cache.contains(sorry));
+    QCOMPARE(cache.lookup(sorry), QByteArrayLiteral("sorry"));
+    QCOMPARE(cache.hits(), 1);
+
+    // The least recently used goes first
+    const QString done = TtsCache::key(QStringLiteral("Done"), QString(), QStringLiteral("en-us"));
+    const QString timer = TtsCache::key(QStringLiteral("Timer"), QString(), QStringLiteral("en-us"));
+    cache.insert(done, QByteArrayLiteral("done"));
+    cache.lookup(sorry);
+    cache.insert(timer, QByteArrayLiteral("timer"));
+    QVERIFY(cache.contains(sorry));
+    QVERIFY(!cache.contains(done));
+    QVERIFY(cache.contains(timer));
+    QCOMPARE(cache.size(), qint64(10));
+
+    // Bigger than the whole cache: not kept
+    cache.insert(done, QByteArrayLiteral("a sentence too long"));
+    QVERIFY(!cache.contains(done));
+}
+
+void ModelTest::testSessionSnapshot()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/main.snapshot");
+
+    SessionSnapshot snapshot(fileName);
+    QVERIFY(!snapshot.load());
+
+    SessionSnapshot::Skill weather;
+    weather.skillId = QStringLiteral("mycroft.weather");
+    weather.delegateUrls << QUrl(QStringLiteral("file:///skills/weather/current.qml"))
+                         << QUrl(QStringLiteral("file:///skills/weather/forecast.qml"));
+    weather.currentIndex = 1;
+    weather.sessionData = QByteArrayLiteral("sunny");
+    snapshot.setSkill(weather);
+    QVERIFY(snapshot.save(QStringList({QStringLiteral("mycroft.weather"), QStringLiteral("mycroft.wiki")}), 42));
+
+    SessionSnapshot restored(fileName);
+    QVERIFY(restored.load());
+    QCOMPARE(restored.stateVersion(), quint64(42));
+    QVector<SessionSnapshot::Skill> skills = restored.skills();
+    QCOMPARE(skills.count(), 2);
+    QCOMPARE(skills[0].skillId, QStringLiteral("mycroft.weather"));
+    QCOMPARE(skills[0].delegateUrls, weather.delegateUrls);
+    QCOMPARE(skills[0].currentIndex, 1);
+    QCOMPARE(skills[0].sessionData, QByteArrayLiteral("sunny"));
+    // Never given to setSkill: no pages and no data
+    QCOMPARE(skills[1].skillId, QStringLiteral("mycroft.wiki"));
+    QVERIFY(skills[1].delegateUrls.isEmpty());
+    QVERIFY(skills[1].sessionData.isEmpty());
+
+    // What was loaded is saved again as is, skills not in the order anymore are dropped
+    QVERIFY(restored.save(QStringList({QStringLiteral("mycroft.weather")}), 43));
+    QVERIFY(snapshot.load());
+    skills = snapshot.skills();
+    QCOMPARE(skills.count(), 1);
+    QCOMPARE(skills[0].delegateUrls, weather.delegateUrls);
+    QCOMPARE(snapshot.stateVersion(), quint64(43));
+
+    // A truncated file is not shown
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 4));
+    file.close();
+    QVERIFY(!snapshot.load());
+
+    snapshot.clear();
+    QVERIFY(!QFile::exists(fileName));
+}
+
+void ModelTest::testSettingsStore()
+{
+    GlobalSettings first;
+    GlobalSettings second;
+    QSignalSpy secondSpy(&second, &GlobalSettings::streamMicrophoneChanged);
+    QSignalSpy storeSpy(SettingsStore::instance(), &SettingsStore::valueChanged);
+
+    const bool stream = first.streamMicrophone();
+
+    // Every instance sees the change, notified once
+    first.setStreamMicrophone(!stream);
+    QCOMPARE(second.streamMicrophone(), !stream);
+    QCOMPARE(secondSpy.count(), 1);
+    QCOMPARE(storeSpy.count(), 1);
+    QCOMPARE(storeSpy.first().first().toString(), QStringLiteral("streamMicrophone"));
+
+    // Setting the same value again is not a change
+    second.setStreamMicrophone(!stream);
+    QCOMPARE(secondSpy.count(), 1);
+
+    // The cached members of the hot paths follow too
+    const bool hivemind = first.useHivemindProtocol();
+    second.setUseHivemindProtocol(!hivemind);
+    QCOMPARE(first.useHivemindProtocol(), !hivemind);
+
+    first.setStreamMicrophone(stream);
+    first.setUseHivemindProtocol(hivemind);
+    SettingsStore::instance()->sync();
+    QCOMPARE(QSettings().value(QStringLiteral("streamMicrophone")).toBool(), stream);
+}
+
+static void writeFile(const QString &fileName, const QByteArray &content)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+void ModelTest::testSkillIndex()
+{
+    QTemporaryDir root;
+    QVERIFY(QDir(root.path()).mkpath(QStringLiteral("mycroft-weather")));
+    QVERIFY(QDir(root.path()).mkpath(QStringLiteral("mycroft-wiki")));
+    writeFile(root.path() + QStringLiteral("/mycroft-weather/README.md"), QByteArrayLiteral("# Weather"));
+
+    SkillIndex index;
+    new QAbstractItemModelTester(&index, QAbstractItemModelTester::FailureReportingMode::QtTest, &index);
+    QSignalSpy scannedSpy(&index, &SkillIndex::scanned);
+
+    index.setRootPath(root.path());
+    QVERIFY(scannedSpy.wait());
+    QVERIFY(!index.scanning());
+    QCOMPARE(index.rowCount(), 1);
+    QCOMPARE(index.get(0).value(QStringLiteral("skillName")).toString(), QStringLiteral("mycroft-weather"));
+    QCOMPARE(index.get(0).value(QStringLiteral("metaContent")).toString(), QStringLiteral("# Weather"));
+
+    // A skill getting its metadata is picked up by the watcher, in order
+    QSignalSpy insertedSpy(&index, &SkillIndex::rowsInserted);
+    writeFile(root.path() + QStringLiteral("/mycroft-wiki/README.md"), QByteArrayLiteral("# Wiki"));
+    QTRY_COMPARE(index.rowCount(), 2);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(index.get(1).value(QStringLiteral("skillName")).toString(), QStringLiteral("mycroft-wiki"));
+
+    // Only the changed row is updated
+    QSignalSpy changedSpy(&index, &SkillIndex::dataChanged);
+    writeFile(root.path() + QStringLiteral("/mycroft-weather/README.md"), QByteArrayLiteral("# Weather forecast"));
+    QTRY_COMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy.first().first().toModelIndex().row(), 0);
+    QCOMPARE(index.get(0).value(QStringLiteral("metaContent")).toString(), QStringLiteral("# Weather forecast"));
+
+    QSignalSpy removedSpy(&index, &SkillIndex::rowsRemoved);
+    QVERIFY(QDir(root.path() + QStringLiteral("/mycroft-weather")).removeRecursively());
+    QTRY_COMPARE(index.rowCount(), 1);
+    QCOMPARE(removedSpy.count(), 1);
+}
+
+void ModelTest::testImageProvider()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/cover.png");
+    QImage cover(400, 200, QImage::Format_ARGB32);
+    cover.fill(Qt::red);
+    QVERIFY(cover.save(fileName));
+
+    ImageProvider provider;
+    const QString id = QUrl::fromLocalFile(fileName).toString();
+
+    // Decoded already at the size asked, keeping the aspect ratio
+    QScopedPointer<QQuickImageResponse> response(provider.requestImageResponse(id, QSize(100, 100)));
+    QSignalSpy finishedSpy(response.data(), &QQuickImageResponse::finished);
+    QVERIFY(finishedSpy.wait());
+    QVERIFY(response->errorString().isEmpty());
+    QScopedPointer<QQuickTextureFactory> texture(response->textureFactory());
+    QCOMPARE(texture->image().size(), QSize(100, 50));
+    QVERIFY(!provider.cachedImage(id + QStringLiteral("@100x100")).isNull());
+
+    // Never scaled up
+    response.reset(provider.requestImageResponse(id, QSize(800, 0)));
+    QSignalSpy bigSpy(response.data(), &QQuickImageResponse::finished);
+    QVERIFY(bigSpy.wait());
+    texture.reset(response->textureFactory());
+    QCOMPARE(texture->image().size(), QSize(400, 200));
+
+    // From memory, even if the file is gone
+    QVERIFY(QFile::remove(fileName));
+    response.reset(provider.requestImageResponse(id, QSize(100, 100)));
+    QSignalSpy cachedSpy(response.data(), &QQuickImageResponse::finished);
+    QVERIFY(cachedSpy.wait());
+    texture.reset(response->textureFactory());
+    QCOMPARE(texture->image().size(), QSize(100, 50));
+}
+
+void ModelTest::testMetrics()
+{
+    Metrics *metrics = Metrics::instance();
+    const bool enabled = metrics->enabled();
+    metrics->reset();
+
+    metrics->setEnabled(false);
+    metrics->recordMessage(Metrics::GuiChannel, QStringLiteral("mycroft.session.set"), 100, 1000);
+    QVERIFY(metrics->snapshot().value(QStringLiteral("gui")).toMap().isEmpty());
+
+    metrics->setEnabled(true);
+    metrics->recordMessage(Metrics::GuiChannel, QStringLiteral("mycroft.session.set"), 100, 1000);
+    metrics->recordMessage(Metrics::GuiChannel, QStringLiteral("mycroft.session.set"), 50, 3000);
+    {
+        Metrics::HandlerTimer timer(Metrics::GuiChannel, QStringLiteral("mycroft.session.set"));
+    }
+    for (int i = 1; i <= 100; ++i) {
+        metrics->recordTiming(QStringLiteral("delegate.compile"), i * 1000000);
+    }
+
+    const QVariantMap snapshot = metrics->snapshot();
+    const QVariantMap set = snapshot.value(QStringLiteral("gui")).toMap().value(QStringLiteral("mycroft.session.set")).toMap();
+    QCOMPARE(set.value(QStringLiteral("count")).toInt(), 2);
+    QCOMPARE(set.value(QStringLiteral("bytes")).toInt(), 150);
+    QCOMPARE(set.value(QStringLiteral("parse")).toMap().value(QStringLiteral("mean")).toDouble(), 2.0);
+    QCOMPARE(set.value(QStringLiteral("handler")).toMap().value(QStringLiteral("count")).toInt(), 1);
+
+    // Upper bounds of log2 buckets of microseconds: 50ms is in [32.768, 65.536)ms
+    const QVariantMap compile = snapshot.value(QStringLiteral("timings")).toMap().value(QStringLiteral("delegate.compile")).toMap();
+    QCOMPARE(compile.value(QStringLiteral("count")).toInt(), 100);
+    QCOMPARE(compile.value(QStringLiteral("p50")).toLongLong(), qint64(65536));
+    QCOMPARE(compile.value(QStringLiteral("max")).toDouble(), 100000.0);
+
+    // The same as JSON, to whoever connects to the local socket
+    metrics->setServerName(QStringLiteral("mycroft-gui-modeltest-metrics"));
+    QLocalSocket socket;
+    QSignalSpy disconnectedSpy(&socket, &QLocalSocket::disconnected);
+    socket.connectToServer(QStringLiteral("mycroft-gui-modeltest-metrics"));
+    QVERIFY(disconnectedSpy.wait());
+    const QJsonDocument dump = QJsonDocument::fromJson(socket.readAll());
+    QCOMPARE(dump.object().value(QStringLiteral("gui")).toObject().value(QStringLiteral("mycroft.session.set")).toObject().value(QStringLiteral("count")).toInt(), 2);
+
+    metrics->setServerName(QString());
+    metrics->reset();
+    metrics->setEnabled(enabled);
+}
+
+void ModelTest::testTrafficRecorder()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("traffic.mgtr"));
+
+    TrafficRecorder *recorder = TrafficRecorder::instance();
+    recorder->record(Metrics::GuiChannel, QByteArrayLiteral("{}"), false);
+    QVERIFY(!recorder->isRecording());
+
+    QVERIFY(recorder->start(fileName));
+    QVERIFY(recorder->isRecording());
+    QCOMPARE(recorder->fileName(), fileName);
+
+    // Enough to need several blocks
+    const QByteArray set = QByteArrayLiteral("{\"type\": \"mycroft.session.set\", \"namespace\": \"mycroft.weather\", \"data\": {\"temperature\": 24}}");
+    for (int i = 0; i < 2000; ++i) {
+        recorder->record(Metrics::GuiChannel, set, false);
+    }
+    recorder->record(Metrics::BusChannel, QByteArrayLiteral("{\"type\": \"speak\"}"), false);
+    QTest::qWait(10);
+    recorder->record(Metrics::GuiChannel, QByteArray("\xa1\x64type", 6), true);
+    QCOMPARE(recorder->frameCount(), quint64(2002));
+
+    // A recording still going on is on disk after a second at most
+    QTRY_COMPARE_WITH_TIMEOUT(TrafficRecorder::load(fileName).count(), 2002, 3000);
+
+    recorder->stop();
+    QVERIFY(!recorder->isRecording());
+
+    const QVector<TrafficRecorder::Frame> frames = TrafficRecorder::load(fileName);
+    QCOMPARE(frames.count(), 2002);
+    QCOMPARE(frames.first().channel, Metrics::GuiChannel);
+    QCOMPARE(frames.first().payload, set);
+    QVERIFY(!frames.first().binary);
+    QCOMPARE(frames[2000].channel, Metrics::BusChannel);
+    QCOMPARE(frames.last().payload, QByteArray("\xa1\x64type", 6));
+    QVERIFY(frames.last().binary);
+    QVERIFY(frames.last().time >= frames[2000].time + 10000);
+    for (int i = 1; i < frames.count(); ++i) {
+        QVERIFY(frames[i].time >= frames[i - 1].time);
+    }
+
+    // Compressed, the repetitive JSON takes a fraction of its size
+    QVERIFY(QFileInfo(fileName).size() < set.size() * 2000 / 4);
+
+    // Losing the end of the file keeps the blocks before it
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 10));
+    file.close();
+    const int truncatedCount = TrafficRecorder::load(fileName).count();
+    QVERIFY(truncatedCount > 0 && truncatedCount < 2002);
+
+    QVERIFY(TrafficRecorder::load(dir.filePath(QStringLiteral("missing.mgtr"))).isEmpty());
 }
 
 QTEST_MAIN(ModelTest);
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <QtTest>
+
+#include "../import/audiometer.h"
+#include "../import/spscring.h"
+#include "../import/triplebuffer.h"
+#include "../import/voiceactivitydetector.h"
+
+// Writes increasing values, as fast as it can
+class Producer : public QThread
+{
+public:
+    explicit Producer(SpscRing<float> *ring)
+        : m_ring(ring)
+    {
+    }
+
+    std::atomic<bool> done{false};
+
+protected:
+    void run() override
+    {
+        float chunk[64];
+        float value = 0;
+        for (int i = 0; i < 20000; ++i) {
+            for (auto &sample : chunk) {
+                sample = value++;
+            }
+            m_ring->push(chunk, 64);
+        }
+        done = true;
+    }
+
+private:
+    SpscRing<float> *m_ring;
+};
+
+class PipelineTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRingOrder();
+    void testRingDropOldest();
+    void testRingConcurrent();
+    void testTripleBuffer();
+    void testAudioMeter();
+    void testAudioMeterChannels();
+    void testVoiceActivity();
+    void testVoiceActivityFromStart();
+};
+
+void PipelineTest::testRingOrder()
+{
+    SpscRing<float> ring(100);
+    QCOMPARE(ring.capacity(), size_t(128));
+
+    const float in[] = {1, 2, 3, 4, 5};
+    ring.push(in, 5);
+    QCOMPARE(ring.available(), size_t(5));
+
+    float out[8];
+    QCOMPARE(ring.pop(out, 3), size_t(3));
+    QCOMPARE(out[0], 1.0f);
+    QCOMPARE(out[2], 3.0f);
+    QCOMPARE(ring.pop(out, 8), size_t(2));
+    QCOMPARE(out[1], 5.0f);
+    QCOMPARE(ring.pop(out, 8), size_t(0));
+    QCOMPARE(ring.dropped(), quint64(0));
+}
+
+void PipelineTest::testRingDropOldest()
+{
+    SpscRing<float> ring(4);
+
+    const float in[] = {1, 2, 3, 4, 5, 6};
+    ring.push(in, 6);
+    QCOMPARE(ring.available(), size_t(4));
+
+    float out[4];
+    QCOMPARE(ring.pop(out, 4), size_t(4));
+    QCOMPARE(out[0], 3.0f);
+    QCOMPARE(out[3], 6.0f);
+    QCOMPARE(ring.dropped(), quint64(2));
+
+    ring.push(in, 3);
+    ring.skip(2);
+    QCOMPARE(ring.pop(out, 4), size_t(1));
+    QCOMPARE(out[0], 3.0f);
+}
+
+void PipelineTest::testRingConcurrent()
+{
+    SpscRing<float> ring(1024);
+    Producer producer(&ring);
+    producer.start();
+
+    // Some samples get dropped, but what's read is never out of order or torn
+    float out[256];
+    float last = -1;
+    quint64 read = 0;
+    bool ordered = true;
+    while (!producer.done || ring.available() > 0) {
+        const size_t count = ring.pop(out, 256);
+        for (size_t i = 0; i < count; ++i) {
+            ordered = ordered && out[i] > last;
+            last = out[i];
+        }
+        read += count;
+    }
+    producer.wait();
+
+    QVERIFY(ordered);
+    QCOMPARE(read + ring.dropped(), quint64(20000 * 64));
+}
+
+void PipelineTest::testTripleBuffer()
+{
+    TripleBuffer<int> buffer;
+    QVERIFY(!buffer.update());
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+
+    // Only the latest value is seen
+    QVERIFY(buffer.update());
+    QCOMPARE(buffer.readBuffer(), 2);
+    QVERIFY(!buffer.update());
+    QCOMPARE(buffer.readBuffer(), 2);
+
+    buffer.writeBuffer() = 3;
+    buffer.publish();
+    QVERIFY(buffer.update());
+    QCOMPARE(buffer.readBuffer(), 3);
+}
+
+void PipelineTest::testAudioMeter()
+{
+    // Full scale square wave on the left, half scale on the right
+    QVector<qint16> stereo;
+    for (int i = 0; i < 1001; ++i) {
+        stereo << (i % 2 ? -32768 : 32767) << (i % 2 ? -16384 : 16384);
+    }
+
+    QVector<float> mono(1001);
+    const AudioMeter::Levels levels = AudioMeter::measure(stereo.constData(), 1001, 2, AudioMeter::Int16, mono.data());
+
+    QCOMPARE(levels.channels, 2);
+    QCOMPARE(levels.frames, 1001);
+    QVERIFY(qAbs(levels.peak[0] - 1.0f) < 1e-3);
+    QVERIFY(qAbs(levels.rms[0] - 1.0f) < 1e-3);
+    QVERIFY(qAbs(levels.peak[1] - 0.5f) < 1e-3);
+    QVERIFY(qAbs(levels.mean[1] - 0.5f) < 1e-3);
+    QCOMPARE(levels.maximumPeak(), levels.peak[0]);
+    QVERIFY(qAbs(mono[0] - 0.75f) < 1e-3);
+    QVERIFY(qAbs(mono[1000] - 0.75f) < 1e-3);
+
+    // The vector and the scalar paths agree
+    QVector<float> floats;
+    for (auto sample : stereo) {
+        floats << sample / 32768.0f;
+    }
+    const AudioMeter::Levels floatLevels = AudioMeter::measure(floats.constData(), 1001, 2, AudioMeter::Float32);
+    QVERIFY(qAbs(floatLevels.rms[1] - levels.rms[1]) < 1e-4);
+
+    const quint8 silence[] = {128, 128, 128, 128};
+    QCOMPARE(AudioMeter::measure(silence, 4, 1, AudioMeter::UInt8).peak[0], 0.0f);
+}
+
+void PipelineTest::testAudioMeterChannels()
+{
+    QAudioFormat format;
+    format.setChannelCount(3);
+    format.setSampleSize(32);
+    format.setSampleType(QAudioFormat::SignedInt);
+    QCOMPARE(AudioMeter::sampleFormat(format), AudioMeter::Int32);
+
+    const qint32 samples[] = {0x40000000, 0, -0x40000000, 0x40000000, 0, -0x40000000};
+    const QByteArray data(reinterpret_cast<const char *>(samples), sizeof(samples));
+
+    QVector<float> mono(2);
+    const AudioMeter::Levels levels = AudioMeter::measure(data, format, mono.data());
+    QCOMPARE(levels.frames, 2);
+    QVERIFY(qAbs(levels.peak[0] - 0.5f) < 1e-6);
+    QCOMPARE(levels.peak[1], 0.0f);
+    QVERIFY(qAbs(levels.mean[2] - 0.5f) < 1e-6);
+    QCOMPARE(mono[1], 0.0f);
+
+    format.setSampleSize(24);
+    QCOMPARE(AudioMeter::sampleFormat(format), AudioMeter::Unsupported);
+}
+
+void PipelineTest::testVoiceActivity()
+{
+    // Half a second of background noise, half of a tone, then noise again
+    const int rate = 8000;
+    QVector<float> samples(rate * 2);
+    quint32 seed = 1;
+    for (int i = 0; i < samples.size(); ++i) {
+        seed = seed * 1664525 + 1013904223;
+        samples[i] = (float(seed >> 8) / float(1 << 24) - 0.5f) * 0.004f;
+        if (i >= rate / 2 && i < rate) {
+            samples[i] += 0.3f * float(qSin(2 * M_PI * 300 * i / rate));
+        }
+    }
+
+    VoiceActivityDetector detector;
+    detector.reset(rate);
+    detector.setHangover(300);
+
+    // Fed in chunks as the microphone would, stopping once it's over
+    int fed = 0;
+    while (fed < samples.size() && detector.state() != VoiceActivityDetector::Ended) {
+        const int count = qMin(256, samples.size() - fed);
+        detector.process(samples.constData() + fed, count);
+        fed += count;
+        if (fed < rate / 2) {
+            QCOMPARE(detector.state(), VoiceActivityDetector::Silence);
+        }
+    }
+
+    QCOMPARE(detector.state(), VoiceActivityDetector::Ended);
+    // The hangover after the tone, give or take a window
+    QVERIFY(qAbs(detector.position() - (rate + rate * 3 / 10)) <= rate / 50);
+    // Some margin is kept around the tone, most of the noise is not
+    QVERIFY(detector.speechBegin() < rate / 2);
+    QVERIFY(detector.speechBegin() > rate / 5);
+    QVERIFY(detector.speechEnd() > rate);
+    QVERIFY(detector.speechEnd() < rate + rate / 5);
+}
+
+void PipelineTest::testVoiceActivityFromStart()
+{
+    // Already talking when the recording starts: the first window is no noise floor
+    const int rate = 8000;
+    QVector<float> samples(rate);
+    for (int i = 0; i < samples.size(); ++i) {
+        samples[i] = i < rate / 2 ? 0.3f * float(qSin(2 * M_PI * 300 * i / rate)) : 0.0f;
+    }
+
+    VoiceActivityDetector detector;
+    detector.reset(rate);
+    detector.setHangover(300);
+    detector.process(samples.constData(), samples.size());
+
+    QCOMPARE(detector.state(), VoiceActivityDetector::Ended);
+    QCOMPARE(detector.speechBegin(), qint64(0));
+    QVERIFY(detector.speechEnd() > rate / 2);
+}
+
+QTEST_GUILESS_MAIN(PipelineTest);
+
+#include "pipelinetest.moc"
@@ -28,8 +28,14 @@
 #include "../import/activeskillsmodel.h"
 #include "../import/delegatesmodel.h"
 #include "../import/abstractskillview.h"
+#include "../import/delegatepool.h"
 #include "../import/sessiondatamap.h"
 #include "../import/sessiondatamodel.h"
+#include "../import/messagequeue.h"
+#include "../import/guimessage.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
 
 class ServerTest : public QObject
 {
@@ -43,14 +49,17 @@ private Q_SLOTS:
     void testActiveSkills();
     void testSessionData();
     void testChangeSessionData();
+    void testPatchSessionData();
     void testShowGui();
     void testClientToServerData();
+    void testCoalescedClientToServerData();
     void testShowSecondGuiPage();
     void testEventsFromServer();
     void testEventsFromClient();
     void testMoveGuiPage();
     void testRemoveGuiPage();
     void testSwitchSkill();
+    void testFollowerSessionData();
 
 private:
     AbstractDelegate *delegateForSkill(const QString &skill, const QUrl &url);
@@ -201,7 +210,8 @@ void ServerTest::testGuiConnection()
     QVERIFY(m_mainWebSocket);
 
     controllerSocketStatusChangedSpy.wait();
-    QCOMPARE(m_controller->status(), MycroftController::Open);
+    //the socket state is mirrored from the socket thread
+    QTRY_COMPARE(m_controller->status(), MycroftController::Open);
 
     textFromMainSpy.wait();
     auto doc = QJsonDocument::fromJson(textFromMainSpy.first().first().toString().toLatin1());
@@ -466,6 +476,45 @@ void ServerTest::testChangeSessionData()
     QCOMPARE(dm->data(dm->index(2, 0), dm->roleNames().key("icon")).toString(), QStringLiteral("weather-showers-day"));
 }
 
+void ServerTest::testPatchSessionData()
+{
+    SessionDataMap *map = m_view->sessionDataForSkill(QStringLiteral("mycroft.weather"));
+    QVERIFY(map);
+    SessionDataModel *dm = map->value(QStringLiteral("forecast")).value<SessionDataModel *>();
+    QVERIFY(dm);
+
+    QSignalSpy dataChangedSpy(map, &SessionDataMap::valueChanged);
+    QSignalSpy dataClearedSpy(map, &SessionDataMap::dataCleared);
+    QSignalSpy modelDataChangedSpy(dm, &SessionDataModel::dataChanged);
+
+    //a value nested in a plain property
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.session.set\", \"namespace\": \"mycroft.weather\", \"data\": {\"details\": {\"wind\": {\"speed\": 3, \"direction\": \"N\"}}}}"));
+    dataChangedSpy.wait();
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.session.patch\", \"namespace\": \"mycroft.weather\", \"data\": [{\"op\": \"replace\", \"path\": \"/details/wind/speed\", \"value\": 5}]}"));
+    dataChangedSpy.wait();
+    QCOMPARE(dataChangedSpy.count(), 2);
+    QCOMPARE(dataChangedSpy[1].first().toString(), QStringLiteral("details"));
+    const QVariantMap wind = map->value(QStringLiteral("details")).toMap().value(QStringLiteral("wind")).toMap();
+    QCOMPARE(wind.value(QStringLiteral("speed")).toInt(), 5);
+    QCOMPARE(wind.value(QStringLiteral("direction")).toString(), QStringLiteral("N"));
+
+    //a role of a model row: only that row gets notified
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.session.patch\", \"namespace\": \"mycroft.weather\", \"data\": [{\"op\": \"replace\", \"path\": \"/forecast/1/temperature\", \"value\": \"31°C\"}]}"));
+    modelDataChangedSpy.wait();
+    QCOMPARE(modelDataChangedSpy.count(), 1);
+    QCOMPARE(modelDataChangedSpy.first().first().toModelIndex().row(), 1);
+    QCOMPARE(modelDataChangedSpy.first()[1].toModelIndex().row(), 1);
+    QCOMPARE(dm->data(dm->index(1, 0), dm->roleNames().key("temperature")).toString(), QStringLiteral("31°C"));
+    QCOMPARE(dm->data(dm->index(1, 0), dm->roleNames().key("when")).toString(), QStringLiteral("Tuesday"));
+    QCOMPARE(dm->rowCount(), 3);
+
+    //put things back as they were
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.session.patch\", \"namespace\": \"mycroft.weather\", \"data\": [{\"op\": \"replace\", \"path\": \"/forecast/1/temperature\", \"value\": \"30°C\"}, {\"op\": \"remove\", \"path\": \"/details\"}]}"));
+    dataClearedSpy.wait();
+    QCOMPARE(dataClearedSpy.count(), 1);
+    QCOMPARE(dm->data(dm->index(1, 0), dm->roleNames().key("temperature")).toString(), QStringLiteral("30°C"));
+}
+
 void ServerTest::testShowGui()
 {
     QSignalSpy skillModelDataChangedSpy(m_view->activeSkills(), &ActiveSkillsModel::dataChanged);
@@ -476,6 +525,8 @@ void ServerTest::testShowGui()
 
     skillModelDataChangedSpy.wait();
 
+    //the delegate is incubated asynchronously
+    QTRY_VERIFY(delegateForSkill(QStringLiteral("mycroft.weather"), url));
     AbstractDelegate *delegate = delegateForSkill(QStringLiteral("mycroft.weather"), url);
     QVERIFY(delegate);
     QCOMPARE(delegate->skillId(), QStringLiteral("mycroft.weather"));
@@ -524,6 +575,47 @@ void ServerTest::testClientToServerData()
     QCOMPARE(doc[QStringLiteral("property")], QStringLiteral("to_delete"));
 }
 
+void ServerTest::testCoalescedClientToServerData()
+{
+    QSignalSpy propertySpy(m_guiWebSocket, &QWebSocket::textMessageReceived);
+    const quint64 framesSent = m_view->outboundQueue()->framesSent();
+
+    // Writes done in the same event loop iteration end up in a single message
+    m_view->writeProperties(QStringLiteral("mycroft.weather"), QVariantMap({{QStringLiteral("temperature"), QStringLiteral("22 °C")}}));
+    m_view->writeProperties(QStringLiteral("mycroft.weather"), QVariantMap({{QStringLiteral("icon"), QStringLiteral("weather-clouds")}, {QStringLiteral("to_delete"), QStringLiteral("foo")}}));
+    m_view->deleteProperty(QStringLiteral("mycroft.weather"), QStringLiteral("to_delete"));
+    QCOMPARE(m_view->outboundQueue()->depth(), 2);
+
+    QVERIFY(propertySpy.wait());
+    QTRY_COMPARE(propertySpy.count(), 2);
+    QCOMPARE(m_view->outboundQueue()->depth(), 0);
+    QCOMPARE(m_view->outboundQueue()->framesSent(), framesSent + 2);
+
+    QJsonDocument doc = QJsonDocument::fromJson(propertySpy[0].first().toString().toUtf8());
+    QCOMPARE(doc[QStringLiteral("type")], QStringLiteral("mycroft.session.set"));
+    QCOMPARE(doc[QStringLiteral("data")][QStringLiteral("temperature")], QStringLiteral("22 °C"));
+    QCOMPARE(doc[QStringLiteral("data")][QStringLiteral("icon")], QStringLiteral("weather-clouds"));
+    QVERIFY(doc[QStringLiteral("data")][QStringLiteral("to_delete")].isUndefined());
+
+    doc = QJsonDocument::fromJson(propertySpy[1].first().toString().toUtf8());
+    QCOMPARE(doc[QStringLiteral("type")], QStringLiteral("mycroft.session.delete"));
+    QCOMPARE(doc[QStringLiteral("property")], QStringLiteral("to_delete"));
+
+    // Big writes don't wait for the tick
+    MessageQueue *queue = m_view->outboundQueue();
+    const int maximumBytes = queue->maximumBytes();
+    queue->setMaximumBytes(1024);
+    m_view->writeProperties(QStringLiteral("mycroft.weather"), QVariantMap({{QStringLiteral("icon"), QStringLiteral("weather-clouds")}}));
+    QCOMPARE(queue->depth(), 1);
+    QVERIFY(queue->pendingBytes() > 0);
+    m_view->writeProperties(QStringLiteral("mycroft.weather"), QVariantMap({{QStringLiteral("text"), QString(2000, QLatin1Char('a'))}}));
+    QCOMPARE(queue->depth(), 0);
+    QCOMPARE(queue->pendingBytes(), 0);
+    QCOMPARE(queue->framesSent(), framesSent + 3);
+    queue->setMaximumBytes(maximumBytes);
+    QTRY_COMPARE(propertySpy.count(), 3);
+}
+
 void ServerTest::testShowSecondGuiPage()
 {
     QSignalSpy skillModelDataChangedSpy(m_view->activeSkills(), &ActiveSkillsModel::dataChanged);
@@ -536,6 +628,8 @@ void ServerTest::testShowSecondGuiPage()
 
     skillModelDataChangedSpy.wait();
 
+    //the delegate is incubated asynchronously
+    QTRY_VERIFY(delegateForSkill(QStringLiteral("mycroft.weather"), url));
     AbstractDelegate *delegate = delegateForSkill(QStringLiteral("mycroft.weather"), url);
     QVERIFY(delegate);
     QCOMPARE(delegate->skillId(), QStringLiteral("mycroft.weather"));
@@ -572,6 +666,18 @@ void ServerTest::testEventsFromServer()
     eventSpy.wait(1000);
     QCOMPARE(eventSpy.count(), 2);
 
+    //Once it declares the events it handles, the delegate gets only those
+    delegate->setHandledEvents(QStringList({QStringLiteral("show_alert")}));
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.events.triggered\", \"namespace\": \"system\", \"event_name\": \"system.next\", \"data\": {}}"));
+    eventSpy.wait(1000);
+    QCOMPARE(eventSpy.count(), 2);
+
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.events.triggered\", \"namespace\": \"mycroft.weather\", \"event_name\": \"show_alert\", \"data\": {}}"));
+    eventSpy.wait();
+    QCOMPARE(eventSpy.count(), 3);
+    QCOMPARE(eventSpy[2].first(), QStringLiteral("show_alert"));
+    delegate->setHandledEvents(QStringList());
+
     //view switches again to current
     m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.events.triggered\", \"namespace\": \"mycroft.weather\", \"event_name\": \"page_gained_focus\", \"data\": {\"number\": 0}}"));
 
@@ -644,6 +750,7 @@ void ServerTest::testRemoveGuiPage()
     QUrl forecastUrl = QUrl::fromLocalFile(QFINDTESTDATA("forecast.qml"));
 
     AbstractDelegate *delegate = delegateForSkill(QStringLiteral("mycroft.weather"), forecastUrl);
+    AbstractDelegate *forecastDelegate = delegate;
 
     DelegatesModel *delegatesModel = m_view->activeSkills()->delegatesModelForSkill(QStringLiteral("mycroft.weather"));
     QVERIFY(delegatesModel);
@@ -662,8 +769,42 @@ void ServerTest::testRemoveGuiPage()
     QVERIFY(delegate);
     QCOMPARE(delegate->qmlUrl(), currentUrl);
 
+    //after its removal animation the delegate gets parked to be reused
+    QTRY_COMPARE(m_view->delegatePool()->count(), 1);
+    QCOMPARE(destroyedSpy.count(), 0);
+
+    //showing the same page again takes it back instead of creating a new one
+    QSignalSpy rowsInsertedSpy(delegatesModel, &DelegatesModel::rowsInserted);
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.gui.list.insert\", \"namespace\": \"mycroft.weather\", \"position\": 1, \"data\": [{\"url\": \"") + forecastUrl.toString() + QStringLiteral("\"}]}"));
+    rowsInsertedSpy.wait();
+    QCOMPARE(delegatesModel->data(delegatesModel->index(1,0), DelegatesModel::DelegateUi).value<AbstractDelegate *>(), forecastDelegate);
+    QCOMPARE(forecastDelegate->sessionData(), m_view->sessionDataForSkill(QStringLiteral("mycroft.weather")));
+    QCOMPARE(m_view->delegatePool()->count(), 0);
+
+    //removed and shown again at once, before it's parked: still the same delegate
+    QSignalSpy forecastDestroyedSpy(forecastDelegate, &QObject::destroyed);
+    rowsInsertedSpy.clear();
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.gui.list.remove\", \"namespace\": \"mycroft.weather\", \"items_number\": 1, \"position\": 1}"));
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.gui.list.insert\", \"namespace\": \"mycroft.weather\", \"position\": 1, \"data\": [{\"url\": \"") + forecastUrl.toString() + QStringLiteral("\"}]}"));
+    QTRY_COMPARE(rowsInsertedSpy.count(), 1);
+    QCOMPARE(delegatesModel->rowCount(), 2);
+    QCOMPARE(delegatesModel->data(delegatesModel->index(1,0), DelegatesModel::DelegateUi).value<AbstractDelegate *>(), forecastDelegate);
+    QCOMPARE(forecastDelegate->skillView(), m_view);
+
+    //the removal timer doesn't take it away from the model anymore
+    QTest::qWait(2500);
+    QCOMPARE(forecastDestroyedSpy.count(), 0);
+    QCOMPARE(m_view->delegatePool()->count(), 0);
+    QCOMPARE(delegatesModel->rowCount(), 2);
+
+    //with no room in the pool, a removed delegate gets destroyed
+    m_view->delegatePool()->setCapacity(0);
+    m_guiWebSocket->sendTextMessage(QStringLiteral("{\"type\": \"mycroft.gui.list.remove\", \"namespace\": \"mycroft.weather\", \"items_number\": 1, \"position\": 1}"));
+
     destroyedSpy.wait();
     QCOMPARE(destroyedSpy.count(), 1);
+    QCOMPARE(delegatesModel->rowCount(), 1);
+    m_view->delegatePool()->setCapacity(8);
 }
 
 void ServerTest::testSwitchSkill()
@@ -697,6 +838,47 @@ void ServerTest::testSwitchSkill()
     QTest::qWait(3000);
 }
 
+void ServerTest::testFollowerSessionData()
+{
+    const auto dispatch = [](AbstractSkillView *view, const QString &json) {
+        view->dispatchGuiMessage(GuiMessage::fromJson(QJsonDocument::fromJson(json.toUtf8()).object()));
+    };
+
+    // Two views on the same connection, the follower shows a skill the channel filters out
+    m_controller->setSharedGuiConnection(true);
+    QScopedPointer<AbstractSkillView> channel(new AbstractSkillView);
+    QScopedPointer<AbstractSkillView> follower(new AbstractSkillView);
+    QCOMPARE(follower->guiChannel(), channel.data());
+    channel->activeSkills()->setBlackList({QStringLiteral("mycroft.timer")});
+    follower->activeSkills()->setWhiteList({QStringLiteral("mycroft.timer")});
+
+    dispatch(channel.data(), QStringLiteral("{\"type\": \"mycroft.session.list.insert\", \"namespace\": \"mycroft.system.active_skills\", \"position\": 0, \"data\": [{\"skill_id\": \"mycroft.timer\"}, {\"skill_id\": \"mycroft.weather\"}]}"));
+    QCOMPARE(channel->activeSkills()->activeSkills(), QStringList({QStringLiteral("mycroft.weather")}));
+    QCOMPARE(follower->activeSkills()->activeSkills(), QStringList({QStringLiteral("mycroft.timer")}));
+
+    dispatch(channel.data(), QStringLiteral("{\"type\": \"mycroft.session.set\", \"namespace\": \"mycroft.timer\", \"data\": {\"remaining\": 10}}"));
+    dispatch(channel.data(), QStringLiteral("{\"type\": \"mycroft.session.list.insert\", \"namespace\": \"mycroft.timer\", \"property\": \"alarms\", \"position\": 0, \"data\": [{\"label\": \"tea\"}]}"));
+    dispatch(channel.data(), QStringLiteral("{\"type\": \"mycroft.session.patch\", \"namespace\": \"mycroft.timer\", \"data\": [{\"op\": \"replace\", \"path\": \"/remaining\", \"value\": 9}]}"));
+
+    SessionDataMap *map = follower->sessionDataForSkill(QStringLiteral("mycroft.timer"));
+    QVERIFY(map);
+    QCOMPARE(map->value(QStringLiteral("remaining")).toInt(), 9);
+    SessionDataModel *alarms = map->value(QStringLiteral("alarms")).value<SessionDataModel *>();
+    QVERIFY(alarms);
+    QCOMPARE(alarms->rowCount(), 1);
+
+    // The channel still doesn't show it, nor keeps data for it
+    QVERIFY(!channel->sessionDataForSkill(QStringLiteral("mycroft.timer")));
+
+    // Nobody shows it: dropped as before
+    dispatch(channel.data(), QStringLiteral("{\"type\": \"mycroft.session.set\", \"namespace\": \"mycroft.alarm\", \"data\": {\"time\": 7}}"));
+    QVERIFY(!follower->sessionDataForSkill(QStringLiteral("mycroft.alarm")));
+
+    follower.reset();
+    channel.reset();
+    m_controller->setSharedGuiConnection(false);
+}
+
 QTEST_MAIN(ServerTest);
 
 #include "servertest.moc"
@@ -196,7 +196,8 @@ void ServerTest::testGuiConnection()
     QVERIFY(m_mainWebSocket);
 
     controllerSocketStatusChangedSpy.wait();
-    QCOMPARE(m_controller->status(), MycroftController::Open);
+    //the socket state is mirrored from the socket thread
+    QTRY_COMPARE(m_controller->status(), MycroftController::Open);
 
     textFromMainSpy.wait();
     auto doc = QJsonDocument::fromJson(textFromMainSpy.first().first().toString().toLatin1());
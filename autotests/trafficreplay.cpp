@@ -0,0 +1,474 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Plays a recording made with MYCROFT_GUI_RECORD against a headless
+ * AbstractSkillView, going through the same fake core and gui servers as
+ * servertest and stresstest, then reports how the gui kept up.
+ *
+ *   trafficreplay [--speed <factor>] [--json] [--verbose] <recording>
+ *
+ * A speed of 1 plays the frames with the pauses they arrived with, 2 twice
+ * as fast and 0 as fast as the gui takes them.
+ */
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QQmlEngine>
+#include <QTextStream>
+#include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+
+#include "../import/abstractdelegate.h"
+#include "../import/abstractskillview.h"
+#include "../import/activeskillsmodel.h"
+#include "../import/delegatesmodel.h"
+#include "../import/filereader.h"
+#include "../import/globalsettings.h"
+#include "../import/metrics.h"
+#include "../import/mycroftcontroller.h"
+#include "../import/sessiondatamap.h"
+#include "../import/trafficrecorder.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+// Same ports as the real core, where the gui is going to connect
+static const quint16 s_busPort = 8181;
+static const quint16 s_guiPort = 1818;
+// Frames sent in a row as fast as possible, before letting the gui handle them
+static const int s_flatOutBatch = 64;
+// Nothing handled for this long after the last frame means the gui is done
+static const int s_settleTimeout = 2000;
+
+// In KiB, -1 if unknown
+static qint64 peakMemory()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_DARWIN
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+static QObject *fileReaderSingletonProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(engine)
+    Q_UNUSED(scriptEngine)
+
+    return new FileReader;
+}
+
+static QObject *globalSettingsSingletonProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(engine)
+    Q_UNUSED(scriptEngine)
+
+    return new GlobalSettings;
+}
+
+static QObject *mycroftControllerSingletonProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(engine);
+    Q_UNUSED(scriptEngine);
+
+    return MycroftController::instance();
+}
+
+// The skills of the recording need the Mycroft QML types, from the plugin or from the resources as servertest does
+static void registerMycroftTypes(QQmlEngine *engine)
+{
+    for (const auto &path : engine->importPathList()) {
+        if (QDir(path).entryList().contains(QStringLiteral("Mycroft"))) {
+            return;
+        }
+    }
+
+    qmlRegisterSingletonType<MycroftController>("Mycroft", 1, 0, "MycroftController", mycroftControllerSingletonProvider);
+    qmlRegisterSingletonType<GlobalSettings>("Mycroft", 1, 0, "GlobalSettings", globalSettingsSingletonProvider);
+    qmlRegisterSingletonType<FileReader>("Mycroft", 1, 0, "FileReader", fileReaderSingletonProvider);
+    qmlRegisterType<AbstractSkillView>("Mycroft", 1, 0, "AbstractSkillView");
+    qmlRegisterType<AbstractDelegate>("Mycroft", 1, 0, "AbstractDelegate");
+
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/AudioPlayer.qml")), "Mycroft", 1, 0, "AudioPlayer");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/AutoFitLabel.qml")), "Mycroft", 1, 0, "AutoFitLabel");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/Delegate.qml")), "Mycroft", 1, 0, "Delegate");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/PaginatedText.qml")), "Mycroft", 1, 0, "PaginatedText");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/ProportionalDelegate.qml")), "Mycroft", 1, 0, "ProportionalDelegate");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/ScrollableDelegate.qml")), "Mycroft", 1, 0, "ScrollableDelegate");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/SkillView.qml")), "Mycroft", 1, 0, "SkillView");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/SlideShow.qml")), "Mycroft", 1, 0, "SlideShow");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/SlidingImage.qml")), "Mycroft", 1, 0, "SlidingImage");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/StatusIndicator.qml")), "Mycroft", 1, 0, "StatusIndicator");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/VideoPlayer.qml")), "Mycroft", 1, 0, "VideoPlayer");
+
+    qmlRegisterUncreatableType<ActiveSkillsModel>("Mycroft", 1, 0, "ActiveSkillsModel", QStringLiteral("You cannot instantiate items of type ActiveSkillsModel"));
+    qmlRegisterUncreatableType<DelegatesModel>("Mycroft", 1, 0, "DelegatesModel", QStringLiteral("You cannot instantiate items of type DelegatesModel"));
+    qmlRegisterUncreatableType<SessionDataMap>("Mycroft", 1, 0, "SessionDataMap", QStringLiteral("You cannot instantiate items of type SessionDataMap"));
+
+    qmlProtectModule("Mycroft", 1);
+}
+
+class TrafficPlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TrafficPlayer(const QVector<TrafficRecorder::Frame> &frames, double speed, QObject *parent = nullptr);
+    ~TrafficPlayer() override;
+
+    bool start();
+
+    /**
+     * What happened, filled once finished is emitted
+     */
+    QVariantMap report() const;
+
+Q_SIGNALS:
+    void finished();
+    void failed(const QString &reason);
+
+private:
+    void onBusConnection();
+    void onGuiConnection();
+    void sendDue();
+    void sendFrame(const TrafficRecorder::Frame &frame);
+    void waitHandled();
+    quint64 handledCount() const;
+
+    QVector<TrafficRecorder::Frame> m_frames;
+    double m_speed;
+    bool m_binaryGui = false;
+
+    QWebSocketServer m_busServer;
+    QWebSocketServer m_guiServer;
+    QWebSocket *m_bus = nullptr;
+    QWebSocket *m_gui = nullptr;
+
+    QQmlEngine m_engine;
+    AbstractSkillView *m_view = nullptr;
+
+    int m_next = 0;
+    QElapsedTimer m_clock;
+    QTimer m_sendTimer;
+    QTimer m_settleTimer;
+    qint64 m_sentAt = 0;
+    qint64 m_doneAt = 0;
+    quint64 m_lastHandled = 0;
+    qint64 m_lastProgress = 0;
+    quint64 m_sent[2] = {0, 0};
+    quint64 m_bytes[2] = {0, 0};
+};
+
+TrafficPlayer::TrafficPlayer(const QVector<TrafficRecorder::Frame> &frames, double speed, QObject *parent)
+    : QObject(parent),
+      m_frames(frames),
+      m_speed(speed),
+      m_busServer(QStringLiteral("core"), QWebSocketServer::NonSecureMode),
+      m_guiServer(QStringLiteral("gui"), QWebSocketServer::NonSecureMode)
+{
+    for (const auto &frame : m_frames) {
+        m_binaryGui = m_binaryGui || (frame.channel == Metrics::GuiChannel && frame.binary);
+    }
+
+    m_sendTimer.setSingleShot(true);
+    connect(&m_sendTimer, &QTimer::timeout, this, &TrafficPlayer::sendDue);
+    m_settleTimer.setInterval(20);
+    connect(&m_settleTimer, &QTimer::timeout, this, &TrafficPlayer::waitHandled);
+
+    connect(&m_busServer, &QWebSocketServer::newConnection, this, &TrafficPlayer::onBusConnection);
+    connect(&m_guiServer, &QWebSocketServer::newConnection, this, &TrafficPlayer::onGuiConnection);
+}
+
+TrafficPlayer::~TrafficPlayer()
+{
+    delete m_view;
+}
+
+bool TrafficPlayer::start()
+{
+    if (!m_busServer.listen(QHostAddress::LocalHost, s_busPort) || !m_guiServer.listen(QHostAddress::LocalHost, s_guiPort)) {
+        qCritical() << "Can't listen on the ports" << s_busPort << "and" << s_guiPort << "is something else using them?";
+        return false;
+    }
+
+    // The latencies come from the timings of the gui itself
+    Metrics::instance()->setEnabled(true);
+    Metrics::instance()->reset();
+
+    registerMycroftTypes(&m_engine);
+    m_view = new AbstractSkillView;
+    // As if it was created from QML: the delegates get created in its engine
+    QQmlEngine::setContextForObject(m_view, m_engine.rootContext());
+
+    MycroftController::instance()->start();
+    return true;
+}
+
+void TrafficPlayer::onBusConnection()
+{
+    QWebSocket *socket = m_busServer.nextPendingConnection();
+    if (m_bus) {
+        socket->deleteLater();
+        return;
+    }
+    m_bus = socket;
+    m_bus->setParent(this);
+
+    // The gui announces itself on the bus, and gets told where to connect
+    connect(m_bus, &QWebSocket::textMessageReceived, this, [this](const QString &message) {
+        const QJsonObject doc = QJsonDocument::fromJson(message.toUtf8()).object();
+        if (m_gui || doc.value(QStringLiteral("type")).toString() != QLatin1String("mycroft.gui.connected")) {
+            return;
+        }
+
+        QJsonObject data({
+            {QStringLiteral("gui_id"), doc.value(QStringLiteral("data")).toObject().value(QStringLiteral("gui_id"))},
+            {QStringLiteral("port"), s_guiPort}
+        });
+        if (m_binaryGui) {
+            data[QStringLiteral("framing")] = QStringLiteral("cbor");
+        }
+        const QJsonObject port({
+            {QStringLiteral("type"), QStringLiteral("mycroft.gui.port")},
+            {QStringLiteral("data"), data}
+        });
+        m_bus->sendTextMessage(QString::fromUtf8(QJsonDocument(port).toJson(QJsonDocument::Compact)));
+    });
+}
+
+void TrafficPlayer::onGuiConnection()
+{
+    QWebSocket *socket = m_guiServer.nextPendingConnection();
+    if (m_gui) {
+        socket->deleteLater();
+        return;
+    }
+    m_gui = socket;
+    m_gui->setParent(this);
+
+    connect(m_gui, &QWebSocket::disconnected, this, [this]() {
+        if (m_doneAt == 0) {
+            emit failed(QStringLiteral("The gui disconnected during the replay"));
+        }
+    });
+
+    // Only what came from now on is about the recording
+    Metrics::instance()->reset();
+    m_clock.start();
+    sendDue();
+}
+
+void TrafficPlayer::sendDue()
+{
+    const qint64 elapsed = m_clock.nsecsElapsed() / 1000;
+    int batch = 0;
+
+    while (m_next < m_frames.count()) {
+        const TrafficRecorder::Frame &frame = m_frames[m_next];
+
+        if (m_speed > 0) {
+            const qint64 due = qint64(frame.time / m_speed);
+            if (due > elapsed) {
+                m_sendTimer.start(int(qMax<qint64>(1, (due - elapsed) / 1000)));
+                return;
+            }
+        } else if (batch++ == s_flatOutBatch) {
+            m_sendTimer.start(0);
+            return;
+        }
+
+        sendFrame(frame);
+        ++m_next;
+    }
+
+    m_sentAt = m_clock.nsecsElapsed();
+    m_lastProgress = m_sentAt;
+    m_settleTimer.start();
+}
+
+void TrafficPlayer::sendFrame(const TrafficRecorder::Frame &frame)
+{
+    QWebSocket *socket = frame.channel == Metrics::GuiChannel ? m_gui : m_bus;
+
+    if (frame.binary) {
+        socket->sendBinaryMessage(frame.payload);
+    } else {
+        socket->sendTextMessage(QString::fromUtf8(frame.payload));
+    }
+
+    ++m_sent[frame.channel];
+    m_bytes[frame.channel] += quint64(frame.payload.size());
+}
+
+quint64 TrafficPlayer::handledCount() const
+{
+    const QVariantMap latency = Metrics::instance()->snapshot().value(QStringLiteral("timings")).toMap().value(QStringLiteral("gui.latency")).toMap();
+    return latency.value(QStringLiteral("count")).toULongLong();
+}
+
+void TrafficPlayer::waitHandled()
+{
+    // Frames never handled, like the invalid ones, only make it wait for the timeout
+    const quint64 handled = handledCount();
+    const qint64 now = m_clock.nsecsElapsed();
+
+    if (handled != m_lastHandled) {
+        m_lastHandled = handled;
+        m_lastProgress = now;
+    }
+
+    if (handled < m_sent[Metrics::GuiChannel] && now - m_lastProgress < qint64(s_settleTimeout) * 1000000) {
+        return;
+    }
+
+    m_settleTimer.stop();
+    m_doneAt = m_lastProgress;
+    emit finished();
+}
+
+QVariantMap TrafficPlayer::report() const
+{
+    const QVariantMap metrics = Metrics::instance()->snapshot();
+    const double seconds = double(qMax<qint64>(1, m_doneAt)) / 1000000000;
+    const quint64 frames = m_sent[Metrics::BusChannel] + m_sent[Metrics::GuiChannel];
+    const quint64 bytes = m_bytes[Metrics::BusChannel] + m_bytes[Metrics::GuiChannel];
+
+    return QVariantMap({
+        {QStringLiteral("speed"), m_speed},
+        {QStringLiteral("recordedSeconds"), m_frames.isEmpty() ? 0.0 : double(m_frames.last().time) / 1000000},
+        {QStringLiteral("sendSeconds"), double(m_sentAt) / 1000000000},
+        {QStringLiteral("seconds"), seconds},
+        {QStringLiteral("busFrames"), m_sent[Metrics::BusChannel]},
+        {QStringLiteral("guiFrames"), m_sent[Metrics::GuiChannel]},
+        {QStringLiteral("handledGuiMessages"), m_lastHandled},
+        {QStringLiteral("framesPerSecond"), frames / seconds},
+        {QStringLiteral("bytesPerSecond"), bytes / seconds},
+        {QStringLiteral("latency"), metrics.value(QStringLiteral("timings")).toMap().value(QStringLiteral("gui.latency"))},
+        {QStringLiteral("peakMemoryKiB"), peakMemory()},
+        {QStringLiteral("metrics"), metrics}
+    });
+}
+
+static void printReport(const QVariantMap &report)
+{
+    QTextStream out(stdout);
+    const QVariantMap latency = report.value(QStringLiteral("latency")).toMap();
+
+    out << "Replayed " << report.value(QStringLiteral("busFrames")).toULongLong() << " bus and "
+        << report.value(QStringLiteral("guiFrames")).toULongLong() << " gui frames, recorded in "
+        << report.value(QStringLiteral("recordedSeconds")).toDouble() << "s, in "
+        << report.value(QStringLiteral("seconds")).toDouble() << "s\n";
+    out << "Throughput: " << report.value(QStringLiteral("framesPerSecond")).toDouble() << " frames/s, "
+        << report.value(QStringLiteral("bytesPerSecond")).toDouble() / 1024 << " KiB/s\n";
+    out << "Gui messages handled: " << report.value(QStringLiteral("handledGuiMessages")).toULongLong() << "\n";
+    // The histograms are log2 buckets: these are the upper bounds of the buckets
+    out << "Latency (us, at most): p50 " << latency.value(QStringLiteral("p50")).toLongLong()
+        << " p90 " << latency.value(QStringLiteral("p90")).toLongLong()
+        << " p99 " << latency.value(QStringLiteral("p99")).toLongLong()
+        << " max " << latency.value(QStringLiteral("max")).toDouble() << "\n";
+    out << "Peak memory: " << report.value(QStringLiteral("peakMemoryKiB")).toLongLong() << " KiB\n";
+}
+
+int main(int argc, char *argv[])
+{
+    // Nothing gets shown, it doesn't need a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication app(argc, argv);
+    // Settings of its own: the defaults connect to the local core, which is the fake one
+    app.setApplicationName(QStringLiteral("mycroft.gui.trafficreplay"));
+    app.setOrganizationDomain(QStringLiteral("kde.org"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replays recorded Mycroft traffic against the gui"));
+    parser.addHelpOption();
+    QCommandLineOption speedOption({QStringLiteral("s"), QStringLiteral("speed")},
+                                   QStringLiteral("Playback speed, 1 as recorded, 0 as fast as possible."),
+                                   QStringLiteral("factor"), QStringLiteral("1"));
+    QCommandLineOption jsonOption(QStringLiteral("json"), QStringLiteral("Print the report as JSON, with all the metrics."));
+    QCommandLineOption verboseOption({QStringLiteral("v"), QStringLiteral("verbose")}, QStringLiteral("Show the warnings of the gui."));
+    parser.addOption(speedOption);
+    parser.addOption(jsonOption);
+    parser.addOption(verboseOption);
+    parser.addPositionalArgument(QStringLiteral("recording"), QStringLiteral("File written with MYCROFT_GUI_RECORD set."));
+    parser.process(app);
+
+    if (parser.positionalArguments().count() != 1) {
+        parser.showHelp(1);
+    }
+
+    bool ok = false;
+    const double speed = parser.value(speedOption).toDouble(&ok);
+    if (!ok || speed < 0) {
+        qCritical() << "Invalid speed" << parser.value(speedOption);
+        return 1;
+    }
+
+    // The gui is chatty, that would be most of the time spent
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false\ndefault.warning=false"));
+    }
+
+    const QVector<TrafficRecorder::Frame> frames = TrafficRecorder::load(parser.positionalArguments().first());
+    if (frames.isEmpty()) {
+        qCritical() << "Nothing to replay";
+        return 1;
+    }
+
+    TrafficPlayer player(frames, speed);
+    int result = 0;
+
+    QObject::connect(&player, &TrafficPlayer::finished, &app, [&]() {
+        const QVariantMap report = player.report();
+        if (parser.isSet(jsonOption)) {
+            QTextStream(stdout) << QJsonDocument::fromVariant(report).toJson();
+        } else {
+            printReport(report);
+        }
+        app.quit();
+    });
+    QObject::connect(&player, &TrafficPlayer::failed, &app, [&](const QString &reason) {
+        qCritical().noquote() << reason;
+        result = 1;
+        app.quit();
+    });
+
+    if (!player.start()) {
+        return 1;
+    }
+
+    const int status = app.exec();
+    return result ? result : status;
+}
+
+#include "trafficreplay.moc"
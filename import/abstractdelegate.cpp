@@ -16,6 +16,9 @@
  */
 
 #include "abstractdelegate.h"
+#include "componentcache.h"
+#include "delegateincubator.h"
+#include "metrics.h"
 #include "mycroftcontroller.h"
 
 #include <QQmlEngine>
@@ -29,9 +32,16 @@ DelegateLoader::DelegateLoader(AbstractSkillView *parent)
 
 DelegateLoader::~DelegateLoader()
 {
+    // Deletes the object as well if it's still being incubated
+    delete m_incubator;
+
     if (m_delegate) {
         m_delegate->deleteLater();
     }
+
+    if (m_componentCache && m_component) {
+        m_componentCache->release(m_component->engine(), m_delegateUrl);
+    }
 }
 
 void DelegateLoader::init(const QString skillId, const QUrl &delegateUrl)
@@ -46,7 +56,13 @@ void DelegateLoader::init(const QString skillId, const QUrl &delegateUrl)
     //This class should be *ALWAYS* created from QML
     Q_ASSERT(engine);
 
-    m_component = new QQmlComponent(engine, delegateUrl, m_view);
+    IncubationController::ensureController(engine);
+
+    m_componentCache = m_view->componentCache();
+    if (Metrics::instance()->enabled()) {
+        m_compileStart = Metrics::now();
+    }
+    m_component = m_componentCache->acquire(engine, delegateUrl);
 
     switch(m_component->status()) {
     case QQmlComponent::Error:
@@ -54,6 +70,7 @@ void DelegateLoader::init(const QString skillId, const QUrl &delegateUrl)
         for (auto err : m_component->errors()) {
             qWarning() << err.toString();
         }
+        setLoading(false);
         break;
     case QQmlComponent::Ready:
         createObject();
@@ -66,56 +83,150 @@ void DelegateLoader::init(const QString skillId, const QUrl &delegateUrl)
     }
 }
 
-QUrl DelegateLoader::translationsUrl() const
+QUrl DelegateLoader::translationsUrl(const QUrl &delegateUrl)
 {
-    QUrl url(m_delegateUrl);
-    url.setPath(m_delegateUrl.path().mid(0, m_delegateUrl.path().indexOf(QStringLiteral("/ui/")) + 4) + QStringLiteral("translations"));
+    QUrl url(delegateUrl);
+    url.setPath(delegateUrl.path().mid(0, delegateUrl.path().indexOf(QStringLiteral("/ui/")) + 4) + QStringLiteral("translations"));
 
     return url;
 }
 
+bool DelegateLoader::isLoading() const
+{
+    return m_loading;
+}
+
+void DelegateLoader::setLoading(bool loading)
+{
+    if (m_loading == loading) {
+        return;
+    }
+
+    m_loading = loading;
+    emit loadingChanged();
+}
+
 void DelegateLoader::createObject()
 {
+    if (m_incubator) {
+        return;
+    }
+
+    if (m_component->isError()) {
+        qWarning() << "ERROR Loading QML file" << m_delegateUrl;
+        for (auto err : m_component->errors()) {
+            qWarning() << err.toString();
+        }
+        setLoading(false);
+        return;
+    }
+
+    if (!m_component->isReady()) {
+        return;
+    }
+
     QQmlContext *context = QQmlEngine::contextForObject(m_view);
     //This class should be *ALWAYS* created from QML
     Q_ASSERT(context);
 
-    QObject *guiObject = m_component->beginCreate(context);
-    m_delegate = qobject_cast<AbstractDelegate *>(guiObject);
-    if (m_component->isError()) {
+    // Components from the cache are ready right away, recorded as well
+    if (m_compileStart > 0) {
+        m_incubationStart = Metrics::now();
+        Metrics::instance()->recordTiming(QStringLiteral("delegate.compile"), m_incubationStart - m_compileStart);
+        m_compileStart = 0;
+    }
+
+    // The object tree is built across several frames, incubationFinished is called when done
+    m_incubator = new DelegateIncubator(this);
+    m_component->create(*m_incubator, context);
+}
+
+void DelegateLoader::setupObject(QObject *object)
+{
+    AbstractDelegate *delegate = qobject_cast<AbstractDelegate *>(object);
+    if (!delegate) {
+        return;
+    }
+
+    delegate->setSkillId(m_skillId);
+    delegate->setQmlUrl(m_delegateUrl);
+    delegate->setSkillView(m_view);
+    delegate->setSessionData(m_view->sessionDataForSkill(m_skillId));
+}
+
+void DelegateLoader::incubationFinished()
+{
+    if (m_incubator->isError()) {
         qWarning() << "ERROR Loading QML file" << m_delegateUrl;
-        for (auto err : m_component->errors()) {
+        for (auto err : m_incubator->errors()) {
             qWarning() << err.toString();
         }
+        setLoading(false);
         return;
     }
 
+    QObject *guiObject = m_incubator->object();
+    m_delegate = qobject_cast<AbstractDelegate *>(guiObject);
+
     if (!m_delegate) {
         qWarning()<<"ERROR: QML gui" << guiObject << "not a Mycroft.AbstractDelegate instance";
         guiObject->deleteLater();
+        setLoading(false);
         return;
     }
 
     connect(m_delegate, &QObject::destroyed, this, &QObject::deleteLater);
 
-    m_delegate->setSkillId(m_skillId);
-    m_delegate->setQmlUrl(m_delegateUrl);
-    m_delegate->setSkillView(m_view);
-    m_delegate->setSessionData(m_view->sessionDataForSkill(m_skillId));
-    m_component->completeCreate();
+    if (m_incubationStart > 0) {
+        Metrics::instance()->recordTiming(QStringLiteral("delegate.incubation"), Metrics::now() - m_incubationStart);
+        m_incubationStart = 0;
+    }
+    Metrics::instance()->recordNextFrame(m_view->window(), m_requestedAt);
 
+    setLoading(false);
     emit delegateCreated();
 
     if (m_focus) {
         m_delegate->forceActiveFocus((Qt::FocusReason)AbstractSkillView::ServerEventFocusReason);
     }
-};
+}
+
+void DelegateLoader::setRequestedAt(qint64 requestedAt)
+{
+    m_requestedAt = requestedAt;
+}
+
+void DelegateLoader::recycle()
+{
+    if (!m_view || !m_delegate) {
+        deleteLater();
+        return;
+    }
+
+    m_view->delegatePool()->park(this);
+}
+
+void DelegateLoader::rebind()
+{
+    if (!m_delegate) {
+        return;
+    }
+
+    // The skill may have been deactivated meanwhile, with its data
+    m_delegate->setSessionData(m_view->sessionDataForSkill(m_skillId));
+    m_delegate->setSkillView(m_view);
+}
 
 AbstractDelegate *DelegateLoader::delegate()
 {
     return m_delegate;
 }
 
+QUrl DelegateLoader::url() const
+{
+    return m_delegateUrl;
+}
+
 void DelegateLoader::setFocus(bool focus)
 {
     m_focus = focus;
@@ -139,6 +250,9 @@ AbstractDelegate::AbstractDelegate(QQuickItem *parent)
 
 AbstractDelegate::~AbstractDelegate()
 {
+    if (m_skillView) {
+        m_skillView->unsubscribeDelegateEvents(this, m_handledEvents);
+    }
 }
 
 void AbstractDelegate::triggerGuiEvent(const QString &eventName, const QVariantMap &parameters)
@@ -507,9 +621,18 @@ int AbstractDelegate::contentHeight() const
 
 void AbstractDelegate::setSkillView(AbstractSkillView *view)
 {
-    //possible to call only once, by the skillview, setting itself upon instantiation
-    Q_ASSERT(!m_skillView);
+    if (m_skillView == view) {
+        return;
+    }
+
+    if (m_skillView) {
+        m_skillView->unsubscribeDelegateEvents(this, m_handledEvents);
+    }
     m_skillView = view;
+
+    if (m_skillView) {
+        m_skillView->subscribeDelegateEvents(this, m_handledEvents);
+    }
 }
 
 AbstractSkillView *AbstractDelegate::skillView() const
@@ -519,9 +642,12 @@ AbstractSkillView *AbstractDelegate::skillView() const
 
 void AbstractDelegate::setSessionData(SessionDataMap *data)
 {
-    //possible to call only once, by the skillview upon instantiation
-    Q_ASSERT(!m_data);
+    if (m_data == data) {
+        return;
+    }
+
     m_data = data;
+    emit sessionDataChanged();
 }
 
 SessionDataMap *AbstractDelegate::sessionData() const
@@ -553,4 +679,24 @@ QString AbstractDelegate::skillId() const
     return m_skillId;
 }
 
+QStringList AbstractDelegate::handledEvents() const
+{
+    return m_handledEvents;
+}
+
+void AbstractDelegate::setHandledEvents(const QStringList &events)
+{
+    if (m_handledEvents == events) {
+        return;
+    }
+
+    if (m_skillView) {
+        m_skillView->unsubscribeDelegateEvents(this, m_handledEvents);
+        m_skillView->subscribeDelegateEvents(this, events);
+    }
+
+    m_handledEvents = events;
+    emit handledEventsChanged();
+}
+
 #include "moc_abstractdelegate.cpp"
@@ -26,6 +26,8 @@
 #include "abstractskillview.h"
 
 class MycroftController;
+class DelegateIncubator;
+class ComponentCache;
 
 class DelegateLoader : public QObject {
     Q_OBJECT
@@ -36,22 +38,68 @@ public:
     void init(const QString skillId, const QUrl &url);
     AbstractDelegate *delegate();
 
+    /**
+     * Url of the QML file, empty until init
+     */
+    QUrl url() const;
+
     void setFocus(bool focus);
 
-    QUrl translationsUrl() const;
+    /**
+     * Metrics::now() when the server asked for this delegate, to measure how long
+     * it takes to show it. 0 (default) if unknown.
+     */
+    void setRequestedAt(qint64 requestedAt);
+
+    /**
+     * Called when no model uses this loader anymore: parks it in the
+     * DelegatePool of the view to be shown again, or deletes it if it can't be reused
+     */
+    void recycle();
+
+    /**
+     * Binds a loader taken from the DelegatePool to the current
+     * session data of its skill and to the view again
+     */
+    void rebind();
+
+    /**
+     * @returns where the translations of the skill shipping delegateUrl are
+     */
+    static QUrl translationsUrl(const QUrl &delegateUrl);
+
+    /**
+     * True until the delegate object is either created or failed to load
+     */
+    bool isLoading() const;
 
 Q_SIGNALS:
     void delegateCreated();
+    void loadingChanged();
 
 private:
     void createObject();
+    // Called by the incubator before the object bindings get evaluated
+    void setupObject(QObject *object);
+    void incubationFinished();
+    void setLoading(bool loading);
 
     QString m_skillId;
     QUrl m_delegateUrl;
     bool m_focus = false;
+    bool m_loading = true;
+    qint64 m_requestedAt = 0;
+    // Metrics::now() when the component was asked for and when the incubation began, 0 if not measured
+    qint64 m_compileStart = 0;
+    qint64 m_incubationStart = 0;
     QQmlComponent *m_component = nullptr;
+    // The component is shared with other loaders of the same url, the cache owns it
+    QPointer<ComponentCache> m_componentCache;
+    DelegateIncubator *m_incubator = nullptr;
     AbstractSkillView *m_view;
     QPointer <AbstractDelegate> m_delegate;
+
+    friend class DelegateIncubator;
 };
 
 class AbstractDelegate: public QQuickItem
@@ -62,7 +110,7 @@ class AbstractDelegate: public QQuickItem
     /**
      * The skill data sent by the server.
      */
-    Q_PROPERTY(SessionDataMap *sessionData READ sessionData CONSTANT)
+    Q_PROPERTY(SessionDataMap *sessionData READ sessionData NOTIFY sessionDataChanged)
 
     /**
      * When true the delegate will always take the full screen width. (default false)
@@ -90,6 +138,13 @@ class AbstractDelegate: public QQuickItem
      */
     Q_PROPERTY(QColor skillBackgroundColorOverlay MEMBER m_skillBackgroundColorOverlay NOTIFY skillBackgroundColorOverlayChanged)
 
+    /**
+     * Names of the events this delegate wants to receive with guiEvent, either system events or events of its own skill.
+     * When empty (the default) the delegate receives every event.
+     * Declaring the handled events avoids the view waking up delegates for events they would ignore anyways.
+     */
+    Q_PROPERTY(QStringList handledEvents READ handledEvents WRITE setHandledEvents NOTIFY handledEventsChanged)
+
     Q_PROPERTY(QQuickItem *contentItem READ contentItem WRITE setContentItem NOTIFY contentItemChanged)
     Q_PROPERTY(bool contentItemAutoHeight MEMBER m_contentItemAutoHeight NOTIFY contentItemAutoHeightChanged)
     Q_PROPERTY(bool contentItemAutoWidth MEMBER m_contentItemAutoWidth NOTIFY contentItemAutoWidthChanged)
@@ -170,15 +225,22 @@ public:
     int contentWidth() const;
     int contentHeight() const;
 
+    QStringList handledEvents() const;
+    void setHandledEvents(const QStringList &events);
+
 /*
  * @internal All the following API is meant to be used only by AbstractSkillView during initialization, *NOT* QML from where is not accessible at all.
  */
 
     /**
-     * The sessiondata is writable only by AbstractskillView internally, not from QML
+     * The sessiondata is writable only by AbstractskillView internally, not from QML.
+     * It's set upon instantiation and again when the delegate gets reused from the DelegatePool
      */
     void setSessionData(SessionDataMap *data);
 
+    /**
+     * Also subscribes the delegate to the events of the view, nullptr while it's parked in the DelegatePool
+     */
     void setSkillView(AbstractSkillView *view);
     AbstractSkillView *skillView() const;
 
@@ -248,6 +310,8 @@ Q_SIGNALS:
     void bottomInsetChanged();
     void contentWidthChanged();
     void contentHeightChanged();
+    void handledEventsChanged();
+    void sessionDataChanged();
 
 private:
     void syncChildItemsGeometry(const QSizeF &size);
@@ -270,6 +334,7 @@ private:
 
     QUrl m_qmlUrl;
     QString m_skillId;
+    QStringList m_handledEvents;
 
     QString m_backgroundSource;
     QColor m_skillBackgroundColorOverlay = Qt::transparent;
@@ -21,16 +21,27 @@
 #include "abstractdelegate.h"
 #include "sessiondatamap.h"
 #include "sessiondatamodel.h"
+#include "sessiondatapatch.h"
+#include "sessionstore.h"
+#include "sessionsnapshot.h"
 #include "delegatesmodel.h"
+#include "messagequeue.h"
+#include "componentcache.h"
+#include "connectionmonitor.h"
+#include "delegatepool.h"
+#include "skilltranslator.h"
+#include "socketconnection.h"
+#include "metrics.h"
 
-#include <QWebSocket>
 #include <QUuid>
+#include <QCryptographicHash>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QQmlContext>
 #include <QQmlEngine>
-#include <QTranslator>
+#include <QCoreApplication>
+#include <QStandardPaths>
 
 AbstractSkillView::AbstractSkillView(QQuickItem *parent)
     : QQuickItem(parent),
@@ -39,82 +50,167 @@ AbstractSkillView::AbstractSkillView(QQuickItem *parent)
 {
     m_activeSkillsModel = new ActiveSkillsModel(this);
 
-    m_guiWebSocket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    m_componentCache = new ComponentCache(this);
+    m_delegatePool = new DelegatePool(this);
+
+    // A single translator for all the skills, so their translations can be added without a LanguageChange each
+    m_translator = new SkillTranslator(this);
+    QCoreApplication::installTranslator(m_translator);
+    connect(m_translator, &SkillTranslator::loaded, this, &AbstractSkillView::initPendingLoaders);
+
+    m_resumeGraceTimer.setInterval(30000);
+    m_resumeGraceTimer.setSingleShot(true);
+    connect(&m_resumeGraceTimer, &QTimer::timeout, this, &AbstractSkillView::resetState);
+
+    m_resumeReplyTimer.setInterval(5000);
+    m_resumeReplyTimer.setSingleShot(true);
+    connect(&m_resumeReplyTimer, &QTimer::timeout, this, [this]() {
+        qWarning() << "No answer to mycroft.gui.resume, resetting the gui state";
+        m_resuming = false;
+        resetState();
+    });
+
+    // A skill showing up is a burst of messages: saved once for all of them
+    m_snapshotTimer.setInterval(500);
+    m_snapshotTimer.setSingleShot(true);
+    connect(&m_snapshotTimer, &QTimer::timeout, this, &AbstractSkillView::writeSnapshot);
+
+    // Followers go through the connection of the view they follow, they get one only if promoted
     m_controller->registerView(this);
+    if (!m_guiChannel) {
+        setupGuiConnection();
+    }
+
+    connect(m_controller, &MycroftController::utteranceManagedBySkill, this,
+        [this](const QString &skillId) {
+            // The skill will likely show a page while it's answering: have it compiled by then
+            preloadSkillDelegates(skillId);
+            m_activeSkillsModel->checkGuiActivation(skillId);
+        });
+
+    connect(m_activeSkillsModel, &ActiveSkillsModel::rowsInserted, this, &AbstractSkillView::enforceLiveSkills);
+    connect(m_activeSkillsModel, &ActiveSkillsModel::rowsMoved, this, &AbstractSkillView::enforceLiveSkills);
+    connect(m_activeSkillsModel, &ActiveSkillsModel::rowsRemoved, this, &AbstractSkillView::enforceLiveSkills);
+
+    m_guiMessageHandlers.resize(GuiMessage::TypeCount);
+    registerGuiMessageHandler(GuiMessage::SessionSet, &AbstractSkillView::handleSessionSet);
+    registerGuiMessageHandler(GuiMessage::SessionDelete, &AbstractSkillView::handleSessionDelete);
+    registerGuiMessageHandler(GuiMessage::SessionPatch, &AbstractSkillView::handleSessionPatch);
+    registerGuiMessageHandler(GuiMessage::ActiveSkillsInsert, &AbstractSkillView::handleActiveSkillsInsert);
+    registerGuiMessageHandler(GuiMessage::ActiveSkillsRemove, &AbstractSkillView::handleActiveSkillsRemove);
+    registerGuiMessageHandler(GuiMessage::ActiveSkillsMove, &AbstractSkillView::handleActiveSkillsMove);
+    registerGuiMessageHandler(GuiMessage::GuiListInsert, &AbstractSkillView::handleGuiListInsert);
+    registerGuiMessageHandler(GuiMessage::GuiListRemove, &AbstractSkillView::handleGuiListRemove);
+    registerGuiMessageHandler(GuiMessage::GuiListMove, &AbstractSkillView::handleGuiListMove);
+    registerGuiMessageHandler(GuiMessage::SessionListInsert, &AbstractSkillView::handleSessionListInsert);
+    registerGuiMessageHandler(GuiMessage::SessionListUpdate, &AbstractSkillView::handleSessionListUpdate);
+    registerGuiMessageHandler(GuiMessage::SessionListMove, &AbstractSkillView::handleSessionListMove);
+    registerGuiMessageHandler(GuiMessage::SessionListRemove, &AbstractSkillView::handleSessionListRemove);
+    registerGuiMessageHandler(GuiMessage::SessionListPaged, &AbstractSkillView::handleSessionListPaged);
+    registerGuiMessageHandler(GuiMessage::EventTriggered, &AbstractSkillView::handleEventTriggered);
+    registerGuiMessageHandler(GuiMessage::Resume, &AbstractSkillView::handleResume);
+}
+
+AbstractSkillView::~AbstractSkillView()
+{
+    QCoreApplication::removeTranslator(m_translator);
+
+    if (m_snapshot) {
+        // The pages the user moved to didn't come with a message
+        for (const auto &skillId : m_activeSkillsModel->activeSkills()) {
+            m_snapshotDirty.insert(skillId);
+        }
+        writeSnapshot();
+        delete m_snapshot;
+    }
+
+    if (m_guiChannel) {
+        m_guiChannel->m_followers.removeAll(this);
+    }
+    if (m_sessionStore) {
+        for (auto it = m_skillStates.begin(); it != m_skillStates.end(); ++it) {
+            releaseSessionData(it.key(), it.value());
+        }
+    }
+    m_controller->unregisterView(this);
+}
+
+
+void AbstractSkillView::setupGuiConnection()
+{
+    if (m_guiWebSocket) {
+        return;
+    }
 
-    connect(m_guiWebSocket, &QWebSocket::connected, this,
+    m_guiWebSocket = new SocketConnection(SocketWorker::GuiDecoder, this);
+    m_outboundQueue = new MessageQueue(m_guiWebSocket, this);
+    m_connectionMonitor = new ConnectionMonitor(m_guiWebSocket, this);
+    m_outboundQueue->setBinaryFraming(m_framing == CborFraming);
+
+    connect(m_guiWebSocket, &SocketConnection::connected, this,
             [this] () {
-                m_reconnectTimer.stop();
+                requestResume();
                 emit statusChanged();
             });
 
-    connect(m_guiWebSocket, &QWebSocket::disconnected, this, &AbstractSkillView::closed);
-
-    connect(m_guiWebSocket, &QWebSocket::disconnected, this, [this]() {
-        m_activeSkillsModel->removeRows(0, m_activeSkillsModel->rowCount());
+    connect(m_guiWebSocket, &SocketConnection::disconnected, this, &AbstractSkillView::closed);
+
+    // Connections often come back right away: keep the pages on screen for a while instead of rebuilding them
+    connect(m_guiWebSocket, &SocketConnection::disconnected, this, [this]() {
+        m_outboundQueue->clear();
+        // The pages asked for are gone with the connection, even if the resume keeps the lists
+        cancelListFetches();
+        m_resuming = false;
+        m_resumeReplyTimer.stop();
+        if (!m_resumeGraceTimer.isActive()) {
+            m_resumeGraceTimer.start();
+        }
     });
 
-    connect(m_guiWebSocket, &QWebSocket::stateChanged, this,
+    connect(m_guiWebSocket, &SocketConnection::stateChanged, this,
             [this] (QAbstractSocket::SocketState state) {
                 emit statusChanged();
             });
 
-    connect(m_guiWebSocket, &QWebSocket::textMessageReceived, this, &AbstractSkillView::onGuiSocketMessageReceived);
+    connect(m_guiWebSocket, &SocketConnection::guiMessageReceived, this, &AbstractSkillView::dispatchGuiMessage);
 
-    connect(m_guiWebSocket, &QWebSocket::stateChanged, this,
+    connect(m_guiWebSocket, &SocketConnection::stateChanged, this,
             [this](QAbstractSocket::SocketState socketState) {
                 //TODO: when the connection closes, all session data and guis should be destroyed
                 //qWarning()<<"GUI SOCKET STATE:"<<socketState;
                 //Try to reconnect if our connection died but the main server connection is still alive
                 if (socketState == QAbstractSocket::UnconnectedState && m_url.isValid() && m_controller->status() == MycroftController::Open) {
-                    m_reconnectTimer.start();
+                    m_connectionMonitor->scheduleReconnect();
                 }
             });
 
-    connect(m_guiWebSocket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this,
+    connect(m_guiWebSocket, &SocketConnection::error, this,
             [this](QAbstractSocket::SocketError error) {
                 qWarning() << "Gui socket Connection Error:" << error;
-                m_reconnectTimer.start();
+                m_connectionMonitor->scheduleReconnect();
             });
 
 
     connect(m_controller, &MycroftController::socketStatusChanged, this,
             [this]() {
                 if (m_controller->status() != MycroftController::Open) {
+                    m_connectionMonitor->stop();
                     m_guiWebSocket->close();
                     //don't assume the url will be still valid
                     m_url = QUrl();
                 }
             });
 
-    // Reconnect timer
-    m_reconnectTimer.setInterval(1000);
-    connect(&m_reconnectTimer, &QTimer::timeout, this, [this]() {
+    connect(m_connectionMonitor, &ConnectionMonitor::reconnectRequested, this, [this]() {
+        // The core will announce a new url once it's back
+        if (!m_url.isValid()) {
+            return;
+        }
         m_guiWebSocket->close();
         m_guiWebSocket->open(m_url);
     });
-
-    // Trim components cache timer
-    m_trimComponentsTimer.setInterval(100);
-    m_trimComponentsTimer.setSingleShot(true);
-    connect(&m_trimComponentsTimer, &QTimer::timeout, this, [this]() {
-        QQmlEngine *engine = qmlEngine(this);
-        if (engine) {
-            engine->clearComponentCache();
-        }
-    });
-
-    connect(m_controller, &MycroftController::utteranceManagedBySkill, this,
-        [this](const QString &skillId) {
-            m_activeSkillsModel->checkGuiActivation(skillId);
-        });
-}
-
-AbstractSkillView::~AbstractSkillView()
-{
 }
 
-
 QUrl AbstractSkillView::url() const
 {
     return m_url;
@@ -128,13 +224,41 @@ void AbstractSkillView::setUrl(const QUrl &url)
 
     m_url = url;
 
-    //don't connect if the controller is offline
-    if (m_controller->status() == MycroftController::Open) {
+    //don't connect if the controller is offline, nor if the connection of another view is used
+    if (m_guiWebSocket && m_controller->status() == MycroftController::Open) {
         m_guiWebSocket->close();
         m_guiWebSocket->open(url);
     }
 }
 
+AbstractSkillView::Framing AbstractSkillView::framing() const
+{
+    return m_framing;
+}
+
+void AbstractSkillView::setFraming(Framing framing)
+{
+#ifndef MYCROFT_GUI_HAVE_CBOR
+    if (framing == CborFraming) {
+        qWarning() << "CBOR framing not supported by this build, falling back to JSON";
+        framing = JsonFraming;
+    }
+#endif
+    m_framing = framing;
+    if (m_outboundQueue) {
+        m_outboundQueue->setBinaryFraming(framing == CborFraming);
+    }
+}
+
+QStringList AbstractSkillView::supportedFramings()
+{
+#ifdef MYCROFT_GUI_HAVE_CBOR
+    return {QStringLiteral("cbor"), QStringLiteral("json")};
+#else
+    return {QStringLiteral("json")};
+#endif
+}
+
 QString AbstractSkillView::id() const
 {
     return m_id;
@@ -142,56 +266,202 @@ QString AbstractSkillView::id() const
 
 void AbstractSkillView::triggerEvent(const QString &skillId, const QString &eventName, const QVariantMap &parameters)
 {
-    if (m_guiWebSocket->state() != QAbstractSocket::ConnectedState) {
+    if (!guiSocket() || guiSocket()->state() != QAbstractSocket::ConnectedState) {
         qWarning() << "Error: Mycroft gui connection not open!";
         return;
     }
-    QJsonObject root;
+    QVariantMap root;
 
     root[QStringLiteral("type")] = QStringLiteral("mycroft.events.triggered");
     root[QStringLiteral("namespace")] = skillId;
     root[QStringLiteral("event_name")] = eventName;
-    root[QStringLiteral("parameters")] = QJsonObject::fromVariantMap(parameters);
+    root[QStringLiteral("parameters")] = parameters;
+
+    sendGuiMessage(root);
+}
+
+void AbstractSkillView::subscribeDelegateEvents(AbstractDelegate *delegate, const QStringList &events)
+{
+    EventSubscribers &subscribers = m_eventSubscribers[delegate->skillId()];
+
+    if (events.isEmpty()) {
+        QVector<AbstractDelegate *> &delegates = subscribers[QString()];
+        if (!delegates.contains(delegate)) {
+            delegates << delegate;
+        }
+        return;
+    }
+
+    for (const auto &event : events) {
+        QVector<AbstractDelegate *> &delegates = subscribers[event];
+        if (!delegates.contains(delegate)) {
+            delegates << delegate;
+        }
+    }
+}
+
+void AbstractSkillView::unsubscribeDelegateEvents(AbstractDelegate *delegate, const QStringList &events)
+{
+    auto skillIt = m_eventSubscribers.find(delegate->skillId());
+    if (skillIt == m_eventSubscribers.end()) {
+        return;
+    }
+
+    EventSubscribers &subscribers = skillIt.value();
+    const QStringList eventNames = events.isEmpty() ? QStringList({QString()}) : events;
+
+    for (const auto &event : eventNames) {
+        auto it = subscribers.find(event);
+        if (it == subscribers.end()) {
+            continue;
+        }
+        it.value().removeAll(delegate);
+        if (it.value().isEmpty()) {
+            subscribers.erase(it);
+        }
+    }
 
-    QJsonDocument doc(root);
-    m_guiWebSocket->sendTextMessage(QString::fromUtf8(doc.toJson()));
+    if (subscribers.isEmpty()) {
+        m_eventSubscribers.erase(skillIt);
+    }
 }
 
 void AbstractSkillView::writeProperties(const QString &skillId, const QVariantMap &data)
 {
-    if (m_guiWebSocket->state() != QAbstractSocket::ConnectedState) {
+    if (!guiSocket() || guiSocket()->state() != QAbstractSocket::ConnectedState) {
         qWarning() << "Error: Mycroft gui connection not open!";
         return;
     }
-    QJsonObject root;
+    QVariantMap root;
 
     root[QStringLiteral("type")] = QStringLiteral("mycroft.session.set");
     root[QStringLiteral("namespace")] = skillId;
-    root[QStringLiteral("data")] = QJsonObject::fromVariantMap(data);
+    root[QStringLiteral("data")] = data;
 
-    QJsonDocument doc(root);
-    m_guiWebSocket->sendTextMessage(QString::fromUtf8(doc.toJson()));
+    sendGuiMessage(root);
 }
 
 void AbstractSkillView::deleteProperty(const QString &skillId, const QString &property)
 {
-    if (m_guiWebSocket->state() != QAbstractSocket::ConnectedState) {
+    if (!guiSocket() || guiSocket()->state() != QAbstractSocket::ConnectedState) {
         qWarning() << "Error: Mycroft gui connection not open!";
         return;
     }
-    QJsonObject root;
+    QVariantMap root;
 
     root[QStringLiteral("type")] = QStringLiteral("mycroft.session.delete");
     root[QStringLiteral("namespace")] = skillId;
     root[QStringLiteral("property")] = property;
 
-    QJsonDocument doc(root);
-    m_guiWebSocket->sendTextMessage(QString::fromUtf8(doc.toJson()));
+    sendGuiMessage(root);
+}
+
+bool AbstractSkillView::fetchListItems(const QString &skillId, const QString &property, int position, int count)
+{
+    if (!guiSocket() || guiSocket()->state() != QAbstractSocket::ConnectedState) {
+        qWarning() << "Error: Mycroft gui connection not open!";
+        return false;
+    }
+    QVariantMap root;
+
+    root[QStringLiteral("type")] = QStringLiteral("mycroft.session.list.fetch");
+    root[QStringLiteral("namespace")] = skillId;
+    root[QStringLiteral("property")] = property;
+    root[QStringLiteral("position")] = position;
+    root[QStringLiteral("items_number")] = count;
+
+    sendGuiMessage(root);
+    return true;
+}
+
+void AbstractSkillView::sendGuiMessage(const QVariantMap &message)
+{
+    if (m_guiChannel) {
+        m_guiChannel->sendGuiMessage(message);
+        return;
+    }
+
+    if (!m_outboundQueue) {
+        qWarning() << "Error: no Mycroft gui connection to send" << message.value(QStringLiteral("type"));
+        return;
+    }
+    m_outboundQueue->enqueue(message);
+}
+
+SocketConnection *AbstractSkillView::guiSocket() const
+{
+    return m_guiChannel ? m_guiChannel->m_guiWebSocket : m_guiWebSocket;
+}
+
+MessageQueue *AbstractSkillView::outboundQueue() const
+{
+    return m_outboundQueue;
+}
+
+ComponentCache *AbstractSkillView::componentCache() const
+{
+    return m_componentCache;
+}
+
+DelegatePool *AbstractSkillView::delegatePool() const
+{
+    return m_delegatePool;
+}
+
+SessionStore *AbstractSkillView::sessionStore() const
+{
+    return m_sessionStore;
+}
+
+void AbstractSkillView::setSessionStore(SessionStore *store)
+{
+    Q_ASSERT(m_skillStates.isEmpty());
+    m_sessionStore = store;
+}
+
+AbstractSkillView *AbstractSkillView::guiChannel() const
+{
+    return m_guiChannel;
+}
+
+void AbstractSkillView::addFollower(AbstractSkillView *follower)
+{
+    Q_ASSERT(follower != this && !follower->m_guiChannel);
+
+    follower->m_guiChannel = this;
+    m_followers << follower;
+    connect(this, &AbstractSkillView::statusChanged, follower, &AbstractSkillView::statusChanged);
+    emit follower->statusChanged();
+}
+
+void AbstractSkillView::removeFollower(AbstractSkillView *follower)
+{
+    if (!m_followers.removeOne(follower)) {
+        return;
+    }
+
+    disconnect(this, &AbstractSkillView::statusChanged, follower, &AbstractSkillView::statusChanged);
+    follower->m_guiChannel = nullptr;
+    follower->resetState();
+    emit follower->statusChanged();
+}
+
+QList<AbstractSkillView *> AbstractSkillView::followers() const
+{
+    return m_followers;
 }
 
 MycroftController::Status AbstractSkillView::status() const
 {
-    if (m_reconnectTimer.isActive()) {
+    if (m_guiChannel) {
+        return m_guiChannel->status();
+    }
+
+    if (!m_guiWebSocket) {
+        return MycroftController::Closed;
+    }
+
+    if (m_connectionMonitor->isReconnecting()) {
         return MycroftController::Connecting;
     }
 
@@ -217,18 +487,276 @@ ActiveSkillsModel *AbstractSkillView::activeSkills() const
     return m_activeSkillsModel;
 }
 
+int AbstractSkillView::maximumLiveSkills() const
+{
+    return m_maximumLiveSkills;
+}
+
+void AbstractSkillView::setMaximumLiveSkills(int maximum)
+{
+    maximum = qMax(-1, maximum);
+
+    if (m_maximumLiveSkills == maximum) {
+        return;
+    }
+
+    m_maximumLiveSkills = maximum;
+    enforceLiveSkills();
+    emit maximumLiveSkillsChanged();
+}
+
+QString AbstractSkillView::snapshotName() const
+{
+    return m_snapshotName;
+}
+
+void AbstractSkillView::setSnapshotName(const QString &name)
+{
+    if (m_snapshotName == name) {
+        return;
+    }
+
+    // What was saved under the old name would be shown again one day, out of date
+    if (m_snapshot) {
+        m_snapshotTimer.stop();
+        m_snapshotDirty.clear();
+        m_snapshot->clear();
+        delete m_snapshot;
+        m_snapshot = nullptr;
+    }
+
+    m_snapshotName = name;
+
+    if (!name.isEmpty()) {
+        m_snapshot = new SessionSnapshot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                                         + QStringLiteral("/snapshots/") + name + QStringLiteral(".snapshot"));
+        // The white and black lists of the skills must be there already
+        if (isComponentComplete()) {
+            restoreSnapshot();
+        }
+    }
+
+    emit snapshotNameChanged();
+}
+
+void AbstractSkillView::componentComplete()
+{
+    QQuickItem::componentComplete();
+
+    if (m_snapshot) {
+        restoreSnapshot();
+    }
+}
+
+void AbstractSkillView::restoreSnapshot()
+{
+    // Only a view still empty can show the old state, otherwise it's just saved from now on
+    if (m_stateVersion != 0 || m_activeSkillsModel->rowCount() > 0 || !m_snapshot->load()) {
+        for (const auto &skillId : m_activeSkillsModel->activeSkills()) {
+            scheduleSnapshot(skillId);
+        }
+        return;
+    }
+
+    const QVector<SessionSnapshot::Skill> skills = m_snapshot->skills();
+    if (skills.isEmpty()) {
+        return;
+    }
+
+    QStringList skillIds;
+    for (const auto &skill : skills) {
+        SkillState &state = m_skillStates[skill.skillId];
+        state.hibernated = true;
+        state.hibernatedUrls = skill.delegateUrls;
+        state.hibernatedCurrentIndex = skill.currentIndex;
+        state.hibernatedData = skill.sessionData;
+        skillIds << skill.skillId;
+    }
+
+    // enforceLiveSkills wakes them up, delegates and data together
+    m_activeSkillsModel->insertSkills(0, skillIds);
+
+    // Skills the lists don't allow anymore
+    for (auto it = m_skillStates.begin(); it != m_skillStates.end();) {
+        if (m_activeSkillsModel->skillIndex(it.key()).isValid()) {
+            ++it;
+        } else {
+            skillIds.removeAll(it.key());
+            it = m_skillStates.erase(it);
+        }
+    }
+
+    // The shared data doesn't come from hibernatedData: fill the store if nobody did yet
+    if (m_sessionStore) {
+        for (const auto &skillId : skillIds) {
+            SkillState &state = m_skillStates[skillId];
+            SessionDataMap *map = sessionDataForSkill(skillId);
+            if (map && map->isEmpty() && !state.hibernatedData.isEmpty()) {
+                map->restore(state.hibernatedData);
+            }
+            state.hibernatedData.clear();
+        }
+    }
+
+    // As if the connection just dropped: the server checks the state with mycroft.gui.resume
+    m_stateVersion = m_snapshot->stateVersion();
+    m_resumeGraceTimer.start();
+}
+
+void AbstractSkillView::scheduleSnapshot(const QString &skillId)
+{
+    if (!m_snapshot) {
+        return;
+    }
+
+    if (!skillId.isEmpty()) {
+        m_snapshotDirty.insert(skillId);
+    }
+    // Not restarted by further changes: a skill updating all the time is still saved regularly
+    if (!m_snapshotTimer.isActive()) {
+        m_snapshotTimer.start();
+    }
+}
+
+void AbstractSkillView::writeSnapshot()
+{
+    m_snapshotTimer.stop();
+
+    if (!m_snapshot) {
+        return;
+    }
+
+    const QStringList skills = m_activeSkillsModel->activeSkills();
+
+    for (const auto &skillId : skills) {
+        if (!m_snapshotDirty.contains(skillId)) {
+            continue;
+        }
+
+        SessionSnapshot::Skill skill;
+        skill.skillId = skillId;
+
+        auto it = m_skillStates.constFind(skillId);
+        if (it != m_skillStates.constEnd() && it->hibernated) {
+            skill.delegateUrls = it->hibernatedUrls;
+            skill.currentIndex = it->hibernatedCurrentIndex;
+            // Shared data stays live while hibernated
+            skill.sessionData = it->sessionData ? it->sessionData->serialize() : it->hibernatedData;
+        } else {
+            DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModels().value(skillId);
+            if (delegatesModel) {
+                skill.delegateUrls = skillDelegateUrls(skillId, delegatesModel);
+                skill.currentIndex = delegatesModel->currentIndex();
+            }
+            if (it != m_skillStates.constEnd() && it->sessionData) {
+                skill.sessionData = it->sessionData->serialize();
+            }
+        }
+
+        m_snapshot->setSkill(skill);
+    }
+
+    m_snapshotDirty.clear();
+    m_snapshot->save(skills, m_stateVersion);
+}
+
+void AbstractSkillView::enforceLiveSkills()
+{
+    const QStringList skills = m_activeSkillsModel->activeSkills();
+
+    for (int i = 0; i < skills.count(); ++i) {
+        if (m_maximumLiveSkills < 0 || i < m_maximumLiveSkills) {
+            wakeSkill(skills[i]);
+        } else {
+            hibernateSkill(skills[i]);
+        }
+    }
+}
+
+void AbstractSkillView::hibernateSkill(const QString &skillId)
+{
+    auto it = m_skillStates.find(skillId);
+    if (it == m_skillStates.end() || it->hibernated) {
+        return;
+    }
+
+    it->hibernated = true;
+
+    DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModels().value(skillId);
+    if (delegatesModel) {
+        it->hibernatedUrls = skillDelegateUrls(skillId, delegatesModel);
+        it->hibernatedCurrentIndex = delegatesModel->currentIndex();
+        delegatesModel->clear();
+    }
+    it->pendingLoaders.clear();
+    it->pendingUrls.clear();
+
+    // Other views may be showing the skill: shared data stays as is
+    if (it->sessionData && !m_sessionStore) {
+        it->hibernatedData = it->sessionData->serialize();
+        // The removed delegates can still be around for their animation, they need the data until then
+        QTimer::singleShot(3000, it->sessionData, &QObject::deleteLater);
+        it->sessionData = nullptr;
+    }
+}
+
+void AbstractSkillView::wakeSkill(const QString &skillId)
+{
+    auto it = m_skillStates.find(skillId);
+    if (it == m_skillStates.end() || !it->hibernated) {
+        return;
+    }
+
+    it->hibernated = false;
+    const QList<QUrl> urls = it->hibernatedUrls;
+    const int currentIndex = it->hibernatedCurrentIndex;
+    it->hibernatedUrls.clear();
+
+    // The delegates bind to the data when created, so it must be back first
+    sessionDataForSkill(skillId);
+
+    DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
+    if (!delegatesModel || urls.isEmpty()) {
+        return;
+    }
+
+    QList<DelegateLoader *> delegateLoaders;
+    for (const auto &url : urls) {
+        delegateLoaders << createDelegateLoader(skillId, url);
+    }
+    delegatesModel->insertDelegateLoaders(0, delegateLoaders);
+    delegatesModel->setProperty("currentIndex", qBound(0, currentIndex, delegateLoaders.count() - 1));
+}
+
 SessionDataMap *AbstractSkillView::sessionDataForSkill(const QString &skillId)
 {
-    SessionDataMap *map = nullptr;
+    auto it = m_skillStates.find(skillId);
+
+    if (it != m_skillStates.end() && it->sessionData) {
+        return it->sessionData;
+    } else if (!m_activeSkillsModel->skillIndex(skillId).isValid()) {
+        return nullptr;
+    }
+
+    if (it == m_skillStates.end()) {
+        it = m_skillStates.insert(skillId, SkillState());
+    }
+
+    if (m_sessionStore) {
+        // Written back through whichever view owns the connection
+        it->sessionData = m_sessionStore->acquire(skillId, m_guiChannel ? m_guiChannel.data() : this);
+        return it->sessionData;
+    }
+
+    it->sessionData = new SessionDataMap(skillId, this);
 
-    if (m_skillData.contains(skillId)) {
-        map = m_skillData[skillId];
-    } else if (m_activeSkillsModel->skillIndex(skillId).isValid()) {
-        map = new SessionDataMap(skillId, this);
-        m_skillData[skillId] = map;
+    // The server is updating a sleeping skill: the data alone is cheap to have back
+    if (!it->hibernatedData.isEmpty()) {
+        it->sessionData->restore(it->hibernatedData);
+        it->hibernatedData.clear();
     }
 
-    return map;
+    return it->sessionData;
 }
 
 QList<QVariantMap> variantListToOrderedMap(const QVariantList &data)
@@ -254,30 +782,30 @@ QList<QVariantMap> variantListToOrderedMap(const QVariantList &data)
     return ordMap;
 }
 
-QStringList jsonModelToStringList(const QString &key, const QJsonValue &data)
+QStringList variantModelToStringList(const QString &key, const QVariant &data)
 {
     QStringList items;
 
-    if (!data.isArray()) {
+    if (data.type() != QVariant::List) {
         qWarning() << "Error: Model data is not an Array" << data;
         return items;
     }
 
-    const auto &array = data.toArray();
-    for (const auto &item : array) {
-        if (!item.isObject()) {
+    const auto &list = data.toList();
+    for (const auto &item : list) {
+        if (item.type() != QVariant::Map) {
             qWarning() << "Error: Array data structure currupted: " << data;
             items.clear();
             return items;
         }
-        const auto &obj = item.toObject();
-        if (obj.keys().length() != 1 || !obj.contains(key)) {
-            qWarning() << "Error: Item with a wrong key encountered, expected: " << key << "Encountered: " << obj.keys();
+        const auto &map = item.toMap();
+        if (map.count() != 1 || !map.contains(key)) {
+            qWarning() << "Error: Item with a wrong key encountered, expected: " << key << "Encountered: " << map.keys();
             items.clear();
             return items;
         }
-        const auto &value = obj.value(key);
-        if (!value.isString()) {
+        const auto &value = map.value(key);
+        if (value.type() != QVariant::String) {
             qWarning() << "Error: item in model not a string" << value;
         }
         items << value.toString();
@@ -286,489 +814,937 @@ QStringList jsonModelToStringList(const QString &key, const QJsonValue &data)
     return items;
 }
 
-void AbstractSkillView::onGuiSocketMessageReceived(const QString &message)
+void AbstractSkillView::registerGuiMessageHandler(GuiMessage::Type type, GuiMessageHandler handler)
 {
-    QJsonParseError parseError;
-    auto doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+    Q_ASSERT(type > GuiMessage::Unknown && type < GuiMessage::TypeCount);
+    m_guiMessageHandlers[type] = handler;
+}
 
-    if (doc.isEmpty()) {
-        qWarning() << "Empty or invalid JSON message arrived on the gui socket:" << message << "Error:" << parseError.errorString();
-        return;
+void AbstractSkillView::dispatchGuiMessage(const GuiMessage &message)
+{
+    // Followers included, as they update on the same message
+    Metrics::HandlerTimer timer(Metrics::GuiChannel, message.typeName);
+    const GuiMessageHandler handler = m_guiMessageHandlers.value(message.type);
+
+    // A server which doesn't know about resuming just sends everything again
+    if (m_resuming && message.type != GuiMessage::Resume) {
+        qWarning() << "Server didn't answer to mycroft.gui.resume, resetting the gui state";
+        m_resuming = false;
+        m_resumeReplyTimer.stop();
+        resetState();
     }
 
-    auto type = doc[QStringLiteral("type")].toString();
+    // The server counts what it sent: messages this client doesn't understand count as well
+    if (message.type != GuiMessage::Resume) {
+        ++m_stateVersion;
+    }
 
-    if (type.isEmpty()) {
-        qWarning() << "Empty type in the JSON message on the gui socket";
+    if (!handler) {
+        qWarning() << "Unrecognized operation" << message.typeName;
         return;
     }
 
-    //qDebug() << "gui message type" << type;
+    (this->*handler)(message);
 
-//BEGIN SKILLDATA
-    // The SkillData was updated by the server
-    if (type == QLatin1String("mycroft.session.set")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        const QVariantMap data = doc[QStringLiteral("data")].toVariant().toMap();
+    // From arriving on the socket thread to handled, waiting in the event queue included
+    if (message.receivedAt > 0) {
+        Metrics::instance()->recordTiming(QStringLiteral("gui.latency"), Metrics::now() - message.receivedAt);
+    }
 
-        if (skillId.isEmpty()) {
-            qWarning() << "Empty skill_id in mycroft.session.set";
-            return;
-        }
-        if (!m_activeSkillsModel->skillIndex(skillId).isValid()) {
-            qWarning() << "Invalid skill_id in mycroft.session.set:" << skillId;
-            return;
-        }
-        if (data.isEmpty()) {
-            qWarning() << "Empty data in mycroft.session.set";
-            return;
+    if (message.type != GuiMessage::Resume) {
+        scheduleSnapshot(message.skillId);
+        for (auto *follower : m_followers) {
+            follower->followGuiMessage(message);
         }
+    }
+}
 
-        //we already checked, assume *map is valid
-        SessionDataMap *map = sessionDataForSkill(skillId);
-        if (!map) {
-            return;
+bool AbstractSkillView::showsSkill(const QString &skillId) const
+{
+    if (m_activeSkillsModel->skillIndex(skillId).isValid()) {
+        return true;
+    }
+    for (auto *follower : m_followers) {
+        if (follower->m_activeSkillsModel->skillIndex(skillId).isValid()) {
+            return true;
         }
-        QVariantMap::const_iterator i;
-        for (i = data.constBegin(); i != data.constEnd(); ++i) {
-            //insert it as a model
-            QList<QVariantMap> list = variantListToOrderedMap(i.value().value<QVariantList>());
-            SessionDataModel *dm = map->value(i.key()).value<SessionDataModel *>();
-
-            if (!list.isEmpty()) {
-                if (!dm) {
-                    dm = new SessionDataModel(map);
-                    map->insertAndNotify(i.key(), QVariant::fromValue(dm));
-                } else {
-                    dm->clear();
-                }
-                dm->insertData(0, list);
+    }
+    return false;
+}
 
-            //insert it as is.
-            } else {
-                if (dm) {
-                    dm->deleteLater();
-                }
-                map->insertAndNotify(i.key(), i.value());
-            }
-            //qDebug() << "             " << i.key() << " = " << i.value();
+SessionDataMap *AbstractSkillView::sessionDataToUpdate(const QString &skillId)
+{
+    if (m_activeSkillsModel->skillIndex(skillId).isValid()) {
+        return sessionDataForSkill(skillId);
+    }
+    // The followers have their own lists: the map in the shared store is the same for all of them
+    for (auto *follower : m_followers) {
+        if (follower->m_activeSkillsModel->skillIndex(skillId).isValid()) {
+            return follower->sessionDataForSkill(skillId);
         }
+    }
+    return nullptr;
+}
 
-    // The SkillData was removed by the server
-    } else if (type == QLatin1String("mycroft.session.delete")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        const QString property = doc[QStringLiteral("property")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.session.delete";
-            return;
-        }
-        if (!m_activeSkillsModel->skillIndex(skillId).isValid()) {
-            qWarning() << "Invalid skill_id in mycroft.session.delete:" << skillId;
-            return;
+void AbstractSkillView::followGuiMessage(const GuiMessage &message)
+{
+    switch (message.type) {
+    // The data is in the shared store, already updated by the channel
+    case GuiMessage::SessionSet:
+    case GuiMessage::SessionDelete:
+    case GuiMessage::SessionPatch:
+    case GuiMessage::SessionListInsert:
+    case GuiMessage::SessionListUpdate:
+    case GuiMessage::SessionListMove:
+    case GuiMessage::SessionListRemove:
+    case GuiMessage::SessionListPaged:
+        scheduleSnapshot(message.skillId);
+        return;
+    default:
+        break;
+    }
+
+    const GuiMessageHandler handler = m_guiMessageHandlers.value(message.type);
+    if (handler) {
+        (this->*handler)(message);
+        scheduleSnapshot(message.skillId);
+    }
+}
+
+QString AbstractSkillView::stateDigest() const
+{
+    // One line per active skill, as described in transportProtocol.md
+    QByteArray text;
+
+    for (const auto &skillId : m_activeSkillsModel->activeSkills()) {
+        auto it = m_skillStates.constFind(skillId);
+        QList<QUrl> urls;
+        QStringList keys;
+
+        if (it != m_skillStates.constEnd() && it->hibernated) {
+            urls = it->hibernatedUrls;
+        } else if (DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModels().value(skillId)) {
+            urls = skillDelegateUrls(skillId, delegatesModel);
         }
-        if (property.isEmpty()) {
-            qWarning() << "No property provided in mycroft.session.delete";
-            return;
+
+        if (it != m_skillStates.constEnd()) {
+            keys = it->sessionData ? it->sessionData->keys() : SessionDataMap::serializedKeys(it->hibernatedData);
         }
+        keys.sort();
 
-        SessionDataMap *map = sessionDataForSkill(skillId);
-        SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
-        map->clearAndNotify(property);
-        //a model will need to be manually deleted
-        if (dm) {
-            dm->deleteLater();
+        QStringList pages;
+        for (const auto &url : urls) {
+            pages << url.toString();
         }
-//END SKILLDATA
 
+        text += skillId.toUtf8() + '\t' + pages.join(QLatin1Char(' ')).toUtf8() + '\t' + keys.join(QLatin1Char(' ')).toUtf8() + '\n';
+    }
 
-//BEGIN ACTIVESKILLS
-    // Insert new active skill
-    } else if (type == QLatin1String("mycroft.session.list.insert") && doc[QStringLiteral("namespace")].toString() == QLatin1String("mycroft.system.active_skills")) {
-        const int position = doc[QStringLiteral("position")].toInt();
+    return QString::fromLatin1(QCryptographicHash::hash(text, QCryptographicHash::Sha1).toHex());
+}
 
-        if (position < 0 || position > m_activeSkillsModel->rowCount()) {
-            qWarning() << "Error: Invalid position in mycroft.session.list.insert of mycroft.system.active_skills";
-            return;
-        }
+void AbstractSkillView::requestResume()
+{
+    const bool hadState = m_resumeGraceTimer.isActive();
+    m_resumeGraceTimer.stop();
 
-        const QStringList skillList = jsonModelToStringList(QStringLiteral("skill_id"), doc[QStringLiteral("data")]);
+    if (!hadState || (m_stateVersion == 0 && m_activeSkillsModel->rowCount() == 0)) {
+        return;
+    }
 
-        if (skillList.isEmpty()) {
-            qWarning() << "Error: no valid skills received in mycroft.session.list.insert of mycroft.system.active_skills";
-            return;
+    QVariantMap root;
+    QVariantMap data;
+
+    data[QStringLiteral("version")] = m_stateVersion;
+    data[QStringLiteral("digest")] = stateDigest();
+    root[QStringLiteral("type")] = QStringLiteral("mycroft.gui.resume");
+    root[QStringLiteral("data")] = data;
+
+    m_resuming = true;
+    m_resumeReplyTimer.start();
+    sendGuiMessage(root);
+    // Goes out before anything the delegates could write meanwhile
+    m_outboundQueue->flush();
+}
+
+void AbstractSkillView::expectResumeReply()
+{
+    m_resuming = true;
+}
+
+void AbstractSkillView::cancelListFetches()
+{
+    for (auto it = m_skillStates.constBegin(); it != m_skillStates.constEnd(); ++it) {
+        if (it->sessionData) {
+            it->sessionData->cancelFetches();
         }
+    }
 
-        m_activeSkillsModel->insertSkills(position, skillList);
+    for (auto *follower : m_followers) {
+        follower->cancelListFetches();
+    }
+}
+
+void AbstractSkillView::resetState()
+{
+    m_resumeGraceTimer.stop();
+    // Shared session data outlives the state of this view
+    cancelListFetches();
+    m_stateVersion = 0;
+    m_activeSkillsModel->removeRows(0, m_activeSkillsModel->rowCount());
+
+    for (auto it = m_skillStates.begin(); it != m_skillStates.end(); ++it) {
+        releaseSessionData(it.key(), it.value());
+    }
+    m_skillStates.clear();
 
+    m_snapshotDirty.clear();
+    scheduleSnapshot(QString());
 
-    // Active skill removed
-    } else if (type == QLatin1String("mycroft.session.list.remove") && doc[QStringLiteral("namespace")].toString() == QLatin1String("mycroft.system.active_skills")) {
-        const int position = doc[QStringLiteral("position")].toInt();
-        const int itemsNumber = doc[QStringLiteral("items_number")].toInt();
+    for (auto *follower : m_followers) {
+        follower->resetState();
+    }
+}
 
-        if (position < 0 || position > m_activeSkillsModel->rowCount() - 1) {
-            qWarning() << "Error: Invalid position in mycroft.session.list.remove of mycroft.system.active_skills";
-            return;
+void AbstractSkillView::releaseSessionData(const QString &skillId, SkillState &state)
+{
+    if (!state.sessionData) {
+        return;
+    }
+
+    if (m_sessionStore) {
+        m_sessionStore->release(skillId);
+    } else {
+        state.sessionData->deleteLater();
+    }
+    state.sessionData = nullptr;
+}
+
+// Answer of the server to our mycroft.gui.resume
+void AbstractSkillView::handleResume(const GuiMessage &message)
+{
+    if (!m_resuming) {
+        qWarning() << "Unexpected mycroft.gui.resume";
+        return;
+    }
+
+    m_resuming = false;
+    m_resumeReplyTimer.stop();
+
+    if (message.data.toMap().value(QStringLiteral("accepted")).toBool()) {
+        // What changed meanwhile will arrive as normal messages
+        return;
+    }
+
+    resetState();
+}
+
+//BEGIN SKILLDATA
+// The SkillData was updated by the server
+void AbstractSkillView::handleSessionSet(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    const QVariantMap data = message.data.toMap();
+
+    if (skillId.isEmpty()) {
+        qWarning() << "Empty skill_id in mycroft.session.set";
+        return;
+    }
+    if (!showsSkill(skillId)) {
+        qWarning() << "Invalid skill_id in mycroft.session.set:" << skillId;
+        return;
+    }
+    if (data.isEmpty()) {
+        qWarning() << "Empty data in mycroft.session.set";
+        return;
+    }
+
+    //we already checked, assume *map is valid
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        return;
+    }
+    QVariantMap::const_iterator i;
+    for (i = data.constBegin(); i != data.constEnd(); ++i) {
+        setSessionValue(map, i.key(), i.value(), message.listIdentity.value(i.key()).toString());
+        //qDebug() << "             " << i.key() << " = " << i.value();
+    }
+}
+
+void AbstractSkillView::setSessionValue(SessionDataMap *map, const QString &key, const QVariant &value, const QString &identityKey)
+{
+    //insert it as a model
+    QList<QVariantMap> list = variantListToOrderedMap(value.value<QVariantList>());
+    SessionDataModel *dm = map->value(key).value<SessionDataModel *>();
+
+    if (!list.isEmpty()) {
+        if (!dm) {
+            dm = new SessionDataModel(map);
+            map->insertAndNotify(key, QVariant::fromValue(dm));
+            dm->insertData(0, list);
+        } else {
+            //only notify what changed, so views keep the delegates of unchanged rows
+            dm->replaceData(list, identityKey);
         }
-        if (itemsNumber < 0 || itemsNumber > m_activeSkillsModel->rowCount() - position) {
-            qWarning() << "Error: Invalid items_number in mycroft.session.list.remove of mycroft.system.active_skills";
-            return;
+
+    //insert it as is.
+    } else {
+        if (dm) {
+            dm->deleteLater();
         }
+        map->insertAndNotify(key, value);
+    }
+}
 
-        for (int i = 0; i < itemsNumber; ++i) {
+// The SkillData was removed by the server
+void AbstractSkillView::handleSessionDelete(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    const QString &property = message.property;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.delete";
+        return;
+    }
+    if (!showsSkill(skillId)) {
+        qWarning() << "Invalid skill_id in mycroft.session.delete:" << skillId;
+        return;
+    }
+    if (property.isEmpty()) {
+        qWarning() << "No property provided in mycroft.session.delete";
+        return;
+    }
 
-            const QString skillId = m_activeSkillsModel->data(m_activeSkillsModel->index(position+i, 0)).toString();
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
+    map->clearAndNotify(property);
+    //a model will need to be manually deleted
+    if (dm) {
+        dm->deleteLater();
+    }
+}
 
-            if (!m_translatorsForSkill.contains(skillId)) {
-                QTranslator *translator = m_translatorsForSkill[skillId];
-                QCoreApplication::removeTranslator(translator);
-                m_translatorsForSkill.remove(skillId);
-                delete translator;
-            }
-            //TODO: do this after an animation
-            {
-                auto i = m_skillData.find(skillId);
-                if (i != m_skillData.end()) {
-                    i.value()->deleteLater();
-                    m_skillData.erase(i);
+// Changes values nested in the SkillData, without resending them whole
+void AbstractSkillView::handleSessionPatch(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.patch";
+        return;
+    }
+    if (!showsSkill(skillId)) {
+        qWarning() << "Invalid skill_id in mycroft.session.patch:" << skillId;
+        return;
+    }
+
+    const QList<SessionDataPatch> patches = SessionDataPatch::fromVariant(message.data);
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        return;
+    }
+
+    for (const auto &patch : patches) {
+        const QString &key = patch.path.first();
+        SessionDataModel *dm = map->value(key).value<SessionDataModel *>();
+
+        // The whole value
+        if (patch.path.count() == 1) {
+            if (patch.operation == SessionDataPatch::Remove) {
+                map->clearAndNotify(key);
+                if (dm) {
+                    dm->deleteLater();
                 }
+            } else if (patch.operation == SessionDataPatch::Replace && !map->contains(key)) {
+                qWarning() << "Invalid path in mycroft.session.patch, nothing to replace:" << patch.path;
+            } else {
+                setSessionValue(map, key, patch.value, message.listIdentity.value(key).toString());
             }
+            continue;
         }
-        m_activeSkillsModel->removeRows(position, itemsNumber);
-
-    // Active skill moved
-    } else if (type == QLatin1String("mycroft.session.list.move") && doc[QStringLiteral("namespace")].toString() == QLatin1String("mycroft.system.active_skills")) {
-        const int from = doc[QStringLiteral("from")].toInt();
-        const int to = doc[QStringLiteral("to")].toInt();
-        const int itemsNumber = doc[QStringLiteral("items_number")].toInt();
 
-        if (from < 0 || from > m_activeSkillsModel->rowCount() - 1) {
-            qWarning() << "Error: Invalid from position in mycroft.session.list.move of mycroft.system.active_skills";
-            return;
-        }
-        if (to < 0 || to > m_activeSkillsModel->rowCount() - 1) {
-            qWarning() << "Error: Invalid to position in mycroft.session.list.move of mycroft.system.active_skills";
-            return;
+        if (dm) {
+            if (!dm->applyPatch(patch, 1)) {
+                qWarning() << "Invalid path in mycroft.session.patch:" << patch.path;
+            }
+            continue;
         }
-        if (itemsNumber <= 0 || itemsNumber > m_activeSkillsModel->rowCount() - from) {
-            qWarning() << "Error: Invalid items_number in mycroft.session.list.move of mycroft.system.active_skills";
-            return;
+
+        QVariant value = map->value(key);
+        if (!patch.applyTo(value, 1)) {
+            qWarning() << "Invalid path in mycroft.session.patch:" << patch.path;
+            continue;
         }
+        map->insertAndNotify(key, value);
+    }
+}
+//END SKILLDATA
 
-        m_activeSkillsModel->moveRows(QModelIndex(), from, itemsNumber, QModelIndex(), to);
-//END ACTIVESKILLS
 
+//BEGIN ACTIVESKILLS
+// Insert new active skill
+void AbstractSkillView::handleActiveSkillsInsert(const GuiMessage &message)
+{
+    const int position = message.position;
 
-//BEGIN GUI MODEL
-    // Insert new new gui delegates
-    } else if (type == QLatin1String("mycroft.gui.list.insert")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.gui.list.insert";
-            return;
-        }
+    if (position < 0 || position > m_activeSkillsModel->rowCount()) {
+        qWarning() << "Error: Invalid position in mycroft.session.list.insert of mycroft.system.active_skills";
+        return;
+    }
 
-        const int position = doc[QStringLiteral("position")].toInt();
+    const QStringList skillList = variantModelToStringList(QStringLiteral("skill_id"), message.data);
 
-        DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
+    if (skillList.isEmpty()) {
+        qWarning() << "Error: no valid skills received in mycroft.session.list.insert of mycroft.system.active_skills";
+        return;
+    }
 
-        if (!delegatesModel) {
-            qWarning() << "Error: no delegates model for skill" << skillId;
-            return;
-        }
-        if (position < 0 || position > delegatesModel->rowCount()) {
-            qWarning() << "Error: Invalid position in mycroft.gui.list.insert";
-            return;
-        }
+    m_activeSkillsModel->insertSkills(position, skillList);
+}
 
-        const QStringList delegateUrls = jsonModelToStringList(QStringLiteral("url"), doc[QStringLiteral("data")]);
+// Active skill removed
+void AbstractSkillView::handleActiveSkillsRemove(const GuiMessage &message)
+{
+    const int position = message.position;
+    const int itemsNumber = message.itemsNumber;
 
-        if (delegateUrls.isEmpty()) {
-            qWarning() << "Error: no valid skills received in mycroft.gui.list.insert";
-            return;
+    if (position < 0 || position > m_activeSkillsModel->rowCount() - 1) {
+        qWarning() << "Error: Invalid position in mycroft.session.list.remove of mycroft.system.active_skills";
+        return;
+    }
+    if (itemsNumber < 0 || itemsNumber > m_activeSkillsModel->rowCount() - position) {
+        qWarning() << "Error: Invalid items_number in mycroft.session.list.remove of mycroft.system.active_skills";
+        return;
+    }
+
+    for (int i = 0; i < itemsNumber; ++i) {
+
+        const QString skillId = m_activeSkillsModel->data(m_activeSkillsModel->index(position+i, 0)).toString();
+
+        auto it = m_skillStates.find(skillId);
+        if (it == m_skillStates.end()) {
+            continue;
         }
 
-        qWarning() << "Arrived mycroft.gui.list.insert, delegateUrls are" << delegateUrls;
+        // The translations stay loaded in m_translator, for when the skill comes back
+        //TODO: do this after an animation
+        releaseSessionData(skillId, it.value());
+        m_skillStates.erase(it);
+    }
+    m_activeSkillsModel->removeRows(position, itemsNumber);
+}
 
-        QList <DelegateLoader *> delegateLoaders;
-        for (const auto &urlString : delegateUrls) {
-            const QUrl delegateUrl = QUrl::fromUserInput(urlString);
+// Active skill moved
+void AbstractSkillView::handleActiveSkillsMove(const GuiMessage &message)
+{
+    const int from = message.from;
+    const int to = message.to;
+    const int itemsNumber = message.itemsNumber;
 
-            if (!delegateUrl.isValid()) {
-                continue;
-            }
+    if (from < 0 || from > m_activeSkillsModel->rowCount() - 1) {
+        qWarning() << "Error: Invalid from position in mycroft.session.list.move of mycroft.system.active_skills";
+        return;
+    }
+    if (to < 0 || to > m_activeSkillsModel->rowCount() - 1) {
+        qWarning() << "Error: Invalid to position in mycroft.session.list.move of mycroft.system.active_skills";
+        return;
+    }
+    if (itemsNumber <= 0 || itemsNumber > m_activeSkillsModel->rowCount() - from) {
+        qWarning() << "Error: Invalid items_number in mycroft.session.list.move of mycroft.system.active_skills";
+        return;
+    }
 
-            DelegateLoader *loader = new DelegateLoader(this);
-            loader->init(skillId, delegateUrl);
+    m_activeSkillsModel->moveRows(QModelIndex(), from, itemsNumber, QModelIndex(), to);
+}
+//END ACTIVESKILLS
 
-            qWarning() << "Created a new DelegateLoader" << loader << "which will load" << delegateUrl << "for the skill" << skillId;
 
-            if (!m_translatorsForSkill.contains(skillId)) {
-                QTranslator *translator = new QTranslator(this);
-                // TODO: download translations if skills are remote
-                if (translator->load(QLocale(), skillId, QLatin1String("_"), loader->translationsUrl().path())) {
-                    QCoreApplication::installTranslator(translator);
-                    m_translatorsForSkill[skillId] = translator;
-                } else {
-                    translator->deleteLater();
-                }
-            }
+//BEGIN GUI MODEL
+// Insert new new gui delegates
+void AbstractSkillView::handleGuiListInsert(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.gui.list.insert";
+        return;
+    }
 
-            connect(loader, &QObject::destroyed, &m_trimComponentsTimer, QOverload<>::of(&QTimer::start));
+    const int position = message.position;
 
-            delegateLoaders << loader;
-        }
+    // The positions are the ones of the pages the skill had before sleeping
+    wakeSkill(skillId);
+    DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
 
-        if (delegateLoaders.count() > 0) {
-            delegatesModel->insertDelegateLoaders(position, delegateLoaders);
-            //give the focus to the first
-            delegateLoaders.first()->setFocus(true);
-        }
+    if (!delegatesModel) {
+        qWarning() << "Error: no delegates model for skill" << skillId;
+        return;
+    }
+    if (position < 0 || position > delegatesModel->rowCount()) {
+        qWarning() << "Error: Invalid position in mycroft.gui.list.insert";
+        return;
+    }
 
+    const QStringList delegateUrls = variantModelToStringList(QStringLiteral("url"), message.data);
 
-    // Gui delegates removed
-    } else if (type == QLatin1String("mycroft.gui.list.remove")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.gui.list.remove";
-            return;
-        }
+    if (delegateUrls.isEmpty()) {
+        qWarning() << "Error: no valid skills received in mycroft.gui.list.insert";
+        return;
+    }
 
-        const int position = doc[QStringLiteral("position")].toInt();
-        const int itemsNumber = doc[QStringLiteral("items_number")].toInt();
+    qWarning() << "Arrived mycroft.gui.list.insert, delegateUrls are" << delegateUrls;
 
-        //TODO: try with lifecycle managed by the view?
-        DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
-        if (!delegatesModel) {
-            qWarning() << "Error: no delegates model for skill" << skillId;
-            return;
-        }
+    QList <DelegateLoader *> delegateLoaders;
+    for (const auto &urlString : delegateUrls) {
+        const QUrl delegateUrl = QUrl::fromUserInput(urlString);
 
-        if (position < 0 || position > delegatesModel->rowCount() - 1) {
-            qWarning() << "Error: Invalid position in mycroft.gui.list.remove";
-            return;
+        if (!delegateUrl.isValid()) {
+            continue;
         }
 
-        if (itemsNumber < 0 || itemsNumber > delegatesModel->rowCount()) {
-            qWarning() << "Error: Invalid items_number in mycroft.gui.list.remove";
-            return;
+        rememberSkillDelegate(skillId, delegateUrl);
+
+        delegateLoaders << createDelegateLoader(skillId, delegateUrl);
+    }
+
+    // From the frame arriving to the first one showing the delegate: pooled ones are there already
+    for (auto *loader : delegateLoaders) {
+        if (loader->delegate()) {
+            Metrics::instance()->recordNextFrame(window(), message.receivedAt);
+        } else {
+            loader->setRequestedAt(message.receivedAt);
         }
+    }
 
-        delegatesModel->removeRows(position, itemsNumber);
+    if (delegateLoaders.count() > 0) {
+        delegatesModel->insertDelegateLoaders(position, delegateLoaders);
+        //give the focus to the first
+        delegateLoaders.first()->setFocus(true);
+    }
+}
 
-    // Gui delegates moved
-    } else if (type == QLatin1String("mycroft.gui.list.move")) {
+DelegateLoader *AbstractSkillView::createDelegateLoader(const QString &skillId, const QUrl &delegateUrl)
+{
+    // A page removed and shown again right away is still in its model, not parked yet
+    DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModels().value(skillId);
+    DelegateLoader *loader = delegatesModel ? delegatesModel->takeRemovedLoader(delegateUrl) : nullptr;
 
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.gui.list.move";
-            return;
-        }
+    if (!loader) {
+        loader = m_delegatePool->take(skillId, delegateUrl);
+    }
 
-        const int from = doc[QStringLiteral("from")].toInt();
-        const int to = doc[QStringLiteral("to")].toInt();
-        const int itemsNumber = doc[QStringLiteral("items_number")].toInt();
+    if (loader) {
+        loader->rebind();
+        return loader;
+    }
 
-        DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
+    loader = new DelegateLoader(this);
 
-        if (!delegatesModel) {
-            qWarning() << "Error: no delegates model for skill" << skillId;
-            return;
+    // TODO: download translations if skills are remote
+    m_translator->load(skillId, DelegateLoader::translationsUrl(delegateUrl).path());
+
+    if (m_translator->status(skillId) == SkillTranslator::Loaded) {
+        loader->init(skillId, delegateUrl);
+    } else {
+        // The delegate must see its translations when created, meanwhile have its QML already compiled
+        SkillState &state = m_skillStates[skillId];
+        state.pendingLoaders << loader;
+        state.pendingUrls << delegateUrl;
+        if (QQmlEngine *engine = qmlEngine(this)) {
+            m_componentCache->preload(engine, delegateUrl);
         }
+    }
 
-        if (from < 0 || from > delegatesModel->rowCount() - 1) {
-            qWarning() << "Error: Invalid from position in mycroft.gui.list.move";
-            return;
+    qWarning() << "Created a new DelegateLoader" << loader << "which will load" << delegateUrl << "for the skill" << skillId;
+
+    return loader;
+}
+
+QList<QUrl> AbstractSkillView::skillDelegateUrls(const QString &skillId, DelegatesModel *delegatesModel) const
+{
+    auto it = m_skillStates.constFind(skillId);
+    QList<QUrl> urls;
+
+    for (auto loader : delegatesModel->delegateLoaders()) {
+        QUrl url = loader->url();
+        // Pages still waiting for their translations have no url yet
+        if (url.isEmpty() && it != m_skillStates.constEnd()) {
+            url = it->pendingUrls.value(it->pendingLoaders.indexOf(loader));
         }
-        if (to < 0 || to > delegatesModel->rowCount() - 1) {
-            qWarning() << "Error: Invalid to position in mycroft.gui.list.move";
-            return;
+        if (!url.isEmpty()) {
+            urls << url;
         }
-        if (itemsNumber <= 0 || itemsNumber > delegatesModel->rowCount() - from) {
-            qWarning() << "Error: Invalid items_number in mycroft.gui.list.move";
-            return;
+    }
+
+    return urls;
+}
+
+void AbstractSkillView::initPendingLoaders(const QString &skillId)
+{
+    auto it = m_skillStates.find(skillId);
+    if (it == m_skillStates.end()) {
+        return;
+    }
+
+    const QList<QPointer<DelegateLoader>> loaders = it->pendingLoaders;
+    const QList<QUrl> urls = it->pendingUrls;
+    it->pendingLoaders.clear();
+    it->pendingUrls.clear();
+
+    for (int i = 0; i < loaders.count(); ++i) {
+        // The page may have been removed meanwhile
+        if (loaders[i]) {
+            loaders[i]->init(skillId, urls[i]);
         }
-        delegatesModel->moveRows(QModelIndex(), from, itemsNumber, QModelIndex(), to);
+    }
+}
+
+void AbstractSkillView::rememberSkillDelegate(const QString &skillId, const QUrl &url)
+{
+    QList<QUrl> &urls = m_recentDelegateUrls[skillId];
+
+    urls.removeOne(url);
+    urls.prepend(url);
+    while (urls.count() > 3) {
+        urls.removeLast();
+    }
+
+    // Kept for skills that went idle too, it's when they come back that the preload is useful
+    m_recentDelegateSkills.removeOne(skillId);
+    m_recentDelegateSkills.prepend(skillId);
+    while (m_recentDelegateSkills.count() > 32) {
+        m_recentDelegateUrls.remove(m_recentDelegateSkills.takeLast());
+    }
+}
+
+void AbstractSkillView::preloadSkillDelegates(const QString &skillId)
+{
+    QQmlEngine *engine = qmlEngine(this);
+    if (!engine) {
+        return;
+    }
+
+    for (const auto &url : m_recentDelegateUrls.value(skillId)) {
+        m_componentCache->preload(engine, url);
+    }
+}
+
+// Gui delegates removed
+void AbstractSkillView::handleGuiListRemove(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.gui.list.remove";
+        return;
+    }
+
+    const int position = message.position;
+    const int itemsNumber = message.itemsNumber;
+
+    //TODO: try with lifecycle managed by the view?
+    // The positions are the ones of the pages the skill had before sleeping
+    wakeSkill(skillId);
+    DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
+    if (!delegatesModel) {
+        qWarning() << "Error: no delegates model for skill" << skillId;
+        return;
+    }
+
+    if (position < 0 || position > delegatesModel->rowCount() - 1) {
+        qWarning() << "Error: Invalid position in mycroft.gui.list.remove";
+        return;
+    }
+
+    if (itemsNumber < 0 || itemsNumber > delegatesModel->rowCount()) {
+        qWarning() << "Error: Invalid items_number in mycroft.gui.list.remove";
+        return;
+    }
+
+    delegatesModel->removeRows(position, itemsNumber);
+}
+
+// Gui delegates moved
+void AbstractSkillView::handleGuiListMove(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.gui.list.move";
+        return;
+    }
+
+    const int from = message.from;
+    const int to = message.to;
+    const int itemsNumber = message.itemsNumber;
+
+    // The positions are the ones of the pages the skill had before sleeping
+    wakeSkill(skillId);
+    DelegatesModel *delegatesModel = m_activeSkillsModel->delegatesModelForSkill(skillId);
+
+    if (!delegatesModel) {
+        qWarning() << "Error: no delegates model for skill" << skillId;
+        return;
+    }
+
+    if (from < 0 || from > delegatesModel->rowCount() - 1) {
+        qWarning() << "Error: Invalid from position in mycroft.gui.list.move";
+        return;
+    }
+    if (to < 0 || to > delegatesModel->rowCount() - 1) {
+        qWarning() << "Error: Invalid to position in mycroft.gui.list.move";
+        return;
+    }
+    if (itemsNumber <= 0 || itemsNumber > delegatesModel->rowCount() - from) {
+        qWarning() << "Error: Invalid items_number in mycroft.gui.list.move";
+        return;
+    }
+    delegatesModel->moveRows(QModelIndex(), from, itemsNumber, QModelIndex(), to);
+}
 //END GUI MODELS
 
 
 //TODO: manage nested models?
 //BEGIN DATA MODELS
-    // Insert new items in an existing list, or creates one under "property"
-    } else if (type == QLatin1String("mycroft.session.list.insert")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.session.list.insert";
-            return;
-        }
-        const QString &property = doc[QStringLiteral("property")].toString();
-        if (property.isEmpty()) {
-            qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.insert";
-            return;
-        }
+// Insert new items in an existing list, or creates one under "property"
+void AbstractSkillView::handleSessionListInsert(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.list.insert";
+        return;
+    }
+    const QString &property = message.property;
+    if (property.isEmpty()) {
+        qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.insert";
+        return;
+    }
 
-        SessionDataMap *map = sessionDataForSkill(skillId);
-        SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        qWarning() << "Invalid skill_id in mycroft.session.list.insert:" << skillId;
+        return;
+    }
+    SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
 
-        if (!dm) {
-            dm = new SessionDataModel(map);
-            map->insertAndNotify(property, QVariant::fromValue(dm));
-        }
+    if (!dm) {
+        dm = new SessionDataModel(map);
+        map->insertAndNotify(property, QVariant::fromValue(dm));
+    }
 
-        const int position = doc[QStringLiteral("position")].toInt();
+    const int position = message.position;
 
-        if (position < 0 || position > dm->rowCount()) {
-            qWarning() << "Error: Invalid position in mycroft.session.list.insert";
-            return;
-        }
+    if (position < 0 || position > dm->listCount()) {
+        qWarning() << "Error: Invalid position in mycroft.session.list.insert";
+        return;
+    }
 
-        QList<QVariantMap> list = variantListToOrderedMap(doc[QStringLiteral("data")].toVariant().value<QVariantList>());
+    QList<QVariantMap> list = variantListToOrderedMap(message.data.value<QVariantList>());
 
-        if (list.isEmpty()) {
-            qWarning() << "Error: invalid data in mycroft.session.list.insert:" << doc[QStringLiteral("data")];
-            return;
-        }
+    if (list.isEmpty()) {
+        qWarning() << "Error: invalid data in mycroft.session.list.insert:" << message.data;
+        return;
+    }
 
-        dm->insertData(position, list);
+    dm->insertData(position, list);
+}
 
-    // Updates the value of items in an existing list, Error if under "property" no list exists
-    } else if (type == QLatin1String("mycroft.session.list.update")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.session.list.update";
-            return;
-        }
-        const QString &property = doc[QStringLiteral("property")].toString();
-        if (property.isEmpty()) {
-            qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.update";
-            return;
-        }
+// Announces a list too big to be sent all at once: only the first page arrives,
+// the rest is fetched with mycroft.session.list.fetch as the views scroll
+void AbstractSkillView::handleSessionListPaged(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.list.paged";
+        return;
+    }
+    const QString &property = message.property;
+    if (property.isEmpty()) {
+        qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.paged";
+        return;
+    }
+    const int totalCount = message.itemsNumber;
+    if (totalCount < 0) {
+        qWarning() << "Error: Invalid items_number in mycroft.session.list.paged";
+        return;
+    }
 
-        SessionDataMap *map = sessionDataForSkill(skillId);
-        SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        qWarning() << "Invalid skill_id in mycroft.session.list.paged:" << skillId;
+        return;
+    }
 
-        if (!dm) {
-            qWarning() << "Error: no list model existing under property" << property << "in mycroft.session.list.update";
-            return;
-        }
+    const QList<QVariantMap> list = variantListToOrderedMap(message.data.value<QVariantList>());
+    SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
 
-        const int position = doc[QStringLiteral("position")].toInt();
+    if (!dm) {
+        dm = new SessionDataModel(map);
+        map->insertAndNotify(property, QVariant::fromValue(dm));
+    } else {
+        dm->clear();
+    }
 
-        if (position < 0 || position > m_activeSkillsModel->rowCount()) {
-            qWarning() << "Error: Invalid position in mycroft.session.list.update";
-            return;
-        }
+    dm->insertData(0, list);
+    // The first page tells how big the next ones should be
+    dm->setPaged(totalCount, list.isEmpty() ? 50 : list.count());
+    map->connectPagedModel(property, dm);
+}
 
-        QList<QVariantMap> list = variantListToOrderedMap(doc[QStringLiteral("data")].toVariant().value<QVariantList>());
+// Updates the value of items in an existing list, Error if under "property" no list exists
+void AbstractSkillView::handleSessionListUpdate(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.list.update";
+        return;
+    }
+    const QString &property = message.property;
+    if (property.isEmpty()) {
+        qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.update";
+        return;
+    }
 
-        if (list.isEmpty()) {
-            qWarning() << "Error: invalid data in mycroft.session.list.insert:" << doc[QStringLiteral("data")];
-            return;
-        }
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        qWarning() << "Invalid skill_id in mycroft.session.list.update:" << skillId;
+        return;
+    }
+    SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
 
-        dm->updateData(position, list);
+    if (!dm) {
+        qWarning() << "Error: no list model existing under property" << property << "in mycroft.session.list.update";
+        return;
+    }
 
-    // Moves items within an existing list, Error if under "property" no list exists
-    } else if (type == QLatin1String("mycroft.session.list.move")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.session.list.update";
-            return;
-        }
-        const QString &property = doc[QStringLiteral("property")].toString();
-        if (property.isEmpty()) {
-            qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.move";
-            return;
-        }
+    const int position = message.position;
 
-        SessionDataMap *map = sessionDataForSkill(skillId);
-        SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
+    if (position < 0 || position > m_activeSkillsModel->rowCount()) {
+        qWarning() << "Error: Invalid position in mycroft.session.list.update";
+        return;
+    }
 
-        if (!dm) {
-            qWarning() << "Error: no list model existing under property" << property << "in mycroft.session.list.move";
-            return;
-        }
+    QList<QVariantMap> list = variantListToOrderedMap(message.data.value<QVariantList>());
 
-        const int from = doc[QStringLiteral("from")].toInt();
-        const int to = doc[QStringLiteral("to")].toInt();
-        const int itemsNumber = doc[QStringLiteral("items_number")].toInt();
+    if (list.isEmpty()) {
+        qWarning() << "Error: invalid data in mycroft.session.list.insert:" << message.data;
+        return;
+    }
 
-        if (from < 0 || from > dm->rowCount() - 1) {
-            qWarning() << "Error: Invalid from position in mycroft.session.list.move";
-            return;
-        }
-        if (to < 0 || to > dm->rowCount()) {
-            qWarning() << "Error: Invalid to position in mycroft.session.list.move";
-            return;
-        }
-        if (itemsNumber <= 0 || itemsNumber > dm->rowCount() - from) {
-            qWarning() << "Error: Invalid items_number in mycroft.session.list.move";
-            return;
-        }
-        dm->moveRows(QModelIndex(), from, itemsNumber, QModelIndex(), to);
+    dm->updateData(position, list);
+}
 
-    // Removes items from an existing list, Error if under "property" no list exists
-    } else if (type == QLatin1String("mycroft.session.list.remove")) {
-        const QString skillId = doc[QStringLiteral("namespace")].toString();
-        if (skillId.isEmpty()) {
-            qWarning() << "No skill_id provided in mycroft.session.list.update";
-            return;
-        }
-        const QString &property = doc[QStringLiteral("property")].toString();
-        if (property.isEmpty()) {
-            qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.move";
-            return;
-        }
+// Moves items within an existing list, Error if under "property" no list exists
+void AbstractSkillView::handleSessionListMove(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.list.update";
+        return;
+    }
+    const QString &property = message.property;
+    if (property.isEmpty()) {
+        qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.move";
+        return;
+    }
 
-        SessionDataMap *map = sessionDataForSkill(skillId);
-        SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        qWarning() << "Invalid skill_id in mycroft.session.list.move:" << skillId;
+        return;
+    }
+    SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
 
-        if (!dm) {
-            qWarning() << "Error: no list model existing under property" << property << "in mycroft.session.list.move";
-            return;
-        }
+    if (!dm) {
+        qWarning() << "Error: no list model existing under property" << property << "in mycroft.session.list.move";
+        return;
+    }
 
-        const int position = doc[QStringLiteral("position")].toInt();
-        const int itemsNumber = doc[QStringLiteral("items_number")].toInt();
+    const int from = message.from;
+    const int to = message.to;
+    const int itemsNumber = message.itemsNumber;
 
-        if (position < 0 || position > dm->rowCount() - 1) {
-            qWarning() << "Error: Invalid position in mycroft.session.list.remove of mycroft.system.active_skills";
-            return;
-        }
-        if (itemsNumber < 0 || itemsNumber > dm->rowCount() - position) {
-            qWarning() << "Error: Invalid items_number in mycroft.session.list.remove of mycroft.system.active_skills";
-            return;
-        }
+    if (from < 0 || from > dm->rowCount() - 1) {
+        qWarning() << "Error: Invalid from position in mycroft.session.list.move";
+        return;
+    }
+    if (to < 0 || to > dm->rowCount()) {
+        qWarning() << "Error: Invalid to position in mycroft.session.list.move";
+        return;
+    }
+    if (itemsNumber <= 0 || itemsNumber > dm->rowCount() - from) {
+        qWarning() << "Error: Invalid items_number in mycroft.session.list.move";
+        return;
+    }
+    dm->moveRows(QModelIndex(), from, itemsNumber, QModelIndex(), to);
+}
+
+// Removes items from an existing list, Error if under "property" no list exists
+void AbstractSkillView::handleSessionListRemove(const GuiMessage &message)
+{
+    const QString &skillId = message.skillId;
+    if (skillId.isEmpty()) {
+        qWarning() << "No skill_id provided in mycroft.session.list.update";
+        return;
+    }
+    const QString &property = message.property;
+    if (property.isEmpty()) {
+        qWarning() << "Error: Invalid or empty \"property\" in mycroft.session.list.move";
+        return;
+    }
 
-        dm->removeRows(position, itemsNumber);
+    SessionDataMap *map = sessionDataToUpdate(skillId);
+    if (!map) {
+        qWarning() << "Invalid skill_id in mycroft.session.list.remove:" << skillId;
+        return;
+    }
+    SessionDataModel *dm = map->value(property).value<SessionDataModel *>();
+
+    if (!dm) {
+        qWarning() << "Error: no list model existing under property" << property << "in mycroft.session.list.move";
+        return;
+    }
+
+    const int position = message.position;
+    const int itemsNumber = message.itemsNumber;
+
+    if (position < 0 || position > dm->listCount() - 1) {
+        qWarning() << "Error: Invalid position in mycroft.session.list.remove of mycroft.system.active_skills";
+        return;
+    }
+    if (itemsNumber < 0 || itemsNumber > dm->listCount() - position) {
+        qWarning() << "Error: Invalid items_number in mycroft.session.list.remove of mycroft.system.active_skills";
+        return;
+    }
+
+    dm->removeRows(position, itemsNumber);
+}
 //END DATA MODELS
 
 
 //BEGIN EVENTS
-    // Action triggered from the server
-    } else if (type == QLatin1String("mycroft.events.triggered")) {
-        const QString skillOrSystem = doc[QStringLiteral("namespace")].toString();
+// Action triggered from the server
+void AbstractSkillView::handleEventTriggered(const GuiMessage &message)
+{
+    const QString &skillOrSystem = message.skillId;
 
-        if (skillOrSystem.isEmpty()) {
-            qWarning() << "No namespace provided for mycroft.events.triggered";
-            return;
-        }
-        /*FIXME: do we need to keep this check? we need to also include skills without gui
-        // If it's a skill it must exist
-        if (skillOrSystem != QLatin1String("system") && !m_activeSkillsModel->skillIndex(skillOrSystem).isValid()) {
-            qWarning() << "Invalid skill id passed as namespace for mycroft.events.triggered:" << skillOrSystem;
-            return;
-        }*/
+    if (skillOrSystem.isEmpty()) {
+        qWarning() << "No namespace provided for mycroft.events.triggered";
+        return;
+    }
+    /*FIXME: do we need to keep this check? we need to also include skills without gui
+    // If it's a skill it must exist
+    if (skillOrSystem != QLatin1String("system") && !m_activeSkillsModel->skillIndex(skillOrSystem).isValid()) {
+        qWarning() << "Invalid skill id passed as namespace for mycroft.events.triggered:" << skillOrSystem;
+        return;
+    }*/
 
-        const QString eventName = doc[QStringLiteral("event_name")].toString();
-        if (eventName.isEmpty()) {
-            qWarning() << "No namespace provided for mycroft.events.triggered";
-            return;
-        }
+    const QString &eventName = message.eventName;
+    if (eventName.isEmpty()) {
+        qWarning() << "No namespace provided for mycroft.events.triggered";
+        return;
+    }
 
-        // data can also be empty
-        const QVariantMap data = doc[QStringLiteral("data")].toVariant().toMap();
+    // data can also be empty
+    const QVariantMap data = message.data.toMap();
 
+    // page_gained_focus is special: interests only one single delegate
+    if (eventName == QStringLiteral("page_gained_focus")) {
         QList<AbstractDelegate *> delegates;
 
         if (skillOrSystem == QLatin1String("system")) {
@@ -778,29 +1754,46 @@ void AbstractSkillView::onGuiSocketMessageReceived(const QString &message)
         } else {
             DelegatesModel *delegatesModel = activeSkills()->delegatesModelForSkill(skillOrSystem);
             if (delegatesModel) {
-                delegates << delegatesModel->delegates();
+                delegates = delegatesModel->delegates();
             }
         }
 
-        // page_gained_focus is special: interests only one single delegate
-        if (eventName == QStringLiteral("page_gained_focus")) {
-            int pos = data.value(QStringLiteral("number")).toInt();
-            if (pos >= 0 && pos < delegates.count()) {
-                AbstractDelegate *delegate = delegates[pos];
-                delegate->forceActiveFocus((Qt::FocusReason)ServerEventFocusReason);
-                emit delegate->guiEvent(eventName, data);
-            }
-        } else if (eventName == QStringLiteral("mycroft.gui.close.screen")) {
-            emit activeSkillClosed();
-        } else {
-            for (auto *delegate : delegates) {
-                emit delegate->guiEvent(eventName, data);
-            }
+        int pos = data.value(QStringLiteral("number")).toInt();
+        if (pos >= 0 && pos < delegates.count()) {
+            AbstractDelegate *delegate = delegates[pos];
+            delegate->forceActiveFocus((Qt::FocusReason)ServerEventFocusReason);
+            emit delegate->guiEvent(eventName, data);
+        }
+    } else if (eventName == QStringLiteral("mycroft.gui.close.screen")) {
+        emit activeSkillClosed();
+    } else if (skillOrSystem == QLatin1String("system")) {
+        // Shallow copy: handlers are free to change subscriptions while we go
+        const QHash<QString, EventSubscribers> allSubscribers = m_eventSubscribers;
+        for (const auto &subscribers : allSubscribers) {
+            deliverEvent(subscribers, eventName, data);
         }
     } else {
-        qWarning() << "Unrecognized operation" << type;
+        const EventSubscribers subscribers = m_eventSubscribers.value(skillOrSystem);
+        deliverEvent(subscribers, eventName, data);
     }
-//END EVENTS
 }
 
+void AbstractSkillView::deliverEvent(const EventSubscribers &subscribers, const QString &eventName, const QVariantMap &data)
+{
+    auto it = subscribers.constFind(eventName);
+    if (it != subscribers.constEnd()) {
+        for (auto *delegate : it.value()) {
+            emit delegate->guiEvent(eventName, data);
+        }
+    }
+
+    it = subscribers.constFind(QString());
+    if (it != subscribers.constEnd()) {
+        for (auto *delegate : it.value()) {
+            emit delegate->guiEvent(eventName, data);
+        }
+    }
+}
+//END EVENTS
+
 #include "moc_abstractskillview.cpp"
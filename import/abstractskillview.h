@@ -19,15 +19,26 @@
 #pragma once
 
 #include "mycroftcontroller.h"
+#include "guimessage.h"
 
 #include <QQuickItem>
 #include <QPointer>
+#include <QSet>
+#include <QVector>
 
 class ActiveSkillsModel;
 class AbstractSkillView;
 class AbstractDelegate;
 class SessionDataMap;
-class QTranslator;
+class MessageQueue;
+class ComponentCache;
+class DelegatePool;
+class SessionStore;
+class SessionSnapshot;
+class SocketConnection;
+class ConnectionMonitor;
+class SkillTranslator;
+class DelegateLoader;
 
 class AbstractSkillView: public QQuickItem
 {
@@ -36,11 +47,34 @@ class AbstractSkillView: public QQuickItem
 
     Q_PROPERTY(ActiveSkillsModel *activeSkills READ activeSkills CONSTANT)
 
+    /**
+     * How many skills, from the top of the active skills list, keep their delegates alive.
+     * The ones below have their delegates destroyed and their session data kept serialized,
+     * both are rebuilt when they come back in the first maximumLiveSkills. -1 (default) for no limit.
+     * A number of skills rather than bytes, see ComponentCache.
+     */
+    Q_PROPERTY(int maximumLiveSkills READ maximumLiveSkills WRITE setMaximumLiveSkills NOTIFY maximumLiveSkillsChanged)
+
+    /**
+     * Name of the file, in the cache directory, where the skills, their pages and their data
+     * are saved as they change. When set, the view shows right away what was saved there,
+     * until the server confirms or replaces it once connected. Empty (default) to save nothing.
+     */
+    Q_PROPERTY(QString snapshotName READ snapshotName WRITE setSnapshotName NOTIFY snapshotNameChanged)
+
 public:
     enum CustomFocusReasons {
         ServerEventFocusReason = Qt::OtherFocusReason
     };
 
+    /**
+     * How messages are encoded on the gui socket
+     */
+    enum Framing {
+        JsonFraming = 0, // JSON in text frames, always supported
+        CborFraming // CBOR in binary frames, needs Qt >= 5.12
+    };
+
     AbstractSkillView(QQuickItem *parent = nullptr);
     ~AbstractSkillView();
 
@@ -48,6 +82,11 @@ public:
 
     ActiveSkillsModel *activeSkills() const;
 
+    int maximumLiveSkills() const;
+    void setMaximumLiveSkills(int maximum);
+
+    QString snapshotName() const;
+    void setSnapshotName(const QString &name);
 
     //API for MycroftController, NOT QML
     /**
@@ -60,6 +99,19 @@ public:
      */
     void setUrl(const QUrl &url);
 
+    /**
+     * The framing negotiated with the server for the gui socket,
+     * to be set before setUrl
+     */
+    Framing framing() const;
+    void setFraming(Framing framing);
+
+    /**
+     * @returns the framings this client can speak, with names as used by the
+     * mycroft.gui.connected message, in order of preference
+     */
+    static QStringList supportedFramings();
+
     /**
      * Unique identifier for this GUI
      */
@@ -77,8 +129,79 @@ public:
      */
     SessionDataMap *sessionDataForSkill(const QString &skillId);
 
+    /**
+     * @internal keeps the index used to route mycroft.events.triggered to the delegates of a skill,
+     * invoked by AbstractDelegate when its handledEvents change. An empty list means all the events.
+     */
+    void subscribeDelegateEvents(AbstractDelegate *delegate, const QStringList &events);
+    void unsubscribeDelegateEvents(AbstractDelegate *delegate, const QStringList &events);
+
     void writeProperties(const QString &skillId, const QVariantMap &data);
     void deleteProperty(const QString &skillId, const QString &property);
+    // Asks the server for count more items of the paged list under property, false if not connected
+    bool fetchListItems(const QString &skillId, const QString &property, int position, int count);
+
+    /**
+     * Routes a message, already decoded by the socket thread, to the handler registered for its type
+     * @internal used by the gui socket, and by the autotests to go without one
+     */
+    void dispatchGuiMessage(const GuiMessage &message);
+
+    /**
+     * The next message is taken as the answer to mycroft.gui.resume, as after a reconnection
+     * @internal used by the autotests
+     */
+    void expectResumeReply();
+
+    /**
+     * @returns the queue of messages waiting to be sent on the gui socket
+     * @internal used by the autotests
+     */
+    MessageQueue *outboundQueue() const;
+
+    /**
+     * @returns the compiled components of the skill delegates shown by this view
+     * @internal used by DelegateLoader and the autotests
+     */
+    ComponentCache *componentCache() const;
+
+    /**
+     * @returns the delegates removed from the view, kept to be shown again
+     * @internal used by DelegateLoader and the autotests
+     */
+    DelegatePool *delegatePool() const;
+
+    /**
+     * Where the session data comes from when the gui connection is shared, nullptr otherwise.
+     * @internal set by MycroftController when the view registers
+     */
+    SessionStore *sessionStore() const;
+    void setSessionStore(SessionStore *store);
+
+    /**
+     * The view whose gui connection this one uses, nullptr if it has its own
+     */
+    AbstractSkillView *guiChannel() const;
+
+    /**
+     * Creates the gui socket of this view, its queue and its monitor, if not there yet:
+     * views registered as followers have none until they own the connection.
+     * @internal used by MycroftController
+     */
+    void setupGuiConnection();
+
+    /**
+     * Has follower use the connection of this view: it gets all the messages to the gui
+     * after this view, and its messages to the server go out from this view's socket.
+     * removeFollower throws away its state, as it won't be updated anymore.
+     * @internal used by MycroftController
+     */
+    void addFollower(AbstractSkillView *follower);
+    void removeFollower(AbstractSkillView *follower);
+    QList<AbstractSkillView *> followers() const;
+
+protected:
+    void componentComplete() override;
 
 Q_SIGNALS:
     /**
@@ -88,19 +211,142 @@ Q_SIGNALS:
     //socket stuff
     void statusChanged();
     void closed();
+    void maximumLiveSkillsChanged();
+    void snapshotNameChanged();
 
 private:
-    void onGuiSocketMessageReceived(const QString &message);
+    typedef void (AbstractSkillView::*GuiMessageHandler)(const GuiMessage &message);
+
+    /**
+     * Queues a message for the gui socket, sent with the negotiated framing
+     */
+    void sendGuiMessage(const QVariantMap &message);
+
+    // A message for a follower, as already applied by the view owning the connection
+    void followGuiMessage(const GuiMessage &message);
+    // The socket messages actually go through, nullptr for a follower cut off from its channel
+    SocketConnection *guiSocket() const;
+    void registerGuiMessageHandler(GuiMessage::Type type, GuiMessageHandler handler);
 
-    QTimer m_reconnectTimer;
-    QTimer m_trimComponentsTimer;
+    // Handlers for the gui socket protocol
+    void handleSessionSet(const GuiMessage &message);
+    void handleSessionDelete(const GuiMessage &message);
+    void handleSessionPatch(const GuiMessage &message);
+
+    // Sets a whole top level value of the session data, lists become models
+    void setSessionValue(SessionDataMap *map, const QString &key, const QVariant &value, const QString &identityKey);
+    void handleActiveSkillsInsert(const GuiMessage &message);
+    void handleActiveSkillsRemove(const GuiMessage &message);
+    void handleActiveSkillsMove(const GuiMessage &message);
+    void handleGuiListInsert(const GuiMessage &message);
+    void handleGuiListRemove(const GuiMessage &message);
+    void handleGuiListMove(const GuiMessage &message);
+    void handleSessionListInsert(const GuiMessage &message);
+    void handleSessionListUpdate(const GuiMessage &message);
+    void handleSessionListMove(const GuiMessage &message);
+    void handleSessionListRemove(const GuiMessage &message);
+    void handleSessionListPaged(const GuiMessage &message);
+    void handleEventTriggered(const GuiMessage &message);
+    void handleResume(const GuiMessage &message);
+
+    /**
+     * Checksum of the active skills list, sent to the server with the state version
+     * when reconnecting, see mycroft.gui.resume
+     */
+    QString stateDigest() const;
+    // Starts the resume handshake after a reconnection, if there is some state worth keeping
+    void requestResume();
+    // True if this view or one of its followers has skillId among its active skills
+    bool showsSkill(const QString &skillId) const;
+    // The data of skillId the session messages change, also when only a follower shows the skill
+    SessionDataMap *sessionDataToUpdate(const QString &skillId);
+    // Throws away all the skills and their data, the server will send everything again
+    void resetState();
+    struct SkillState;
+    // The paged lists of all the skills ask again for the pages that never came
+    void cancelListFetches();
+    // Drops the session data of a skill, or the reference on it while it's shared
+    void releaseSessionData(const QString &skillId, SkillState &state);
+
+    // Creates the delegates which were waiting for the translations of skillId
+    void initPendingLoaders(const QString &skillId);
+    // The urls of the pages of skillId in order, those waiting for the translations included
+    QList<QUrl> skillDelegateUrls(const QString &skillId, DelegatesModel *delegatesModel) const;
+    // A loader for url, reused from the pool when possible
+    DelegateLoader *createDelegateLoader(const QString &skillId, const QUrl &url);
+
+    // Puts the skills out of maximumLiveSkills to sleep, and wakes up the ones back in
+    void enforceLiveSkills();
+    void hibernateSkill(const QString &skillId);
+    void wakeSkill(const QString &skillId);
+
+    // Shows again the skills of the snapshot, as if they were all hibernated, if the view is still empty
+    void restoreSnapshot();
+    // Saves the snapshot soon, encoding again what skillId shows if not empty
+    void scheduleSnapshot(const QString &skillId);
+    void writeSnapshot();
+
+    // Compiles the pages a skill showed recently, before it asks to show them again
+    void preloadSkillDelegates(const QString &skillId);
+    // Only for the skills that showed a page most recently, active or not
+    void rememberSkillDelegate(const QString &skillId, const QUrl &url);
+
+    typedef QHash<QString, QVector<AbstractDelegate *>> EventSubscribers;
+    void deliverEvent(const EventSubscribers &subscribers, const QString &eventName, const QVariantMap &data);
+
+    QVector<GuiMessageHandler> m_guiMessageHandlers;
+
+    // Per skill id: delegates by the event name they handle, empty name for the ones handling any event
+    QHash<QString, EventSubscribers> m_eventSubscribers;
+
+    ConnectionMonitor *m_connectionMonitor = nullptr;
+    // How long the state is kept after a disconnection, waiting for a resume
+    QTimer m_resumeGraceTimer;
+    // How long to wait an answer to mycroft.gui.resume
+    QTimer m_resumeReplyTimer;
+    // Number of messages from the server applied since the last reset
+    quint64 m_stateVersion = 0;
+    bool m_resuming = false;
     QString m_id;
     QUrl m_url;
-    QHash<QString, SessionDataMap *> m_skillData;
-    QHash<QString, QTranslator *> m_translatorsForSkill;
+    Framing m_framing = JsonFraming;
+    int m_maximumLiveSkills = -1;
+
+    QString m_snapshotName;
+    SessionSnapshot *m_snapshot = nullptr;
+    QTimer m_snapshotTimer;
+    // Skills changed since the snapshot was last saved
+    QSet<QString> m_snapshotDirty;
+
+    // Everything the view keeps for an active skill, looked up once per message
+    struct SkillState {
+        SessionDataMap *sessionData = nullptr;
+        // Loaders waiting for the translations of the skill before creating their delegate
+        QList<QPointer<DelegateLoader>> pendingLoaders;
+        QList<QUrl> pendingUrls;
+
+        // While hibernated: the serialized session data and what the delegates model showed
+        bool hibernated = false;
+        QByteArray hibernatedData;
+        QList<QUrl> hibernatedUrls;
+        int hibernatedCurrentIndex = 0;
+    };
+    QHash<QString, SkillState> m_skillStates;
+    // Most recent first, a few for each skill
+    QHash<QString, QList<QUrl>> m_recentDelegateUrls;
+    // The skills in m_recentDelegateUrls, most recent first
+    QStringList m_recentDelegateSkills;
+
+    SessionStore *m_sessionStore = nullptr;
+    QPointer<AbstractSkillView> m_guiChannel;
+    QList<AbstractSkillView *> m_followers;
 
     MycroftController *m_controller;
-    QWebSocket *m_guiWebSocket;
+    SocketConnection *m_guiWebSocket = nullptr;
+    MessageQueue *m_outboundQueue = nullptr;
+    ComponentCache *m_componentCache;
+    DelegatePool *m_delegatePool;
+    SkillTranslator *m_translator;
     ActiveSkillsModel *m_activeSkillsModel;
 };
 
@@ -74,6 +74,7 @@ void ActiveSkillsModel::setBlackList(const QStringList &list)
     }
 
     m_blackList = list;
+    m_blackListSet = QSet<QString>::fromList(list);
 
     // TODO: delete/create delegates?
     emit blackListChanged();
@@ -91,6 +92,7 @@ void ActiveSkillsModel::setWhiteList(const QStringList &list)
     }
 
     m_whiteList = list;
+    m_whiteListSet = QSet<QString>::fromList(list);
 
     emit whiteListChanged();
 }
@@ -113,7 +115,14 @@ void ActiveSkillsModel::checkGuiActivation(const QString &skillId)
 
 bool ActiveSkillsModel::skillAllowed(const QString skillId) const
 {
-    return !m_blackList.contains(skillId) && (m_whiteList.isEmpty() || m_whiteList.contains(skillId));
+    return !m_blackListSet.contains(skillId) && (m_whiteListSet.isEmpty() || m_whiteListSet.contains(skillId));
+}
+
+void ActiveSkillsModel::updateSkillRows(int row)
+{
+    for (int i = row; i < m_skills.count(); ++i) {
+        m_skillRows[m_skills[i]] = i;
+    }
 }
 
 void ActiveSkillsModel::insertSkills(int position, const QStringList &skillList)
@@ -123,13 +132,14 @@ void ActiveSkillsModel::insertSkills(int position, const QStringList &skillList)
     }
 
     QStringList filteredList;
+    QSet<QString> inserted;
 
-    std::copy_if(skillList.begin(), skillList.end(),
-                 std::back_inserter(filteredList),
-                 [this](const QString &val)
-                 {
-                     return !m_skills.contains(val);
-                 });
+    for (const auto &skillId : skillList) {
+        if (!m_skillRows.contains(skillId) && !inserted.contains(skillId)) {
+            filteredList << skillId;
+            inserted.insert(skillId);
+        }
+    }
 
     if (filteredList.isEmpty()) {
         return;
@@ -142,6 +152,7 @@ void ActiveSkillsModel::insertSkills(int position, const QStringList &skillList)
         m_skills.insert(position + i, skillId);
         ++i;
     }
+    updateSkillRows(position);
     //First syncactiveindex then endInserRows as it could make the view think we don't have any delegates for current skill
     syncActiveIndex();
     endInsertRows();
@@ -159,7 +170,7 @@ QStringList ActiveSkillsModel::activeSkills() const
 
 QModelIndex ActiveSkillsModel::skillIndex(const QString &skillId)
 {
-    const int row = m_skills.indexOf(skillId);
+    const int row = m_skillRows.value(skillId, -1);
 
     if (row >= 0) {
         return index(row, 0, QModelIndex());
@@ -175,7 +186,7 @@ DelegatesModel *ActiveSkillsModel::delegatesModelForSkill(const QString &skillId
         return nullptr;
     }
 
-    if (!skillId.isEmpty() && !m_skills.contains(skillId)) {
+    if (!skillId.isEmpty() && !m_skillRows.contains(skillId)) {
         return nullptr;
     }
 
@@ -183,7 +194,7 @@ DelegatesModel *ActiveSkillsModel::delegatesModelForSkill(const QString &skillId
     if (!model) {
         model = new DelegatesModel(this);
         m_delegatesModels[skillId] = model;
-        const int row = m_skills.indexOf(skillId);
+        const int row = m_skillRows.value(skillId, -1);
         emit dataChanged(index(row, 0), index(row, 0), {Delegates});
     }
 
@@ -221,6 +232,7 @@ bool ActiveSkillsModel::moveRows(const QModelIndex &sourceParent, int sourceRow,
             m_skills.move(sourceRow + i, destinationChild + i);
         }
     }
+    updateSkillRows(qMin(sourceRow, destinationChild));
 
     endMoveRows();
 
@@ -245,8 +257,10 @@ bool ActiveSkillsModel::removeRows(int row, int count, const QModelIndex &parent
             model->deleteLater();
             m_delegatesModels.remove(*it);
         }
+        m_skillRows.remove(*it);
     }
     m_skills.erase(m_skills.begin() + row, m_skills.begin() + row + count);
+    updateSkillRows(row);
 
     endRemoveRows();
     syncActiveIndex();
@@ -19,6 +19,7 @@
 
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
+#include <QSet>
 
 class AbstractDelegate;
 class DelegatesModel;
@@ -81,10 +82,18 @@ Q_SIGNALS:
 
 private:
     void syncActiveIndex();
+    // Updates the row index of the skills from row on
+    void updateSkillRows(int row);
+
     int m_activeIndex = -1;
     QList<QString> m_skills;
-    QList<QString> m_blackList;
-    QList<QString> m_whiteList;
+    // Row of each skill in m_skills, kept in sync with it
+    QHash<QString, int> m_skillRows;
+    QStringList m_blackList;
+    QStringList m_whiteList;
+    // The same lists, for the lookups of skillAllowed
+    QSet<QString> m_blackListSet;
+    QSet<QString> m_whiteListSet;
     //TODO
     QHash<QString, DelegatesModel*> m_delegatesModels;
 };
@@ -0,0 +1,355 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "audiometer.h"
+
+#include <QAudioBuffer>
+#include <QDebug>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AUDIOMETER_USE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIOMETER_USE_NEON
+#endif
+
+namespace {
+
+// Running sums of one channel, or of one SIMD lane
+struct ChannelSums {
+    float peak = 0;
+    double squares = 0;
+    double absolutes = 0;
+};
+
+inline float toFloat(quint8 sample)
+{
+    return (int(sample) - 128) / 128.0f;
+}
+
+inline float toFloat(qint16 sample)
+{
+    return sample / 32768.0f;
+}
+
+inline float toFloat(quint16 sample)
+{
+    return (int(sample) - 32768) / 32768.0f;
+}
+
+inline float toFloat(qint32 sample)
+{
+    return float(sample / 2147483648.0);
+}
+
+inline float toFloat(float sample)
+{
+    // NaN would poison all the sums
+    return sample == sample ? sample : 0.0f;
+}
+
+template <typename Sample>
+void measureScalar(const Sample *data, int firstFrame, int frames, int channels, ChannelSums *sums, float *mono)
+{
+    const Sample *frame = data + firstFrame * channels;
+
+    for (int i = firstFrame; i < frames; ++i, frame += channels) {
+        float total = 0;
+        for (int c = 0; c < channels; ++c) {
+            const float value = toFloat(frame[c]);
+            total += value;
+            if (c < AudioMeter::MaximumChannels) {
+                const float magnitude = std::fabs(value);
+                ChannelSums &channel = sums[c];
+                channel.peak = qMax(channel.peak, magnitude);
+                channel.squares += value * value;
+                channel.absolutes += magnitude;
+            }
+        }
+        if (mono) {
+            mono[i] = total / channels;
+        }
+    }
+}
+
+#if defined(AUDIOMETER_USE_SSE2) || defined(AUDIOMETER_USE_NEON)
+
+#if defined(AUDIOMETER_USE_SSE2)
+typedef __m128 Vec4;
+
+inline Vec4 load4(const float *data)
+{
+    const __m128 v = _mm_loadu_ps(data);
+    return _mm_and_ps(v, _mm_cmpord_ps(v, v));
+}
+
+inline Vec4 load4(const qint16 *data)
+{
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(data));
+    // Sign extended to 32 bit
+    const __m128i wide = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    return _mm_mul_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(1.0f / 32768.0f));
+}
+
+inline Vec4 load4(const qint32 *data)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 2147483648.0f));
+}
+
+inline Vec4 zero4() { return _mm_setzero_ps(); }
+inline Vec4 add4(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+inline Vec4 mul4(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+inline Vec4 max4(Vec4 a, Vec4 b) { return _mm_max_ps(a, b); }
+inline Vec4 abs4(Vec4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline void store4(float *out, Vec4 a) { _mm_storeu_ps(out, a); }
+
+// (a0 + a1, a2 + a3) in the two lowest lanes
+inline Vec4 pairSums4(Vec4 a)
+{
+    const Vec4 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+    const Vec4 sums = _mm_add_ps(a, swapped);
+    return _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(2, 0, 2, 0));
+}
+#else
+typedef float32x4_t Vec4;
+
+inline Vec4 load4(const float *data)
+{
+    const float32x4_t v = vld1q_f32(data);
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), vceqq_f32(v, v)));
+}
+
+inline Vec4 load4(const qint16 *data)
+{
+    const int32x4_t wide = vmovl_s16(vld1_s16(data));
+    return vmulq_n_f32(vcvtq_f32_s32(wide), 1.0f / 32768.0f);
+}
+
+inline Vec4 load4(const qint32 *data)
+{
+    return vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(data)), 1.0f / 2147483648.0f);
+}
+
+inline Vec4 zero4() { return vdupq_n_f32(0); }
+inline Vec4 add4(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+inline Vec4 mul4(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+inline Vec4 max4(Vec4 a, Vec4 b) { return vmaxq_f32(a, b); }
+inline Vec4 abs4(Vec4 a) { return vabsq_f32(a); }
+inline void store4(float *out, Vec4 a) { vst1q_f32(out, a); }
+
+inline Vec4 pairSums4(Vec4 a)
+{
+    const float32x2_t sums = vpadd_f32(vget_low_f32(a), vget_high_f32(a));
+    return vcombine_f32(sums, sums);
+}
+#endif
+
+// Lane i of the vectors holds channel i % channels, for 1, 2 or 4 channels.
+// Returns the frames done, the rest is left to the scalar loop.
+template <typename Sample>
+int measureVector(const Sample *data, int frames, int channels, ChannelSums *sums, float *mono)
+{
+    const int framesPerVector = 4 / channels;
+    // Single precision sums of a few thousand samples are plenty for a meter,
+    // flushed in double every block so long buffers don't lose precision
+    const int blockFrames = 1024;
+
+    int done = 0;
+    while (frames - done >= framesPerVector) {
+        Vec4 peak = zero4();
+        Vec4 squares = zero4();
+        Vec4 absolutes = zero4();
+
+        const int blockEnd = qMin(frames - (frames - done) % framesPerVector, done + blockFrames);
+        for (; done < blockEnd; done += framesPerVector) {
+            const Vec4 value = load4(data + done * channels);
+            const Vec4 magnitude = abs4(value);
+            peak = max4(peak, magnitude);
+            squares = add4(squares, mul4(value, value));
+            absolutes = add4(absolutes, magnitude);
+
+            if (!mono) {
+                continue;
+            }
+            float lanes[4];
+            if (channels == 1) {
+                store4(mono + done, value);
+            } else if (channels == 2) {
+                store4(lanes, pairSums4(value));
+                mono[done] = lanes[0] * 0.5f;
+                mono[done + 1] = lanes[1] * 0.5f;
+            } else {
+                store4(lanes, pairSums4(value));
+                mono[done] = (lanes[0] + lanes[1]) * 0.25f;
+            }
+        }
+
+        float lanePeaks[4];
+        float laneSquares[4];
+        float laneAbsolutes[4];
+        store4(lanePeaks, peak);
+        store4(laneSquares, squares);
+        store4(laneAbsolutes, absolutes);
+        for (int lane = 0; lane < 4; ++lane) {
+            ChannelSums &channel = sums[lane % channels];
+            channel.peak = qMax(channel.peak, lanePeaks[lane]);
+            channel.squares += laneSquares[lane];
+            channel.absolutes += laneAbsolutes[lane];
+        }
+    }
+
+    return done;
+}
+
+template <typename Sample>
+int measureFast(const Sample *data, int frames, int channels, ChannelSums *sums, float *mono)
+{
+    if (channels != 1 && channels != 2 && channels != 4) {
+        return 0;
+    }
+    return measureVector(data, frames, channels, sums, mono);
+}
+#endif
+
+// 8 bit and unsigned 16 bit samples are slow anyway, and rare
+inline int measureFast(const quint8 *, int, int, ChannelSums *, float *)
+{
+    return 0;
+}
+
+inline int measureFast(const quint16 *, int, int, ChannelSums *, float *)
+{
+    return 0;
+}
+
+#if !defined(AUDIOMETER_USE_SSE2) && !defined(AUDIOMETER_USE_NEON)
+template <typename Sample>
+int measureFast(const Sample *, int, int, ChannelSums *, float *)
+{
+    return 0;
+}
+#endif
+
+template <typename Sample>
+void measureSamples(const void *data, int frames, int channels, ChannelSums *sums, float *mono)
+{
+    const Sample *samples = static_cast<const Sample *>(data);
+    const int done = measureFast(samples, frames, channels, sums, mono);
+    measureScalar(samples, done, frames, channels, sums, mono);
+}
+
+}
+
+float AudioMeter::Levels::maximumPeak() const
+{
+    float result = 0;
+    for (int i = 0; i < qMin(channels, int(MaximumChannels)); ++i) {
+        result = qMax(result, peak[i]);
+    }
+    return result;
+}
+
+AudioMeter::SampleFormat AudioMeter::sampleFormat(const QAudioFormat &format)
+{
+    switch (format.sampleType()) {
+    case QAudioFormat::SignedInt:
+        if (format.sampleSize() == 16) {
+            return Int16;
+        } else if (format.sampleSize() == 32) {
+            return Int32;
+        }
+        break;
+    case QAudioFormat::UnSignedInt:
+        if (format.sampleSize() == 8) {
+            return UInt8;
+        } else if (format.sampleSize() == 16) {
+            return UInt16;
+        }
+        break;
+    case QAudioFormat::Float:
+        if (format.sampleSize() == 32) {
+            return Float32;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return Unsupported;
+}
+
+AudioMeter::Levels AudioMeter::measure(const void *data, int frames, int channels, SampleFormat format, float *mono)
+{
+    Levels levels;
+
+    if (frames <= 0 || channels <= 0) {
+        return levels;
+    }
+
+    ChannelSums sums[MaximumChannels];
+
+    switch (format) {
+    case UInt8:
+        measureSamples<quint8>(data, frames, channels, sums, mono);
+        break;
+    case Int16:
+        measureSamples<qint16>(data, frames, channels, sums, mono);
+        break;
+    case UInt16:
+        measureSamples<quint16>(data, frames, channels, sums, mono);
+        break;
+    case Int32:
+        measureSamples<qint32>(data, frames, channels, sums, mono);
+        break;
+    case Float32:
+        measureSamples<float>(data, frames, channels, sums, mono);
+        break;
+    default:
+        qWarning() << "Unsupported sample format for audio levels";
+        return levels;
+    }
+
+    levels.channels = channels;
+    levels.frames = frames;
+    for (int c = 0; c < qMin(channels, int(MaximumChannels)); ++c) {
+        levels.peak[c] = qMin(sums[c].peak, 1.0f);
+        levels.rms[c] = qMin(float(std::sqrt(sums[c].squares / frames)), 1.0f);
+        levels.mean[c] = qMin(float(sums[c].absolutes / frames), 1.0f);
+    }
+
+    return levels;
+}
+
+AudioMeter::Levels AudioMeter::measure(const QAudioBuffer &buffer, float *mono)
+{
+    return measure(buffer.constData(), buffer.frameCount(), buffer.format().channelCount(),
+                   sampleFormat(buffer.format()), mono);
+}
+
+AudioMeter::Levels AudioMeter::measure(const QByteArray &data, const QAudioFormat &format, float *mono)
+{
+    const int frameBytes = format.bytesPerFrame();
+    if (frameBytes <= 0) {
+        return Levels();
+    }
+
+    return measure(data.constData(), data.size() / frameBytes, format.channelCount(), sampleFormat(format), mono);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QAudioFormat>
+#include <QByteArray>
+
+class QAudioBuffer;
+
+/**
+ * Levels of interleaved PCM buffers: peak, RMS and mean absolute value of
+ * each channel, and optionally the mono downmix, all in a single pass.
+ * 16 bit, 32 bit and float samples go through SSE2 or NEON kernels when
+ * the number of channels is 1, 2 or 4. Samples are in native byte order.
+ */
+class AudioMeter
+{
+public:
+    enum SampleFormat {
+        Unsupported = 0,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        Float32
+    };
+
+    enum {
+        // Channels past those still go in the downmix, but get no levels of their own
+        MaximumChannels = 8
+    };
+
+    // All values between 0 and 1
+    struct Levels {
+        int channels = 0;
+        int frames = 0;
+        float peak[MaximumChannels] = {};
+        float rms[MaximumChannels] = {};
+        float mean[MaximumChannels] = {};
+
+        // The highest of the channels
+        float maximumPeak() const;
+    };
+
+    static SampleFormat sampleFormat(const QAudioFormat &format);
+
+    /**
+     * Measures frames of interleaved samples, if mono is not null
+     * the average of the channels of each frame is written there
+     */
+    static Levels measure(const void *data, int frames, int channels, SampleFormat format, float *mono = nullptr);
+    static Levels measure(const QAudioBuffer &buffer, float *mono = nullptr);
+    static Levels measure(const QByteArray &data, const QAudioFormat &format, float *mono = nullptr);
+};
+
@@ -1,5 +1,6 @@
 #include "audiorec.h"
 #include "controllerconfig.h"
+#include "audiometer.h"
 
 #include <QUrl>
 #include <QFile>
@@ -10,19 +11,65 @@
 
 AudioRec::AudioRec(QObject *parent) :
     QObject(parent),
-    m_controller(MycroftController::instance())
+    m_controller(MycroftController::instance()),
+    m_appSettingObj(new GlobalSettings(this))
 {
 
 }
 
+bool AudioRec::streaming() const
+{
+    return m_streaming;
+}
+
+int AudioRec::chunkDuration() const
+{
+    return m_chunkDuration;
+}
+
+void AudioRec::setChunkDuration(int duration)
+{
+    duration = qBound(10, duration, 1000);
+    if (m_chunkDuration == duration) {
+        return;
+    }
+
+    m_chunkDuration = duration;
+    emit chunkDurationChanged();
+}
+
+bool AudioRec::voiceActivityDetection() const
+{
+    return m_voiceActivityDetection;
+}
+
+void AudioRec::setVoiceActivityDetection(bool detection)
+{
+    if (m_voiceActivityDetection == detection) {
+        return;
+    }
+
+    m_voiceActivityDetection = detection;
+    emit voiceActivityDetectionChanged();
+}
+
+int AudioRec::hangover() const
+{
+    return m_detector.hangover();
+}
+
+void AudioRec::setHangover(int hangover)
+{
+    if (m_detector.hangover() == hangover) {
+        return;
+    }
+
+    m_detector.setHangover(hangover);
+    emit hangoverChanged();
+}
+
 void AudioRec::recordTStart()
 {
-//    destinationFile.setFileName(QStringLiteral("/tmp/mycroft_in.raw"));
-//    destinationFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    buffer.open( QIODevice::ReadWrite | QIODevice::Truncate );
-    //connect(&buffer, &QBuffer::bytesWritten, this, &AudioRec::bytesWritten);
     QAudioFormat format;
     format.setSampleRate(8000);
     format.setChannelCount(1);
@@ -37,20 +84,77 @@ void AudioRec::recordTStart()
          format = info.nearestFormat(format);
      }
 
+    if (audio) {
+        audio->stop();
+        audio->deleteLater();
+    }
     audio = new QAudioInput(format, this);
-    //audio->start(&destinationFile);
+
+    const bool streaming = m_appSettingObj->streamMicrophone();
+    if (m_streaming != streaming) {
+        m_streaming = streaming;
+        emit streamingChanged();
+    }
+
+    format = audio->format();
+    // Whole frames only: the other side doesn't have to join samples across chunks
+    m_frameBytes = qMax(1, format.bytesPerFrame());
+    m_chunkBytes = qMax(m_frameBytes, format.bytesForDuration(qint64(m_chunkDuration) * 1000) / m_frameBytes * m_frameBytes);
+    m_pendingChunk.clear();
+    m_pendingChunk.reserve(m_chunkBytes * 2);
+    m_pendingFrame = 0;
+    m_chunksSent = 0;
+    m_bytesSent = 0;
+    m_detector.reset(format.sampleRate());
+
+    if (m_streaming) {
+        // Everything needed to interpret the binary frames that follow, until the end message
+        m_controller->sendRequest(QStringLiteral("recognizer_loop:incoming_aud.start"), QVariantMap({
+            {QStringLiteral("lang"), QStringLiteral("en-us")},
+            {QStringLiteral("codec"), QStringLiteral("audio/pcm")},
+            {QStringLiteral("sampleRate"), format.sampleRate()},
+            {QStringLiteral("channels"), format.channelCount()},
+            {QStringLiteral("sampleSize"), format.sampleSize()},
+            {QStringLiteral("signed"), format.sampleType() == QAudioFormat::SignedInt},
+            {QStringLiteral("chunkSize"), m_chunkBytes}
+        }));
+    }
+
+    m_recording = true;
     device = audio->start();
-    destinationFile.setFileName(QStringLiteral("/tmp/mycroft_in.raw"));
-    destinationFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
     connect(device, &QIODevice::readyRead, this, &AudioRec::captureDataFromDevice);
-    //audio->start();
 }
 
 void AudioRec::recordTStop()
 {
-    qDebug() << "I SHOULD NOT BE HERE";
+    if (!m_recording) {
+        return;
+    }
+
+    // What's still buffered in the device belongs to the utterance as well
+    if (readDevice()) {
+        emit speechEnded();
+    }
+    m_recording = false;
     audio->stop();
-    destinationFile.close();
+    device = nullptr;
+
+    if (m_streaming) {
+        sendChunks(true);
+        m_controller->sendRequest(QStringLiteral("recognizer_loop:incoming_aud.end"), QVariantMap({
+            {QStringLiteral("chunks"), m_chunksSent},
+            {QStringLiteral("bytes"), m_bytesSent}
+        }));
+    } else {
+        // Written only now that it's known where the speech ends
+        dropBefore(speechConfirmed() ? m_detector.speechBegin() : 0);
+        const qint64 size = qMin<qint64>(m_pendingChunk.size(), (keptEnd(true) - m_pendingFrame) * m_frameBytes);
+        destinationFile.setFileName(QStringLiteral("/tmp/mycroft_in.raw"));
+        destinationFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+        destinationFile.write(m_pendingChunk.constData(), qMax<qint64>(0, size));
+        destinationFile.close();
+        m_pendingChunk.clear();
+    }
     emit recordTStatus(QStringLiteral("Completed"));
 }
 
@@ -80,23 +184,100 @@ void AudioRec::returnStream()
 
 void AudioRec::captureDataFromDevice()
 {
+    if (readDevice()) {
+        emit speechEnded();
+        recordTStop();
+    }
+}
+
+bool AudioRec::readDevice()
+{
+    if (!m_recording || !device) {
+        return false;
+    }
+
     QByteArray inputByteArray = device->readAll();
-    destinationFile.write(inputByteArray);
-    const int channelbytes = audio->format().sampleSize() / 8;
-    const int samplebytes = audio->format().channelCount() * channelbytes;
-    const int samplecount = inputByteArray.size() / samplebytes;
-    quint32 maxvalue= 0;
-    quint32 value = 0;
-    quint32 amp = 255;
-    const unsigned char* ptr = reinterpret_cast<const unsigned char*>(inputByteArray.data());
-    for (int i = 0; i < samplecount; ++i) {
-        for (int j = 0; j < audio->format().channelCount(); ++j) {
-            value = *reinterpret_cast<const quint8*>(ptr);
+    if (inputByteArray.isEmpty()) {
+        return false;
+    }
+
+    const int frames = inputByteArray.size() / m_frameBytes;
+    if (m_mono.size() < frames) {
+        m_mono.resize(frames);
+    }
+    const AudioMeter::Levels levels = AudioMeter::measure(inputByteArray, audio->format(), m_mono.data());
+    emit micAudioLevelChanged(levels.maximumPeak());
+
+    m_pendingChunk.append(inputByteArray);
+
+    bool ended = false;
+    if (m_voiceActivityDetection) {
+        const VoiceActivityDetector::State previous = m_detector.state();
+        const VoiceActivityDetector::State state = m_detector.process(m_mono.constData(), levels.frames);
+        if (previous == VoiceActivityDetector::Silence && state != VoiceActivityDetector::Silence) {
+            emit speechStarted();
+        }
+        ended = previous != VoiceActivityDetector::Ended && state == VoiceActivityDetector::Ended;
+        // Nothing before the speech is ever sent, but until some is found all is kept:
+        // missing it shouldn't lose the utterance
+        if (speechConfirmed()) {
+            dropBefore(m_detector.speechBegin());
         }
-        maxvalue = qMax(value, maxvalue);
-        ptr += channelbytes;
     }
-    maxvalue = qMin(maxvalue, amp);
-    qreal m_level = qreal(maxvalue) / amp;
-    emit micAudioLevelChanged(m_level);
+
+    if (m_streaming) {
+        sendChunks(false);
+    }
+
+    return ended;
+}
+
+qint64 AudioRec::keptEnd(bool final) const
+{
+    const qint64 captured = m_pendingFrame + m_pendingChunk.size() / m_frameBytes;
+
+    if (!m_voiceActivityDetection) {
+        return captured;
+    } else if (!speechConfirmed()) {
+        // Nothing can be sent while it's not known where the speech starts, all of it at the end
+        return final ? captured : m_pendingFrame;
+    }
+    return m_detector.speechEnd();
+}
+
+bool AudioRec::speechConfirmed() const
+{
+    return m_voiceActivityDetection && m_detector.state() != VoiceActivityDetector::Silence;
+}
+
+void AudioRec::dropBefore(qint64 frame)
+{
+    const int size = int(qBound<qint64>(0, (frame - m_pendingFrame) * m_frameBytes, m_pendingChunk.size()));
+    if (size > 0) {
+        m_pendingChunk.remove(0, size);
+        m_pendingFrame += size / m_frameBytes;
+    }
+}
+
+void AudioRec::sendChunks(bool all)
+{
+    // What comes after the last speech might be the trailing silence: it waits
+    const int available = int(qBound<qint64>(0, (keptEnd(all) - m_pendingFrame) * m_frameBytes, m_pendingChunk.size()));
+
+    int offset = 0;
+    while (available - offset >= m_chunkBytes || (all && offset < available)) {
+        const int size = qMin(m_chunkBytes, available - offset);
+        m_controller->sendBinaryFrame(QByteArray(m_pendingChunk.constData() + offset, size));
+        offset += size;
+        ++m_chunksSent;
+        m_bytesSent += size;
+    }
+
+    if (all) {
+        m_pendingChunk.clear();
+    } else if (offset > 0) {
+        // Only what can't be sent yet stays, the capacity is kept for the next reads
+        m_pendingChunk.remove(0, offset);
+        m_pendingFrame += offset / m_frameBytes;
+    }
 }
@@ -6,15 +6,35 @@
 #include <QtWebSockets>
 #include "mycroftcontroller.h"
 #include "controllerconfig.h"
+#include "globalsettings.h"
+#include "voiceactivitydetector.h"
 
 #include <QAudioInput>
 
 class AudioRec : public QObject
 {
     Q_OBJECT
+    // True if the current (or last) utterance was streamed while recording
+    Q_PROPERTY(bool streaming READ streaming NOTIFY streamingChanged)
+    // Length of the audio in each binary frame, when streaming
+    Q_PROPERTY(int chunkDuration READ chunkDuration WRITE setChunkDuration NOTIFY chunkDurationChanged)
+    // If true the recording stops by itself once the speech ended, and silence around it is not sent.
+    // Off by default. If speech is never detected, the whole capture is sent
+    Q_PROPERTY(bool voiceActivityDetection READ voiceActivityDetection WRITE setVoiceActivityDetection NOTIFY voiceActivityDetectionChanged)
+    // Milliseconds of silence after which the speech is considered over
+    Q_PROPERTY(int hangover READ hangover WRITE setHangover NOTIFY hangoverChanged)
+
 public:
     explicit AudioRec(QObject *parent = nullptr);
 
+    bool streaming() const;
+    int chunkDuration() const;
+    void setChunkDuration(int duration);
+    bool voiceActivityDetection() const;
+    void setVoiceActivityDetection(bool detection);
+    int hangover() const;
+    void setHangover(int hangover);
+
 public Q_SLOTS:
     void recordTStart();
     void recordTStop();
@@ -25,14 +45,44 @@ public Q_SLOTS:
 Q_SIGNALS:
     void recordTStatus(const QString &recStatus);
     void micAudioLevelChanged(const qreal &micLevel);
+    void streamingChanged();
+    void chunkDurationChanged();
+    void voiceActivityDetectionChanged();
+    void hangoverChanged();
+    void speechStarted();
+    void speechEnded();
 
 private:
+    // Takes what the microphone captured, returns true if the speech just ended
+    bool readDevice();
+    void sendChunks(bool all);
+    // Drops what is captured before frame, from the start of the recording
+    void dropBefore(qint64 frame);
+    // End of what can be sent of the captured audio so far, final when the recording is over
+    qint64 keptEnd(bool final) const;
+    // Whether the silence before the speech can be dropped: not until there is some speech
+    bool speechConfirmed() const;
+
     MycroftController *m_controller;
+    GlobalSettings *m_appSettingObj;
+    bool m_streaming = false;
+    int m_chunkDuration = 100;
+    bool m_recording = false;
+    bool m_voiceActivityDetection = false;
+    VoiceActivityDetector m_detector;
+    QVector<float> m_mono;
+    // Microphone data not sent yet, m_pendingFrame is the position of its start
+    QByteArray m_pendingChunk;
+    qint64 m_pendingFrame = 0;
+    int m_frameBytes = 1;
+    int m_chunkBytes = 0;
+    int m_chunksSent = 0;
+    qint64 m_bytesSent = 0;
     QFile destinationFile;
     QByteArray m_audStream;
     qint16 m_audStream_size;
-    QAudioInput *audio;
-    QIODevice *device;
+    QAudioInput *audio = nullptr;
+    QIODevice *device = nullptr;
 };
 
 #endif // AUDIOREC_H
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "componentcache.h"
+
+#include <QDebug>
+#include <QQmlComponent>
+#include <QQmlEngine>
+
+ComponentCache::ComponentCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ComponentCache::~ComponentCache()
+{
+}
+
+QHash<ComponentCache::Key, ComponentCache::Entry>::iterator ComponentCache::find(const Key &key)
+{
+    auto it = m_entries.find(key);
+
+    // The engine is gone: the key may be the one of a new engine now.
+    // Delegates not deleted yet still release it, it stays with the cache until then
+    if (it != m_entries.end() && !it->engine) {
+        if (it->users == 0) {
+            delete it->component;
+        }
+        m_entries.erase(it);
+        m_recentlyUsed.removeOne(key);
+        return m_entries.end();
+    }
+
+    return it;
+}
+
+QQmlComponent *ComponentCache::acquire(QQmlEngine *engine, const QUrl &url)
+{
+    const Key key(engine, url);
+    auto it = find(key);
+
+    if (it != m_entries.end()) {
+        ++m_hits;
+        ++it->users;
+        m_recentlyUsed.removeOne(key);
+        m_recentlyUsed.prepend(key);
+        return it->component;
+    }
+
+    ++m_misses;
+
+    Entry entry;
+    entry.component = new QQmlComponent(engine, url, this);
+    entry.engine = engine;
+    entry.users = 1;
+    m_entries[key] = entry;
+    m_recentlyUsed.prepend(key);
+
+    evict();
+
+    return entry.component;
+}
+
+void ComponentCache::release(QQmlEngine *engine, const QUrl &url)
+{
+    const Key key(engine, url);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    it->users = qMax(0, it->users - 1);
+
+    // Components which failed to load stay cold, the QML file might get fixed
+    if (it->users == 0 && it->component->isError()) {
+        it->component->deleteLater();
+        m_entries.erase(it);
+        m_recentlyUsed.removeOne(key);
+        return;
+    }
+
+    evict();
+}
+
+void ComponentCache::preload(QQmlEngine *engine, const QUrl &url)
+{
+    const Key key(engine, url);
+    auto it = find(key);
+    if (it != m_entries.end()) {
+        m_recentlyUsed.removeOne(key);
+        m_recentlyUsed.prepend(key);
+        return;
+    }
+
+    ++m_preloads;
+
+    Entry entry;
+    entry.component = new QQmlComponent(engine, url, QQmlComponent::Asynchronous, this);
+    entry.engine = engine;
+    m_entries[key] = entry;
+    m_recentlyUsed.prepend(key);
+
+    evict();
+}
+
+int ComponentCache::capacity() const
+{
+    return m_capacity;
+}
+
+void ComponentCache::setCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    evict();
+}
+
+int ComponentCache::count() const
+{
+    return m_entries.count();
+}
+
+quint64 ComponentCache::hits() const
+{
+    return m_hits;
+}
+
+quint64 ComponentCache::misses() const
+{
+    return m_misses;
+}
+
+quint64 ComponentCache::preloads() const
+{
+    return m_preloads;
+}
+
+void ComponentCache::evict()
+{
+    QList<QPointer<QQmlEngine>> trimmed;
+
+    // Walk from the coldest; components still in use stay, even over capacity
+    for (int i = m_recentlyUsed.count() - 1; i >= 0 && m_entries.count() > m_capacity; --i) {
+        const Key key = m_recentlyUsed[i];
+        auto it = m_entries.find(key);
+        if (it->users > 0) {
+            continue;
+        }
+
+        if (it->engine && !trimmed.contains(it->engine)) {
+            trimmed << it->engine;
+        }
+
+        // Deleted right away, so trimComponentCache below can already release its compiled data
+        delete it->component;
+        m_entries.erase(it);
+        m_recentlyUsed.removeAt(i);
+    }
+
+    // Lets the engines drop the compiled data nobody references anymore
+    for (const auto &engine : trimmed) {
+        if (engine) {
+            engine->trimComponentCache();
+        }
+    }
+}
+
+#include "moc_componentcache.cpp"
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QUrl>
+
+#include <QQmlEngine>
+
+class QQmlComponent;
+
+/**
+ * Compiled QML components of the skill delegates, by engine and url.
+ * Components in use by a DelegateLoader are never evicted, the other ones
+ * are kept until more than capacity() components are cached, starting
+ * from the least recently used one. Showing again a recent skill page
+ * doesn't compile its QML again.
+ *
+ * The budget is a number of components rather than bytes: Qt doesn't tell
+ * how much memory a component, or the object tree built from it, takes.
+ * The other caches of QML objects (DelegatePool, AbstractSkillView::maximumLiveSkills)
+ * are bounded by a count for the same reason.
+ */
+class ComponentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ComponentCache(QObject *parent = nullptr);
+    ~ComponentCache() override;
+
+    /**
+     * @returns the component for url, created in engine if not cached.
+     * Every acquire must be followed by a release with the same engine and url
+     * when the component isn't needed anymore.
+     */
+    QQmlComponent *acquire(QQmlEngine *engine, const QUrl &url);
+    void release(QQmlEngine *engine, const QUrl &url);
+
+    /**
+     * Starts compiling the component for url in the background, if not cached already,
+     * so that a later acquire finds it ready. Doesn't count as a use of the component.
+     */
+    void preload(QQmlEngine *engine, const QUrl &url);
+
+    /**
+     * Maximum number of components kept, in use or not
+     */
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    /**
+     * Number of components currently cached
+     */
+    int count() const;
+
+    /**
+     * How many acquire calls found their component already there, and how many didn't
+     */
+    quint64 hits() const;
+    quint64 misses() const;
+
+    /**
+     * How many components were created by preload
+     */
+    quint64 preloads() const;
+
+private:
+    // Components can't be shared between engines: each has its own entries
+    typedef QPair<QQmlEngine *, QUrl> Key;
+
+    struct Entry {
+        QQmlComponent *component = nullptr;
+        // Only to know the key is stale, an engine can be created again at the same address
+        QPointer<QQmlEngine> engine;
+        int users = 0;
+    };
+
+    // The entry for key, if there is a valid one
+    QHash<Key, Entry>::iterator find(const Key &key);
+    void evict();
+
+    QHash<Key, Entry> m_entries;
+    // Most recently used first
+    QList<Key> m_recentlyUsed;
+    int m_capacity = 32;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_preloads = 0;
+};
+
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "connectionmonitor.h"
+#include "socketconnection.h"
+
+#include <QDebug>
+
+#include <random>
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+#include <QNetworkConfigurationManager>
+#define MYCROFT_GUI_HAVE_NETWORK_WATCHER
+#endif
+
+#ifdef MYCROFT_GUI_HAVE_NETWORK_WATCHER
+// One for all the monitors: it polls the network interfaces on its own
+static QNetworkConfigurationManager *networkWatcher()
+{
+    static QNetworkConfigurationManager *manager = new QNetworkConfigurationManager;
+    return manager;
+}
+#endif
+
+ConnectionMonitor::ConnectionMonitor(SocketConnection *socket, QObject *parent)
+    : QObject(parent),
+      m_socket(socket)
+{
+    m_reconnectTimer.setSingleShot(true);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &ConnectionMonitor::reconnectRequested);
+
+    m_pingTimer.setInterval(5000);
+    connect(&m_pingTimer, &QTimer::timeout, this, [this]() {
+        // Two pings without an answer: the connection is dead even if nobody told us
+        if (m_pendingPings >= 2) {
+            qWarning() << "No pong from the server, closing the connection";
+            m_pingTimer.stop();
+            m_socket->close();
+            scheduleReconnect();
+            return;
+        }
+        ++m_pendingPings;
+        m_socket->ping();
+    });
+
+    connect(m_socket, &SocketConnection::connected, this, [this]() {
+        stop();
+        m_pendingPings = 0;
+        m_pingTimer.start();
+        m_socket->ping();
+    });
+    connect(m_socket, &SocketConnection::disconnected, this, [this]() {
+        m_pingTimer.stop();
+        setRoundTripTime(-1);
+    });
+    connect(m_socket, &SocketConnection::pong, this, [this](quint64 elapsedTime) {
+        m_pendingPings = 0;
+        setRoundTripTime(int(elapsedTime));
+    });
+
+#ifdef MYCROFT_GUI_HAVE_NETWORK_WATCHER
+    connect(networkWatcher(), &QNetworkConfigurationManager::onlineStateChanged, this, [this](bool online) {
+        if (online) {
+            onNetworkOnline();
+        }
+    });
+#endif
+}
+
+ConnectionMonitor::~ConnectionMonitor()
+{
+}
+
+void ConnectionMonitor::scheduleReconnect()
+{
+    if (m_reconnectTimer.isActive()) {
+        return;
+    }
+
+    m_reconnectTimer.start(backoffDelay(m_attempts, m_minimumDelay, m_maximumDelay));
+    ++m_attempts;
+}
+
+void ConnectionMonitor::stop()
+{
+    m_reconnectTimer.stop();
+    m_attempts = 0;
+}
+
+bool ConnectionMonitor::isReconnecting() const
+{
+    return m_reconnectTimer.isActive();
+}
+
+int ConnectionMonitor::roundTripTime() const
+{
+    return m_roundTripTime;
+}
+
+int ConnectionMonitor::backoffDelay(int attempt, int minimum, int maximum)
+{
+    static std::mt19937 generator{std::random_device{}()};
+
+    // Stop doubling long before overflowing
+    qint64 delay = qint64(minimum) << qBound(0, attempt, 20);
+    delay = qMin(delay, qint64(maximum));
+
+    std::uniform_int_distribution<qint64> distribution(delay / 2, delay);
+    return int(distribution(generator));
+}
+
+void ConnectionMonitor::setMinimumDelay(int delay)
+{
+    m_minimumDelay = qMax(1, delay);
+}
+
+void ConnectionMonitor::setMaximumDelay(int delay)
+{
+    m_maximumDelay = qMax(m_minimumDelay, delay);
+}
+
+void ConnectionMonitor::setPingInterval(int interval)
+{
+    m_pingTimer.setInterval(qMax(1, interval));
+}
+
+void ConnectionMonitor::setRoundTripTime(int rtt)
+{
+    if (m_roundTripTime == rtt) {
+        return;
+    }
+
+    m_roundTripTime = rtt;
+    emit roundTripTimeChanged();
+}
+
+void ConnectionMonitor::onNetworkOnline()
+{
+    // No point in waiting the backoff, the reason of the failures is likely gone
+    if (!m_reconnectTimer.isActive()) {
+        return;
+    }
+
+    m_reconnectTimer.stop();
+    m_attempts = 0;
+    emit reconnectRequested();
+}
+
+#include "moc_connectionmonitor.cpp"
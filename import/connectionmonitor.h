@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+class SocketConnection;
+
+/**
+ * Keeps a SocketConnection alive: reconnection attempts get further apart
+ * each time, with some randomness so many clients of the same core don't
+ * all retry together, and start right away when the network comes back.
+ * While connected, the socket is pinged to measure the round trip time and
+ * to notice dead connections the operating system didn't report.
+ */
+class ConnectionMonitor : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * Last measured round trip time in milliseconds, -1 when not connected
+     */
+    Q_PROPERTY(int roundTripTime READ roundTripTime NOTIFY roundTripTimeChanged)
+
+public:
+    explicit ConnectionMonitor(SocketConnection *socket, QObject *parent = nullptr);
+    ~ConnectionMonitor() override;
+
+    /**
+     * Emits reconnectRequested after a delay growing with every attempt,
+     * does nothing if an attempt is already scheduled
+     */
+    void scheduleReconnect();
+
+    /**
+     * Cancels the scheduled attempt and starts counting again from the minimum delay
+     */
+    void stop();
+
+    bool isReconnecting() const;
+
+    int roundTripTime() const;
+
+    /**
+     * Delay before a reconnection: doubles at each attempt from minimum up to maximum,
+     * and is then randomized between half and all of it
+     */
+    static int backoffDelay(int attempt, int minimum, int maximum);
+
+    void setMinimumDelay(int delay);
+    void setMaximumDelay(int delay);
+    void setPingInterval(int interval);
+
+Q_SIGNALS:
+    void reconnectRequested();
+    void roundTripTimeChanged();
+
+private:
+    void setRoundTripTime(int rtt);
+    void onNetworkOnline();
+
+    SocketConnection *m_socket;
+    QTimer m_reconnectTimer;
+    QTimer m_pingTimer;
+    int m_attempts = 0;
+    int m_minimumDelay = 1000;
+    int m_maximumDelay = 60000;
+    // Pings sent without a pong
+    int m_pendingPings = 0;
+    int m_roundTripTime = -1;
+};
+
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "delegateincubator.h"
+#include "abstractdelegate.h"
+
+#include <QQmlEngine>
+
+DelegateIncubator::DelegateIncubator(DelegateLoader *loader)
+    : QQmlIncubator(QQmlIncubator::Asynchronous),
+      m_loader(loader)
+{
+}
+
+DelegateIncubator::~DelegateIncubator()
+{
+}
+
+void DelegateIncubator::setInitialState(QObject *object)
+{
+    m_loader->setupObject(object);
+}
+
+void DelegateIncubator::statusChanged(Status status)
+{
+    if (status == QQmlIncubator::Ready || status == QQmlIncubator::Error) {
+        m_loader->incubationFinished();
+    }
+}
+
+//////////////////////////////////////////
+
+IncubationController::IncubationController(QObject *parent)
+    : QObject(parent)
+{
+    m_frameTimer.setInterval(16);
+    connect(&m_frameTimer, &QTimer::timeout, this, [this]() {
+        incubateFor(m_budget);
+    });
+}
+
+IncubationController::~IncubationController()
+{
+}
+
+void IncubationController::ensureController(QQmlEngine *engine)
+{
+    // QQuickView installs the controller of its window, which already follows the frames
+    if (!engine || engine->incubationController()) {
+        return;
+    }
+
+    engine->setIncubationController(new IncubationController(engine));
+}
+
+int IncubationController::budget() const
+{
+    return m_budget;
+}
+
+void IncubationController::setBudget(int budget)
+{
+    m_budget = qMax(1, budget);
+}
+
+void IncubationController::incubatingObjectCountChanged(int count)
+{
+    if (count > 0 && !m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    } else if (count == 0) {
+        m_frameTimer.stop();
+    }
+}
+
+#include "moc_delegateincubator.cpp"
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QQmlIncubator>
+#include <QTimer>
+
+class QQmlEngine;
+class DelegateLoader;
+
+/**
+ * @internal Creates the object of a DelegateLoader asynchronously,
+ * a bit for each frame, so a heavy skill page doesn't block the rendering.
+ */
+class DelegateIncubator : public QQmlIncubator
+{
+public:
+    explicit DelegateIncubator(DelegateLoader *loader);
+    ~DelegateIncubator();
+
+protected:
+    void setInitialState(QObject *object) override;
+    void statusChanged(Status status) override;
+
+private:
+    DelegateLoader *m_loader;
+};
+
+/**
+ * @internal Drives the incubation for engines which don't have a window
+ * doing it already: incubates for at most budget() milliseconds each frame.
+ */
+class IncubationController : public QObject, public QQmlIncubationController
+{
+    Q_OBJECT
+
+public:
+    explicit IncubationController(QObject *parent = nullptr);
+    ~IncubationController() override;
+
+    /**
+     * Installs an IncubationController on engine, unless it has one already
+     */
+    static void ensureController(QQmlEngine *engine);
+
+    /**
+     * Milliseconds per frame spent creating objects
+     */
+    int budget() const;
+    void setBudget(int budget);
+
+protected:
+    void incubatingObjectCountChanged(int count) override;
+
+private:
+    QTimer m_frameTimer;
+    int m_budget = 5;
+};
+
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "delegatepool.h"
+#include "abstractdelegate.h"
+
+DelegatePool::DelegatePool(QObject *parent)
+    : QObject(parent)
+{
+}
+
+DelegatePool::~DelegatePool()
+{
+    clear();
+}
+
+void DelegatePool::park(DelegateLoader *loader)
+{
+    if (!loader || m_parked.contains(loader)) {
+        return;
+    }
+
+    AbstractDelegate *delegate = loader->delegate();
+    if (!delegate || m_capacity == 0) {
+        loader->deleteLater();
+        return;
+    }
+
+    // Out of the visual tree and of the events routing until it's taken again
+    loader->setFocus(false);
+    delegate->setParentItem(nullptr);
+    delegate->setSkillView(nullptr);
+
+    // The delegate could still be deleted by someone else while parked, which deletes the loader too
+    connect(loader, &QObject::destroyed, this, [this](QObject *obj) {
+        m_parked.removeAll(static_cast<DelegateLoader *>(obj));
+    });
+
+    m_parked << loader;
+    evict();
+}
+
+DelegateLoader *DelegatePool::take(const QString &skillId, const QUrl &url)
+{
+    for (int i = m_parked.count() - 1; i >= 0; --i) {
+        DelegateLoader *loader = m_parked[i];
+        AbstractDelegate *delegate = loader->delegate();
+
+        if (delegate && delegate->skillId() == skillId && delegate->qmlUrl() == url) {
+            m_parked.removeAt(i);
+            disconnect(loader, nullptr, this, nullptr);
+            ++m_hits;
+            return loader;
+        }
+    }
+
+    ++m_misses;
+    return nullptr;
+}
+
+void DelegatePool::clear()
+{
+    for (auto loader : m_parked) {
+        disconnect(loader, nullptr, this, nullptr);
+        loader->deleteLater();
+    }
+    m_parked.clear();
+}
+
+int DelegatePool::capacity() const
+{
+    return m_capacity;
+}
+
+void DelegatePool::setCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    evict();
+}
+
+int DelegatePool::count() const
+{
+    return m_parked.count();
+}
+
+quint64 DelegatePool::hits() const
+{
+    return m_hits;
+}
+
+quint64 DelegatePool::misses() const
+{
+    return m_misses;
+}
+
+void DelegatePool::evict()
+{
+    while (m_parked.count() > m_capacity) {
+        DelegateLoader *loader = m_parked.takeFirst();
+        disconnect(loader, nullptr, this, nullptr);
+        loader->deleteLater();
+    }
+}
+
+#include "moc_delegatepool.cpp"
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QUrl>
+
+class DelegateLoader;
+
+/**
+ * Delegates removed from a DelegatesModel, kept aside to be shown again.
+ * Skills often show the same page again shortly after removing it (idle screens, timeouts),
+ * taking it from here means just reparenting it instead of building its whole object tree.
+ * Parked delegates are detached from the view and don't receive events,
+ * the oldest ones get deleted when more than capacity() are parked.
+ */
+class DelegatePool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DelegatePool(QObject *parent = nullptr);
+    ~DelegatePool() override;
+
+    /**
+     * Parks a loader no model uses anymore, with its delegate
+     */
+    void park(DelegateLoader *loader);
+
+    /**
+     * @returns a parked loader for the given skill and url, removed from the pool,
+     * nullptr if there is none
+     */
+    DelegateLoader *take(const QString &skillId, const QUrl &url);
+
+    /**
+     * Deletes all the parked loaders
+     */
+    void clear();
+
+    /**
+     * Maximum number of parked loaders, a count as explained in ComponentCache
+     */
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    /**
+     * Number of loaders currently parked
+     */
+    int count() const;
+
+    /**
+     * How many take calls found a parked loader, and how many didn't
+     */
+    quint64 hits() const;
+    quint64 misses() const;
+
+private:
+    void evict();
+
+    // Oldest parked first
+    QList<DelegateLoader *> m_parked;
+    int m_capacity = 8;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
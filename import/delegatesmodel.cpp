@@ -28,9 +28,11 @@ DelegatesModel::DelegatesModel(QObject *parent)
     m_deleteTimer->setSingleShot(true);
     m_deleteTimer->setInterval(2000);
 
+    // Removed delegates may still be animating out, they're given up only after a while
     connect(m_deleteTimer, &QTimer::timeout, this, [this]() {
         for (auto d : m_delegateLoadersToDelete) {
-            d->deleteLater();
+            disconnect(d, nullptr, this, nullptr);
+            d->recycle();
         }
         m_delegateLoadersToDelete.clear();
     });
@@ -58,10 +60,13 @@ void DelegatesModel::insertDelegateLoaders(int position, QList<DelegateLoader *>
     int i = 0;
     for (auto *loader : loaders) {
         m_delegateLoaders.insert(position + i, loader);
-        if (!loader->delegate()) {
-            connect(loader, &DelegateLoader::delegateCreated, this, [this, loader]() {
+        if (loader->isLoading()) {
+            // The delegate object gets created asynchronously, after the row is already there
+            connect(loader, &DelegateLoader::loadingChanged, this, [this, loader]() {
                 int row = m_delegateLoaders.indexOf(loader);
-                emit dataChanged(index(row, 0), index(row, 0), {DelegateUi});
+                if (row > -1) {
+                    emit dataChanged(index(row, 0), index(row, 0), {DelegateUi, DelegateLoading});
+                }
             });
         }
         connect(loader, &QObject::destroyed, this, [this](QObject *obj) {
@@ -84,6 +89,7 @@ void DelegatesModel::clear()
 {
     
     beginResetModel();
+    detachDelegates(0, m_delegateLoaders.count());
     m_delegateLoadersToDelete = m_delegateLoaders;
     m_deleteTimer->start();
     m_delegateLoaders.clear();
@@ -103,6 +109,43 @@ QList<AbstractDelegate *> DelegatesModel::delegates() const
     return delegates;
 }
 
+QList<DelegateLoader *> DelegatesModel::delegateLoaders() const
+{
+    return m_delegateLoaders;
+}
+
+QList<QUrl> DelegatesModel::delegateUrls() const
+{
+    QList<QUrl> urls;
+
+    for (auto c : m_delegateLoaders) {
+        urls << c->url();
+    }
+
+    return urls;
+}
+
+DelegateLoader *DelegatesModel::takeRemovedLoader(const QUrl &url)
+{
+    for (int i = m_delegateLoadersToDelete.count() - 1; i >= 0; --i) {
+        DelegateLoader *loader = m_delegateLoadersToDelete[i];
+
+        if (loader->delegate() && loader->url() == url) {
+            m_delegateLoadersToDelete.removeAt(i);
+            // insertDelegateLoaders connects it again
+            disconnect(loader, nullptr, this, nullptr);
+            return loader;
+        }
+    }
+
+    return nullptr;
+}
+
+int DelegatesModel::currentIndex() const
+{
+    return m_currentIndex;
+}
+
 bool DelegatesModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationChild)
 {
     if (sourceParent.isValid() || destinationParent.isValid()) {
@@ -141,6 +184,7 @@ bool DelegatesModel::removeRows(int row, int count, const QModelIndex &parent)
     }
 
     beginRemoveRows(parent, row, row + count - 1);
+    detachDelegates(row, count);
     std::copy(m_delegateLoaders.begin() + row, m_delegateLoaders.begin() + row + count,
               std::back_inserter(m_delegateLoadersToDelete));
     m_deleteTimer->start();
@@ -151,6 +195,16 @@ bool DelegatesModel::removeRows(int row, int count, const QModelIndex &parent)
 }
 
 
+void DelegatesModel::detachDelegates(int row, int count)
+{
+    for (int i = row; i < row + count; ++i) {
+        // Taken back from the pool, DelegateLoader::rebind attaches it again
+        if (AbstractDelegate *delegate = m_delegateLoaders[i]->delegate()) {
+            delegate->setSkillView(nullptr);
+        }
+    }
+}
+
 int DelegatesModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid()) {
@@ -166,17 +220,25 @@ QVariant DelegatesModel::data(const QModelIndex &index, int role) const
     }
     const int row = index.row();
 
-    if (row < 0 || row >= m_delegateLoaders.count() || role != DelegateUi) {
+    if (row < 0 || row >= m_delegateLoaders.count()) {
         return QVariant();
     }
 
-    return QVariant::fromValue(m_delegateLoaders[row]->delegate());
+    switch (role) {
+    case DelegateUi:
+        return QVariant::fromValue(m_delegateLoaders[row]->delegate());
+    case DelegateLoading:
+        return m_delegateLoaders[row]->isLoading();
+    default:
+        return QVariant();
+    }
 }
 
 QHash<int, QByteArray> DelegatesModel::roleNames() const
 {
     return {
-        {DelegateUi, "delegateUi"}
+        {DelegateUi, "delegateUi"},
+        {DelegateLoading, "delegateLoading"}
     };
 }
 
@@ -33,7 +33,8 @@ class DelegatesModel : public QAbstractListModel
 
 public:
     enum Roles {
-        DelegateUi = Qt::UserRole + 1
+        DelegateUi = Qt::UserRole + 1,
+        DelegateLoading // true while the delegate is still being created
     };
 
     explicit DelegatesModel(QObject *parent = nullptr);
@@ -54,6 +55,24 @@ public:
      */
     QList<AbstractDelegate *> delegates() const;
 
+    /**
+     * @returns the loaders of all the rows, in order
+     */
+    QList<DelegateLoader *> delegateLoaders() const;
+
+    /**
+     * @returns the urls of all the rows, in order
+     */
+    QList<QUrl> delegateUrls() const;
+
+    /**
+     * Takes back a removed loader for url that is still animating out, before it goes
+     * to the DelegatePool. nullptr if there is none
+     */
+    DelegateLoader *takeRemovedLoader(const QUrl &url);
+
+    int currentIndex() const;
+
     bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationChild) override;
     bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -64,6 +83,9 @@ Q_SIGNALS:
     void currentIndexChanged();
 
 private:
+    // Removed rows may still be animating out: they don't get the events of the skill anymore
+    void detachDelegates(int row, int count);
+
     QList<DelegateLoader *> m_delegateLoaders;
     QList<DelegateLoader *> m_delegateLoadersToDelete;
     QTimer *m_deleteTimer;
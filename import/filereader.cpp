@@ -16,6 +16,7 @@
  */
 
 #include "filereader.h"
+#include "fileworker.h"
 #include <QFile>
 #include <QDir>
 #include <QDebug>
@@ -26,6 +27,42 @@
 FileReader::FileReader(QObject *parent) 
     : QObject(parent)
 {
+    m_thread.setObjectName(QStringLiteral("MycroftFileReader"));
+
+    m_worker = new FileWorker;
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &FileWorker::fileRead, this, &FileReader::onFileRead);
+
+    m_thread.start();
+}
+
+FileReader::~FileReader()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void FileReader::readAsync(const QString &filename, const QJSValue &callback)
+{
+    if (!callback.isCallable()) {
+        qWarning() << "FileReader.readAsync needs a function to call with the content of" << filename;
+        return;
+    }
+
+    const int request = m_nextRequest++;
+    m_callbacks.insert(request, callback);
+    QMetaObject::invokeMethod(m_worker, "readFile", Qt::QueuedConnection, Q_ARG(int, request), Q_ARG(QString, filename));
+}
+
+void FileReader::onFileRead(int request, const QByteArray &data, bool ok)
+{
+    QJSValue callback = m_callbacks.take(request);
+
+    const QJSValue result = callback.call(QJSValueList({QJSValue(QString::fromUtf8(data)), QJSValue(ok)}));
+    if (result.isError()) {
+        qWarning() << "Error in the FileReader.readAsync callback:" << result.toString();
+    }
 }
 
 QByteArray FileReader::read(const QString &filename)
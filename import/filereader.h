@@ -21,8 +21,13 @@
 #include <QObject>
 #include <QStringList>
 #include <QDir>
+#include <QHash>
+#include <QJSValue>
 #include <QTextStream>
 #include <QDataStream>
+#include <QThread>
+
+class FileWorker;
 
 class FileReader : public QObject
 {
@@ -30,11 +35,27 @@ class FileReader : public QObject
 
 public:
     explicit FileReader(QObject *parent = Q_NULLPTR);
-    
+    ~FileReader() override;
+
+    /**
+     * Reads filename in a thread, then calls callback with its content as a string
+     * and whether it could be read. Unlike read() the gui goes on meanwhile.
+     */
+    Q_INVOKABLE void readAsync(const QString &filename, const QJSValue &callback);
+
 public Q_SLOTS:
     QByteArray read(const QString &filename);
     bool file_exists_local(const QString &filename);
+    // Blocks on the disk for every subdirectory: SkillIndex does the same in a thread, and follows the changes
     QStringList checkForMeta(const QString &rootDir, const QString &findFile);
+
+private:
+    void onFileRead(int request, const QByteArray &data, bool ok);
+
+    QThread m_thread;
+    FileWorker *m_worker;
+    QHash<int, QJSValue> m_callbacks;
+    int m_nextRequest = 0;
 };
 
 #endif // FILEREADER_H
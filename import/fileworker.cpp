@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fileworker.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#include <algorithm>
+
+FileWorker::FileWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+FileWorker::~FileWorker()
+{
+}
+
+void FileWorker::scanSkills(const QString &rootPath, const QString &metaFile)
+{
+    QVector<SkillIndexEntry> entries;
+    QHash<QString, SkillIndexEntry> known;
+    QStringList directories;
+
+    const QFileInfoList dirs = QDir(rootPath).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto &dir : dirs) {
+        directories << dir.absoluteFilePath();
+
+        const QFileInfo meta(dir.absoluteFilePath() + QLatin1Char('/') + metaFile);
+        if (!meta.isFile()) {
+            continue;
+        }
+
+        SkillIndexEntry entry = m_entries.value(meta.absoluteFilePath());
+
+        // Unchanged since last time: not read again
+        if (entry.metaPath.isEmpty() || entry.modified != meta.lastModified() || entry.size != meta.size()) {
+            QFile file(meta.absoluteFilePath());
+            if (!file.open(QIODevice::ReadOnly)) {
+                qWarning() << "Can't read" << meta.absoluteFilePath() << file.errorString();
+                continue;
+            }
+
+            entry.path = dir.absoluteFilePath();
+            entry.name = dir.fileName();
+            entry.metaPath = meta.absoluteFilePath();
+            entry.modified = meta.lastModified();
+            entry.size = meta.size();
+            entry.content = file.readAll();
+        }
+
+        known.insert(entry.metaPath, entry);
+        entries << entry;
+    }
+
+    // Skills gone meanwhile are forgotten
+    m_entries = known;
+
+    std::sort(entries.begin(), entries.end(), [](const SkillIndexEntry &a, const SkillIndexEntry &b) {
+        return a.path < b.path;
+    });
+
+    emit skillsScanned(rootPath, entries, directories);
+}
+
+void FileWorker::readFile(int request, const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't read" << fileName << file.errorString();
+        emit fileRead(request, QByteArray(), false);
+        return;
+    }
+
+    emit fileRead(request, file.readAll(), true);
+}
+
+void FileWorker::writeSettings(const QVariantHash &values)
+{
+    QSettings settings;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        settings.setValue(it.key(), it.value());
+    }
+
+    settings.sync();
+    emit settingsWritten(settings.fileName(), settings.status() == QSettings::NoError);
+}
+
+#include "moc_fileworker.cpp"
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QVariant>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * A skill directory containing the metadata file looked for
+ */
+struct SkillIndexEntry
+{
+    QString path;
+    // Name of the directory, the skill id for skills installed by msm
+    QString name;
+    QString metaPath;
+    QDateTime modified;
+    qint64 size = 0;
+    QByteArray content;
+};
+Q_DECLARE_METATYPE(SkillIndexEntry)
+Q_DECLARE_METATYPE(QVector<SkillIndexEntry>)
+
+/**
+ * @internal Does the file system work of SkillIndex, FileReader and SettingsStore.
+ * Lives in a thread of its own and is only ever talked to with
+ * queued signals and slots.
+ */
+class FileWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileWorker(QObject *parent = nullptr);
+    ~FileWorker() override;
+
+public Q_SLOTS:
+    /**
+     * Lists the directories of rootPath containing metaFile, sorted by path.
+     * Only the metadata files changed since the previous scan are read again.
+     */
+    void scanSkills(const QString &rootPath, const QString &metaFile);
+
+    void readFile(int request, const QString &fileName);
+
+    // Writes values in the application settings file
+    void writeSettings(const QVariantHash &values);
+
+Q_SIGNALS:
+    // directories are all the subdirectories of rootPath, with or without metaFile
+    void skillsScanned(const QString &rootPath, const QVector<SkillIndexEntry> &entries, const QStringList &directories);
+    void fileRead(int request, const QByteArray &data, bool ok);
+    void settingsWritten(const QString &fileName, bool ok);
+
+private:
+    // By path of the metadata file
+    QHash<QString, SkillIndexEntry> m_entries;
+};
+
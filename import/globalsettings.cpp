@@ -17,17 +17,43 @@
 
 #include <QDebug>
 #include <QFile>
+#include <QMetaProperty>
 #include "globalsettings.h"
 #include "controllerconfig.h"
 
 GlobalSettings::GlobalSettings(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_store(SettingsStore::instance())
 {
+    m_usesRemoteTTS = m_store->value(QStringLiteral("usesRemoteTTS"), false).toBool();
+    m_useHivemindProtocol = m_store->value(QStringLiteral("useHivemindProtocol"), false).toBool();
+
+    connect(m_store, &SettingsStore::valueChanged, this, &GlobalSettings::onValueChanged);
+}
+
+void GlobalSettings::onValueChanged(const QString &key)
+{
+    if (key == QLatin1String("usesRemoteTTS")) {
+        m_usesRemoteTTS = m_store->value(key, false).toBool();
+    } else if (key == QLatin1String("useHivemindProtocol")) {
+        m_useHivemindProtocol = m_store->value(key, false).toBool();
+    }
+
+    // The properties are named as their keys
+    const int index = metaObject()->indexOfProperty(key.toLatin1().constData());
+    if (index < 0) {
+        return;
+    }
+
+    const QMetaProperty property = metaObject()->property(index);
+    if (property.hasNotifySignal()) {
+        property.notifySignal().invoke(this, Qt::DirectConnection);
+    }
 }
 
 bool GlobalSettings::autoConnect() const
 {
-    return m_settings.value(QStringLiteral("autoConnect"), true).toBool();
+    return m_store->value(QStringLiteral("autoConnect"), true).toBool();
 }
 
 void GlobalSettings::setAutoConnect(bool autoConnect)
@@ -36,13 +62,12 @@ void GlobalSettings::setAutoConnect(bool autoConnect)
         return;
     }
 
-    m_settings.setValue(QStringLiteral("autoConnect"), autoConnect);
-    emit autoConnectChanged();
+    m_store->setValue(QStringLiteral("autoConnect"), autoConnect);
 }
 
 bool GlobalSettings::usesRemoteTTS() const
 {
-    return m_settings.value(QStringLiteral("usesRemoteTTS"), false).toBool();
+    return m_usesRemoteTTS;
 }
 
 void GlobalSettings::setUsesRemoteTTS(bool usesRemoteTTS)
@@ -51,16 +76,15 @@ void GlobalSettings::setUsesRemoteTTS(bool usesRemoteTTS)
         return;
     }
 
-    m_settings.setValue(QStringLiteral("usesRemoteTTS"), usesRemoteTTS);
-    emit usesRemoteTTSChanged();
+    m_store->setValue(QStringLiteral("usesRemoteTTS"), usesRemoteTTS);
 }
 
 bool GlobalSettings::displayRemoteConfig() const
 {
 #ifndef Q_OS_ANDROID
-    return m_settings.value(QStringLiteral("displayRemoteConfig"), true).toBool();
+    return m_store->value(QStringLiteral("displayRemoteConfig"), true).toBool();
 #else
-    return m_settings.value(QStringLiteral("displayRemoteConfig"), false).toBool();
+    return m_store->value(QStringLiteral("displayRemoteConfig"), false).toBool();
 #endif
 }
 
@@ -70,13 +94,12 @@ void GlobalSettings::setDisplayRemoteConfig(bool displayRemoteConfig)
         return;
     }
 
-    m_settings.setValue(QStringLiteral("displayRemoteConfig"), displayRemoteConfig);
-    emit displayRemoteConfigChanged();
+    m_store->setValue(QStringLiteral("displayRemoteConfig"), displayRemoteConfig);
 }
 
 bool GlobalSettings::usePTTClient() const
 {
-    return m_settings.value(QStringLiteral("usePTTClient"), false).toBool();
+    return m_store->value(QStringLiteral("usePTTClient"), false).toBool();
 }
 
 void GlobalSettings::setUsePTTClient(bool usePTTClient)
@@ -85,13 +108,12 @@ void GlobalSettings::setUsePTTClient(bool usePTTClient)
         return;
     }
 
-    m_settings.setValue(QStringLiteral("usePTTClient"), usePTTClient);
-    emit usePTTClientChanged();
+    m_store->setValue(QStringLiteral("usePTTClient"), usePTTClient);
 }
 
 bool GlobalSettings::useHivemindProtocol() const
 {
-    return m_settings.value(QStringLiteral("useHivemindProtocol"), false).toBool();
+    return m_useHivemindProtocol;
 }
 
 void GlobalSettings::setUseHivemindProtocol(bool useHivemindProtocol)
@@ -100,6 +122,89 @@ void GlobalSettings::setUseHivemindProtocol(bool useHivemindProtocol)
         return;
     }
 
-    m_settings.setValue(QStringLiteral("useHivemindProtocol"), useHivemindProtocol);
-    emit useHivemindProtocolChanged();
+    m_store->setValue(QStringLiteral("useHivemindProtocol"), useHivemindProtocol);
+}
+
+bool GlobalSettings::sharedGuiConnection() const
+{
+    return m_store->value(QStringLiteral("sharedGuiConnection"), false).toBool();
+}
+
+void GlobalSettings::setSharedGuiConnection(bool sharedGuiConnection)
+{
+    if (GlobalSettings::sharedGuiConnection() == sharedGuiConnection) {
+        return;
+    }
+
+    m_store->setValue(QStringLiteral("sharedGuiConnection"), sharedGuiConnection);
+}
+
+bool GlobalSettings::streamMicrophone() const
+{
+    return m_store->value(QStringLiteral("streamMicrophone"), false).toBool();
+}
+
+void GlobalSettings::setStreamMicrophone(bool streamMicrophone)
+{
+    if (GlobalSettings::streamMicrophone() == streamMicrophone) {
+        return;
+    }
+
+    m_store->setValue(QStringLiteral("streamMicrophone"), streamMicrophone);
+}
+
+int GlobalSettings::ttsCacheSize() const
+{
+    return m_store->value(QStringLiteral("ttsCacheSize"), 8).toInt();
+}
+
+void GlobalSettings::setTtsCacheSize(int ttsCacheSize)
+{
+    if (GlobalSettings::ttsCacheSize() == ttsCacheSize) {
+        return;
+    }
+
+    m_store->setValue(QStringLiteral("ttsCacheSize"), ttsCacheSize);
+}
+
+bool GlobalSettings::ttsCacheOnDisk() const
+{
+    return m_store->value(QStringLiteral("ttsCacheOnDisk"), false).toBool();
+}
+
+void GlobalSettings::setTtsCacheOnDisk(bool ttsCacheOnDisk)
+{
+    if (GlobalSettings::ttsCacheOnDisk() == ttsCacheOnDisk) {
+        return;
+    }
+
+    m_store->setValue(QStringLiteral("ttsCacheOnDisk"), ttsCacheOnDisk);
+}
+
+bool GlobalSettings::sessionSnapshot() const
+{
+    return m_store->value(QStringLiteral("sessionSnapshot"), false).toBool();
+}
+
+void GlobalSettings::setSessionSnapshot(bool sessionSnapshot)
+{
+    if (GlobalSettings::sessionSnapshot() == sessionSnapshot) {
+        return;
+    }
+
+    m_store->setValue(QStringLiteral("sessionSnapshot"), sessionSnapshot);
+}
+
+bool GlobalSettings::hardwareVideoDecoders() const
+{
+    return m_store->value(QStringLiteral("hardwareVideoDecoders"), false).toBool();
+}
+
+void GlobalSettings::setHardwareVideoDecoders(bool hardwareVideoDecoders)
+{
+    if (GlobalSettings::hardwareVideoDecoders() == hardwareVideoDecoders) {
+        return;
+    }
+
+    m_store->setValue(QStringLiteral("hardwareVideoDecoders"), hardwareVideoDecoders);
 }
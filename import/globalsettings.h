@@ -18,15 +18,20 @@
 #ifndef GLOBALSETTINGS_H
 #define GLOBALSETTINGS_H
 
-#include <QSettings>
 #include <QCoreApplication>
 #include <QDebug>
 
+#include "settingsstore.h"
+
+// The notify signal is emitted by onValueChanged, for all the instances
 #define SettingPropertyKey(type, name, setOption, signalName, settingKey, defaultValue) \
-    inline type name() const { return m_settings.value(settingKey, defaultValue).value<type>(); } \
-    inline void setOption (const type &value) { m_settings.setValue(settingKey, value); emit signalName(); qDebug() << "emitted"; }
+    inline type name() const { return m_store->value(settingKey, defaultValue).value<type>(); } \
+    inline void setOption (const type &value) { m_store->setValue(settingKey, value); }
 
-class QSettings;
+/**
+ * The settings, as properties. All the instances share the same values,
+ * see SettingsStore, and all get the change notifications.
+ */
 class GlobalSettings : public QObject
 {
     Q_OBJECT
@@ -36,6 +41,12 @@ class GlobalSettings : public QObject
     Q_PROPERTY(bool displayRemoteConfig READ displayRemoteConfig WRITE setDisplayRemoteConfig NOTIFY displayRemoteConfigChanged)
     Q_PROPERTY(bool usePTTClient READ usePTTClient WRITE setUsePTTClient NOTIFY usePTTClient)
     Q_PROPERTY(bool useHivemindProtocol READ useHivemindProtocol WRITE setUseHivemindProtocol NOTIFY useHivemindProtocolChanged)
+    Q_PROPERTY(bool sharedGuiConnection READ sharedGuiConnection WRITE setSharedGuiConnection NOTIFY sharedGuiConnectionChanged)
+    Q_PROPERTY(bool streamMicrophone READ streamMicrophone WRITE setStreamMicrophone NOTIFY streamMicrophoneChanged)
+    Q_PROPERTY(int ttsCacheSize READ ttsCacheSize WRITE setTtsCacheSize NOTIFY ttsCacheSizeChanged)
+    Q_PROPERTY(bool ttsCacheOnDisk READ ttsCacheOnDisk WRITE setTtsCacheOnDisk NOTIFY ttsCacheOnDiskChanged)
+    Q_PROPERTY(bool sessionSnapshot READ sessionSnapshot WRITE setSessionSnapshot NOTIFY sessionSnapshotChanged)
+    Q_PROPERTY(bool hardwareVideoDecoders READ hardwareVideoDecoders WRITE setHardwareVideoDecoders NOTIFY hardwareVideoDecodersChanged)
 
 public:
     explicit GlobalSettings(QObject *parent=0);
@@ -55,6 +66,24 @@ public:
     void setUsePTTClient(bool usePttClient);
     bool useHivemindProtocol() const;
     void setUseHivemindProtocol(bool useHivemindProtocol);
+    bool sharedGuiConnection() const;
+    void setSharedGuiConnection(bool sharedGuiConnection);
+    bool streamMicrophone() const;
+    void setStreamMicrophone(bool streamMicrophone);
+    // In MiB, used from the next start
+    int ttsCacheSize() const;
+    void setTtsCacheSize(int ttsCacheSize);
+    bool ttsCacheOnDisk() const;
+    void setTtsCacheOnDisk(bool ttsCacheOnDisk);
+    bool sessionSnapshot() const;
+    void setSessionSnapshot(bool sessionSnapshot);
+    // Prefer the hardware video decoders GStreamer ranks low, used from the next start
+    bool hardwareVideoDecoders() const;
+    void setHardwareVideoDecoders(bool hardwareVideoDecoders);
+
+private Q_SLOTS:
+    // Emits the notify signal of the property named key
+    void onValueChanged(const QString &key);
 
 Q_SIGNALS:
     void webSocketChanged();
@@ -63,9 +92,18 @@ Q_SIGNALS:
     void displayRemoteConfigChanged();
     void usePTTClientChanged();
     void useHivemindProtocolChanged();
+    void sharedGuiConnectionChanged();
+    void streamMicrophoneChanged();
+    void ttsCacheSizeChanged();
+    void ttsCacheOnDiskChanged();
+    void sessionSnapshotChanged();
+    void hardwareVideoDecodersChanged();
 
 private:
-    QSettings m_settings;
+    SettingsStore *m_store;
+    // Read for every message, not worth even a lookup in the store
+    bool m_usesRemoteTTS;
+    bool m_useHivemindProtocol;
 };
 
 #endif // GLOBALSETTINGS_H
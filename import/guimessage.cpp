@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "guimessage.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#ifdef MYCROFT_GUI_HAVE_CBOR
+#include <QCborMap>
+#include <QCborValue>
+#endif
+
+static const QHash<QString, GuiMessage::Type> &messageTypes()
+{
+    static const QHash<QString, GuiMessage::Type> types({
+        {QStringLiteral("mycroft.session.set"), GuiMessage::SessionSet},
+        {QStringLiteral("mycroft.session.delete"), GuiMessage::SessionDelete},
+        {QStringLiteral("mycroft.session.patch"), GuiMessage::SessionPatch},
+        {QStringLiteral("mycroft.gui.list.insert"), GuiMessage::GuiListInsert},
+        {QStringLiteral("mycroft.gui.list.remove"), GuiMessage::GuiListRemove},
+        {QStringLiteral("mycroft.gui.list.move"), GuiMessage::GuiListMove},
+        {QStringLiteral("mycroft.session.list.insert"), GuiMessage::SessionListInsert},
+        {QStringLiteral("mycroft.session.list.update"), GuiMessage::SessionListUpdate},
+        {QStringLiteral("mycroft.session.list.move"), GuiMessage::SessionListMove},
+        {QStringLiteral("mycroft.session.list.remove"), GuiMessage::SessionListRemove},
+        {QStringLiteral("mycroft.session.list.paged"), GuiMessage::SessionListPaged},
+        {QStringLiteral("mycroft.events.triggered"), GuiMessage::EventTriggered},
+        {QStringLiteral("mycroft.gui.resume"), GuiMessage::Resume}
+    });
+
+    return types;
+}
+
+static void resolveType(GuiMessage &message)
+{
+    message.type = messageTypes().value(message.typeName, GuiMessage::Unknown);
+
+    // List operations on the active skills namespace manage the skills model itself
+    if (message.skillId == QLatin1String("mycroft.system.active_skills")) {
+        switch (message.type) {
+        case GuiMessage::SessionListInsert:
+            message.type = GuiMessage::ActiveSkillsInsert;
+            break;
+        case GuiMessage::SessionListRemove:
+            message.type = GuiMessage::ActiveSkillsRemove;
+            break;
+        case GuiMessage::SessionListMove:
+            message.type = GuiMessage::ActiveSkillsMove;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+GuiMessage GuiMessage::fromJson(const QJsonObject &object)
+{
+    GuiMessage message;
+
+    // Walk the object only once, instead of looking up every key separately
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        const QString key = it.key();
+
+        if (key == QLatin1String("type")) {
+            message.typeName = it.value().toString();
+        } else if (key == QLatin1String("namespace")) {
+            message.skillId = it.value().toString();
+        } else if (key == QLatin1String("property")) {
+            message.property = it.value().toString();
+        } else if (key == QLatin1String("event_name")) {
+            message.eventName = it.value().toString();
+        } else if (key == QLatin1String("position")) {
+            message.position = it.value().toInt();
+        } else if (key == QLatin1String("from")) {
+            message.from = it.value().toInt();
+        } else if (key == QLatin1String("to")) {
+            message.to = it.value().toInt();
+        } else if (key == QLatin1String("items_number")) {
+            message.itemsNumber = it.value().toInt();
+        } else if (key == QLatin1String("data")) {
+            message.data = it.value().toVariant();
+        } else if (key == QLatin1String("list_identity")) {
+            message.listIdentity = it.value().toObject().toVariantMap();
+        }
+    }
+
+    resolveType(message);
+
+    return message;
+}
+
+#ifdef MYCROFT_GUI_HAVE_CBOR
+GuiMessage GuiMessage::fromCbor(const QCborMap &map)
+{
+    GuiMessage message;
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        const QString key = it.key().toString();
+
+        if (key == QLatin1String("type")) {
+            message.typeName = it.value().toString();
+        } else if (key == QLatin1String("namespace")) {
+            message.skillId = it.value().toString();
+        } else if (key == QLatin1String("property")) {
+            message.property = it.value().toString();
+        } else if (key == QLatin1String("event_name")) {
+            message.eventName = it.value().toString();
+        } else if (key == QLatin1String("position")) {
+            message.position = int(it.value().toInteger());
+        } else if (key == QLatin1String("from")) {
+            message.from = int(it.value().toInteger());
+        } else if (key == QLatin1String("to")) {
+            message.to = int(it.value().toInteger());
+        } else if (key == QLatin1String("items_number")) {
+            message.itemsNumber = int(it.value().toInteger());
+        } else if (key == QLatin1String("data")) {
+            // Straight to QVariant, no intermediate JSON representation
+            message.data = it.value().toVariant();
+        } else if (key == QLatin1String("list_identity")) {
+            message.listIdentity = it.value().toMap().toVariantMap();
+        }
+    }
+
+    resolveType(message);
+
+    return message;
+}
+#endif
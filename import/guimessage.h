@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+#include <QtGlobal>
+
+class QJsonObject;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#define MYCROFT_GUI_HAVE_CBOR 1
+class QCborMap;
+#endif
+
+/**
+ * A message arrived on the gui socket, with all its fields extracted once.
+ * The message type is resolved to an enum value at parse time, so the view
+ * can dispatch it with a single table lookup.
+ */
+struct GuiMessage
+{
+    enum Type {
+        Unknown = 0,
+        SessionSet,
+        SessionDelete,
+        ActiveSkillsInsert,
+        ActiveSkillsRemove,
+        ActiveSkillsMove,
+        GuiListInsert,
+        GuiListRemove,
+        GuiListMove,
+        SessionListInsert,
+        SessionListUpdate,
+        SessionListMove,
+        SessionListRemove,
+        EventTriggered,
+        SessionPatch,
+        SessionListPaged,
+        Resume,
+        TypeCount
+    };
+
+    /**
+     * @returns the parsed message, its type() will be Unknown
+     * if the "type" field was not recognized
+     */
+    static GuiMessage fromJson(const QJsonObject &object);
+
+#ifdef MYCROFT_GUI_HAVE_CBOR
+    /**
+     * Same as fromJson, for messages that arrived in a binary frame
+     */
+    static GuiMessage fromCbor(const QCborMap &map);
+#endif
+
+    Type type = Unknown;
+    // The "type" field as sent by the server
+    QString typeName;
+    // The "namespace" field: either a skill id or a system namespace
+    QString skillId;
+    QString property;
+    QString eventName;
+    int position = 0;
+    int from = 0;
+    int to = 0;
+    int itemsNumber = 0;
+    // The "data" field, already converted
+    QVariant data;
+    // The optional "list_identity" field of mycroft.session.set: for each list
+    // property, the key identifying its items across updates
+    QVariantMap listIdentity;
+    // Metrics::now() when the frame arrived, 0 when the metrics are disabled
+    qint64 receivedAt = 0;
+};
+
+Q_DECLARE_METATYPE(GuiMessage)
+
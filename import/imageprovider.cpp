@@ -0,0 +1,315 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "imageprovider.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QImageReader>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+// Skills may give the url as is, or percent encoded so it survives as a path
+static QUrl imageUrl(const QString &id)
+{
+    QUrl url(id);
+    if (url.scheme().isEmpty()) {
+        url = QUrl(QUrl::fromPercentEncoding(id.toUtf8()));
+    }
+    return url;
+}
+
+static QString cacheKey(const QUrl &url, const QSize &requestedSize)
+{
+    return url.toString() + QLatin1Char('@') + QString::number(requestedSize.width())
+        + QLatin1Char('x') + QString::number(requestedSize.height());
+}
+
+// The size to decode original at to fit in requested, like Image.sourceSize: invalid to keep it as is
+static QSize scaledSize(const QSize &original, const QSize &requested)
+{
+    if (original.isEmpty() || (requested.width() <= 0 && requested.height() <= 0)) {
+        return QSize();
+    }
+
+    int width = requested.width();
+    int height = requested.height();
+    if (width <= 0) {
+        width = qMax(1, original.width() * height / original.height());
+    } else if (height <= 0) {
+        height = qMax(1, original.height() * width / original.width());
+    }
+
+    const QSize fit = original.scaled(width, height, Qt::KeepAspectRatio);
+    // Never bigger than what was downloaded
+    if (fit.width() >= original.width() || fit.height() >= original.height()) {
+        return QSize();
+    }
+    return fit;
+}
+
+class ImageResponse : public QQuickImageResponse
+{
+    Q_OBJECT
+
+public:
+    ImageResponse(ImageProvider *provider, QNetworkAccessManager *network, const QUrl &url, const QSize &requestedSize)
+        : m_provider(provider),
+          m_network(network),
+          m_url(url),
+          m_requestedSize(requestedSize),
+          m_key(cacheKey(url, requestedSize))
+    {
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override
+    {
+        return m_error;
+    }
+
+    // From the thread of the image loader
+    void cancel() override
+    {
+        m_cancelled.storeRelease(1);
+        QMetaObject::invokeMethod(this, "abort", Qt::QueuedConnection);
+    }
+
+    // Queued in the thread of the image loader, once it's connected to finished
+    Q_INVOKABLE void start();
+    // In the thread of the network access manager
+    Q_INVOKABLE void download();
+    Q_INVOKABLE void abort();
+    // From the decoding job
+    Q_INVOKABLE void setImage(const QImage &image, const QString &error);
+
+private:
+    void onReplyFinished();
+    void decode(const QByteArray &data, const QString &fileName);
+
+    ImageProvider *m_provider;
+    QNetworkAccessManager *m_network;
+    QUrl m_url;
+    QSize m_requestedSize;
+    QString m_key;
+    QPointer<QNetworkReply> m_reply;
+    QAtomicInt m_cancelled;
+    QImage m_image;
+    QString m_error;
+};
+
+class DecodeJob : public QRunnable
+{
+public:
+    DecodeJob(ImageResponse *response, const QByteArray &data, const QString &fileName, const QSize &requestedSize)
+        : m_response(response),
+          m_data(data),
+          m_fileName(fileName),
+          m_requestedSize(requestedSize)
+    {
+    }
+
+    void run() override
+    {
+        QBuffer buffer(&m_data);
+        QImageReader reader;
+        if (m_fileName.isEmpty()) {
+            buffer.open(QIODevice::ReadOnly);
+            reader.setDevice(&buffer);
+        } else {
+            reader.setFileName(m_fileName);
+        }
+
+        // Decoders like the JPEG one skip most of the work when asked for less pixels
+        const QSize target = scaledSize(reader.size(), m_requestedSize);
+        if (target.isValid()) {
+            reader.setScaledSize(target);
+        }
+
+        QImage image = reader.read();
+        QString error;
+        if (image.isNull()) {
+            error = reader.errorString();
+        } else if (target.isValid() && image.size() != target) {
+            image = image.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+
+        QMetaObject::invokeMethod(m_response, "setImage", Qt::QueuedConnection, Q_ARG(QImage, image), Q_ARG(QString, error));
+    }
+
+private:
+    // Alive until it emits finished, which only setImage does at this point
+    ImageResponse *m_response;
+    QByteArray m_data;
+    QString m_fileName;
+    QSize m_requestedSize;
+};
+
+void ImageResponse::start()
+{
+    if (m_cancelled.loadAcquire()) {
+        m_error = QStringLiteral("Cancelled");
+        emit finished();
+        return;
+    }
+
+    const QImage cached = m_provider->cachedImage(m_key);
+    if (!cached.isNull()) {
+        m_image = cached;
+        emit finished();
+        return;
+    }
+
+    if (m_url.isLocalFile()) {
+        decode(QByteArray(), m_url.toLocalFile());
+        return;
+    } else if (m_url.scheme() == QLatin1String("qrc")) {
+        decode(QByteArray(), QLatin1Char(':') + m_url.path());
+        return;
+    }
+
+    moveToThread(m_network->thread());
+    QMetaObject::invokeMethod(this, "download", Qt::QueuedConnection);
+}
+
+void ImageResponse::download()
+{
+    if (m_cancelled.loadAcquire()) {
+        m_error = QStringLiteral("Cancelled");
+        emit finished();
+        return;
+    }
+
+    QNetworkRequest request(m_url);
+    // Once downloaded the disk cache answers, without asking the server again
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+
+    m_reply = m_network->get(request);
+    connect(m_reply.data(), &QNetworkReply::finished, this, &ImageResponse::onReplyFinished);
+}
+
+void ImageResponse::abort()
+{
+    if (m_reply) {
+        m_reply->abort();
+    }
+}
+
+void ImageResponse::onReplyFinished()
+{
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        m_error = reply->errorString();
+        emit finished();
+        return;
+    } else if (m_cancelled.loadAcquire()) {
+        m_error = QStringLiteral("Cancelled");
+        emit finished();
+        return;
+    }
+
+    decode(reply->readAll(), QString());
+}
+
+void ImageResponse::decode(const QByteArray &data, const QString &fileName)
+{
+    QThreadPool::globalInstance()->start(new DecodeJob(this, data, fileName, m_requestedSize));
+}
+
+void ImageResponse::setImage(const QImage &image, const QString &error)
+{
+    m_image = image;
+    m_error = error;
+
+    if (!image.isNull()) {
+        m_provider->cacheImage(m_key, image);
+    } else {
+        qWarning() << "Can't decode the image" << m_url << error;
+    }
+
+    emit finished();
+}
+
+ImageProvider::ImageProvider()
+    : QQuickAsyncImageProvider(),
+      m_network(new QNetworkAccessManager)
+{
+    QNetworkDiskCache *diskCache = new QNetworkDiskCache(m_network);
+    diskCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/images"));
+    diskCache->setMaximumCacheSize(64 * 1024 * 1024);
+    m_network->setCache(diskCache);
+
+    // A few screens of artwork at 800x480
+    m_cache.setMaxCost(32 * 1024 * 1024);
+}
+
+ImageProvider::~ImageProvider()
+{
+    delete m_network;
+}
+
+QQuickImageResponse *ImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    ImageResponse *response = new ImageResponse(this, m_network, imageUrl(id), requestedSize);
+
+    // Emitting finished before the loader connects to it would lose the image
+    QMetaObject::invokeMethod(response, "start", Qt::QueuedConnection);
+
+    return response;
+}
+
+int ImageProvider::capacity() const
+{
+    QMutexLocker locker(&m_cacheLock);
+    return m_cache.maxCost();
+}
+
+void ImageProvider::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_cacheLock);
+    m_cache.setMaxCost(capacity);
+}
+
+QImage ImageProvider::cachedImage(const QString &key)
+{
+    QMutexLocker locker(&m_cacheLock);
+
+    // QCache::object() also makes it the most recently used
+    const QImage *image = m_cache.object(key);
+    return image ? *image : QImage();
+}
+
+void ImageProvider::cacheImage(const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&m_cacheLock);
+    m_cache.insert(key, new QImage(image), image.bytesPerLine() * image.height());
+}
+
+#include "imageprovider.moc"
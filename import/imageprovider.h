@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QQuickAsyncImageProvider>
+
+class QNetworkAccessManager;
+
+/**
+ * Images for the skills, as image://mycroft/<url>: downloaded through a
+ * disk cache, decoded in a thread already at the sourceSize asked by the
+ * Image, which is what the screen needs, and kept in memory for pages
+ * showing them again. Local and qrc urls work too, without the download.
+ */
+class ImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    ImageProvider();
+    ~ImageProvider() override;
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    /**
+     * Bytes of decoded images kept in memory
+     */
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    /**
+     * @returns the image decoded for key by a previous request, a null image if there is none
+     * @internal used by the responses, from any thread
+     */
+    QImage cachedImage(const QString &key);
+    void cacheImage(const QString &key, const QImage &image);
+
+private:
+    QNetworkAccessManager *m_network;
+    mutable QMutex m_cacheLock;
+    QCache<QString, QImage> m_cache;
+};
+
@@ -16,6 +16,8 @@
  */
 
 #include "mediaservice.h"
+#include "audiometer.h"
+#include "globalsettings.h"
 #include <QAudioProbe>
 #include <QMediaObject>
 #include <QMediaPlayer>
@@ -23,6 +25,22 @@
 #include <QAudioDeviceInfo>
 #include <QAudioInput>
 #include <QAudioRecorder>
+#include <QGuiApplication>
+#include <QScreen>
+
+static const QStringList &mediaServiceIntents()
+{
+    static const QStringList intents({
+        QStringLiteral("gui.player.media.service.play"),
+        QStringLiteral("gui.player.media.service.pause"),
+        QStringLiteral("gui.player.media.service.stop"),
+        QStringLiteral("gui.player.media.service.resume"),
+        QStringLiteral("gui.player.media.service.set.meta"),
+        QStringLiteral("gui.player.media.service.set.next")
+    });
+
+    return intents;
+}
 
 MediaService::MediaService(QObject *parent)
     : QObject(parent),
@@ -34,33 +52,259 @@ MediaService::MediaService(QObject *parent)
                 &MediaService::onMainSocketIntentReceived);
     }
 
+    for (const auto &intent : mediaServiceIntents()) {
+        m_controller->subscribeIntent(intent);
+    }
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+    // GStreamer picks the decoders by rank, and ranks low on purpose the hardware ones that aren't
+    // reliable everywhere yet: they go first only on devices where the setting says they work.
+    // Names it doesn't have are ignored, it must be set before the first player initializes it.
+    if (GlobalSettings().hardwareVideoDecoders() && qEnvironmentVariableIsEmpty("GST_PLUGIN_FEATURE_RANK")) {
+        qputenv("GST_PLUGIN_FEATURE_RANK", "v4l2h264dec:MAX,v4l2h265dec:MAX,v4l2vp8dec:MAX,v4l2vp9dec:MAX,"
+                                           "v4l2slh264dec:MAX,v4l2slvp8dec:MAX,vah264dec:MAX,vah265dec:MAX,"
+                                           "vaapih264dec:MAX,vaapih265dec:MAX,omxh264dec:MAX");
+    }
+#endif
+
+    m_videoProxy = new VideoSurfaceProxy(this);
+    connect(m_videoProxy, &VideoSurfaceProxy::handleTypeChanged, this, &MediaService::videoStatisticsChanged);
+    connect(m_videoProxy, &QAbstractVideoSurface::activeChanged, this, [this](bool active) {
+        if (active) {
+            m_videoStatisticsTimer.start();
+        } else {
+            m_videoStatisticsTimer.stop();
+        }
+        emit videoStatisticsChanged();
+    });
+    // Counters change at every frame, QML doesn't need to know that often
+    m_videoStatisticsTimer.setInterval(1000);
+    connect(&m_videoStatisticsTimer, &QTimer::timeout, this, &MediaService::videoStatisticsChanged);
+
     calculator = new FFTCalc(this);
-    m_player = new QMediaPlayer;
-    connect(calculator, &FFTCalc::calculatedSpectrum, this, [this](QVector<double> spectrum) {
-        int size = 20;
-        m_spectrum.resize(size);
-        int j = 0;
-        for (int i = 0; i < spectrum.size(); i += spectrum.size()/(size - 1)) {
-            m_spectrum[j] = spectrum[i];
-            ++j;
+    m_player = new QMediaPlayer(this);
+    m_nextPlayer = new QMediaPlayer(this);
+    connectPlayer(m_player);
+    connectPlayer(m_nextPlayer);
+    calculator->configure(m_spectrumBands, BufferProcessor::BandScale(m_spectrumScale), m_spectrumDecay);
+
+    // The analysis runs at the pace of the audio chunks, the bars only need to move once per frame
+    qreal refreshRate = 60;
+    if (QGuiApplication::primaryScreen() && QGuiApplication::primaryScreen()->refreshRate() > 0) {
+        refreshRate = QGuiApplication::primaryScreen()->refreshRate();
+    }
+    m_spectrumFrameTimer.setInterval(qMax(1, qRound(1000 / refreshRate)));
+    m_spectrumFrameTimer.setSingleShot(true);
+    connect(&m_spectrumFrameTimer, &QTimer::timeout, this, [this]() {
+        if (m_spectrumPending) {
+            updateSpectrum();
+        }
+    });
+    connect(calculator, &FFTCalc::calculatedSpectrum, this, [this]() {
+        if (m_spectrumFrameTimer.isActive()) {
+            m_spectrumPending = true;
+        } else {
+            updateSpectrum();
         }
-        emit spectrumChanged();
     });
 
-    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &MediaService::onMediaStatusChanged);
     setupProbeSource();
 }
 
-void MediaService::setupProbeSource()
+MediaService::~MediaService()
+{
+    for (const auto &intent : mediaServiceIntents()) {
+        m_controller->unsubscribeIntent(intent);
+    }
+}
+
+void MediaService::updateSpectrum()
+{
+    m_spectrumPending = false;
+    if (!calculator->updateSpectrum()) {
+        return;
+    }
+
+    // Copied element by element: the frame belongs to the buffer the analysis thread rotates
+    const SpectrumFrame &frame = calculator->spectrum();
+    m_spectrum.resize(frame.levels.size());
+    m_spectrumPeaks.resize(frame.peaks.size());
+    for (int i = 0; i < frame.levels.size(); ++i) {
+        m_spectrum[i] = frame.levels[i];
+    }
+    for (int i = 0; i < frame.peaks.size(); ++i) {
+        m_spectrumPeaks[i] = frame.peaks[i];
+    }
+
+    m_spectrumFrameTimer.start();
+    emit spectrumChanged();
+}
+
+int MediaService::spectrumBands() const
 {
-    QAudioProbe *probe = new QAudioProbe;
-    probe->setSource(m_player);
+    return m_spectrumBands;
+}
 
-    connect(probe, SIGNAL(audioBufferProbed(QAudioBuffer)), this, SLOT(processBuffer(QAudioBuffer)));
+void MediaService::setSpectrumBands(int bands)
+{
+    bands = qBound(1, bands, SPECSIZE / 2);
+    if (m_spectrumBands == bands) {
+        return;
+    }
+
+    m_spectrumBands = bands;
+    calculator->configure(m_spectrumBands, BufferProcessor::BandScale(m_spectrumScale), m_spectrumDecay);
+    emit spectrumBandsChanged();
+}
+
+MediaService::SpectrumScale MediaService::spectrumScale() const
+{
+    return m_spectrumScale;
+}
+
+void MediaService::setSpectrumScale(SpectrumScale scale)
+{
+    if (m_spectrumScale == scale) {
+        return;
+    }
+
+    m_spectrumScale = scale;
+    calculator->configure(m_spectrumBands, BufferProcessor::BandScale(m_spectrumScale), m_spectrumDecay);
+    emit spectrumScaleChanged();
+}
+
+double MediaService::spectrumDecay() const
+{
+    return m_spectrumDecay;
+}
+
+void MediaService::setSpectrumDecay(double decay)
+{
+    decay = qMax(0.0, decay);
+    if (qFuzzyCompare(m_spectrumDecay + 1, decay + 1)) {
+        return;
+    }
+
+    m_spectrumDecay = decay;
+    calculator->configure(m_spectrumBands, BufferProcessor::BandScale(m_spectrumScale), m_spectrumDecay);
+    emit spectrumDecayChanged();
+}
+
+void MediaService::setupProbeSource()
+{
+    if (!m_probe) {
+        m_probe = new QAudioProbe(this);
+        connect(m_probe, SIGNAL(audioBufferProbed(QAudioBuffer)), this, SLOT(processBuffer(QAudioBuffer)));
+    }
+    m_probe->setSource(m_player);
 
     return;
 }
 
+void MediaService::connectPlayer(QMediaPlayer *player)
+{
+    // Made once for both players: the one loading ahead stays silent
+    connect(player, &QMediaPlayer::mediaStatusChanged, this, [this, player](QMediaPlayer::MediaStatus status) {
+        if (player == m_player) {
+            onMediaStatusChanged(status);
+        }
+    });
+    connect(player, &QMediaPlayer::durationChanged, this, [this, player](qint64 dur) {
+        if (player == m_player) {
+            emit durationChanged(dur);
+        }
+    });
+    connect(player, &QMediaPlayer::positionChanged, this, [this, player](qint64 pos) {
+        if (player == m_player) {
+            emit positionChanged(pos);
+        }
+    });
+}
+
+QString MediaService::videoPath() const
+{
+    if (!m_videoProxy->isActive()) {
+        return QStringLiteral("none");
+    }
+
+    switch (m_videoProxy->handleType()) {
+    case QAbstractVideoBuffer::NoHandle:
+        return QStringLiteral("memory");
+    case QAbstractVideoBuffer::GLTextureHandle:
+        return QStringLiteral("texture");
+    case QAbstractVideoBuffer::EGLImageHandle:
+        return QStringLiteral("eglimage");
+    default:
+        return QStringLiteral("other");
+    }
+}
+
+qint64 MediaService::videoFramesPresented() const
+{
+    return qint64(m_videoProxy->presentedFrames());
+}
+
+qint64 MediaService::videoFramesDropped() const
+{
+    return qint64(m_videoProxy->droppedFrames());
+}
+
+QString MediaService::nextTrack() const
+{
+    return m_nextTrack;
+}
+
+void MediaService::prefetch(const QString &track)
+{
+    if (track == m_nextTrack) {
+        return;
+    }
+
+    m_nextTrack = track;
+    m_nextPlayer->stop();
+    if (track.isEmpty()) {
+        m_nextPlayer->setMedia(QMediaContent());
+    } else {
+        m_nextPlayer->setMedia(QUrl(track));
+        // Paused prerolls the pipeline: the first buffers are decoded before it's needed
+        m_nextPlayer->pause();
+    }
+    emit nextTrackChanged();
+}
+
+bool MediaService::nextReady() const
+{
+    return !m_nextTrack.isEmpty()
+        && m_nextPlayer->mediaStatus() != QMediaPlayer::NoMedia
+        && m_nextPlayer->mediaStatus() != QMediaPlayer::InvalidMedia;
+}
+
+void MediaService::swapToNext()
+{
+    QMediaPlayer *previous = m_player;
+    m_player = m_nextPlayer;
+    m_nextPlayer = previous;
+    m_track = m_nextTrack;
+    m_nextTrack.clear();
+
+    m_player->play();
+    if (mVideoSurface) {
+        previous->setVideoOutput(static_cast<QAbstractVideoSurface *>(nullptr));
+        m_player->setVideoOutput(m_videoProxy);
+    }
+    setupProbeSource();
+    previous->stop();
+    previous->setMedia(QMediaContent());
+
+    setPlaybackState(QMediaPlayer::PlayingState);
+    emit nextTrackChanged();
+    emit durationChanged(m_player->duration());
+    m_controller->sendRequest(QStringLiteral("gui.player.media.service.next.started"), QVariantMap({{QStringLiteral("track"), m_track}}));
+
+    // Its loading was not reported while it was the next one
+    onMediaStatusChanged(m_player->mediaStatus());
+}
+
 QAbstractVideoSurface *MediaService::videoSurface() const
 {
     return mVideoSurface;
@@ -71,7 +315,14 @@ void MediaService::setVidSurface(QAbstractVideoSurface *videoSurface)
     if(videoSurface != mVideoSurface)
     {
         mVideoSurface = videoSurface;
-        m_player->setVideoOutput(mVideoSurface);
+        m_videoProxy->setTarget(mVideoSurface);
+        m_videoProxy->resetStatistics();
+        // Set again so the player negotiates the formats with the new surface
+        m_player->setVideoOutput(static_cast<QAbstractVideoSurface *>(nullptr));
+        if (mVideoSurface) {
+            m_player->setVideoOutput(m_videoProxy);
+        }
+        emit videoStatisticsChanged();
 
         emit signalVideoSurfaceChanged();
     }
@@ -79,94 +330,39 @@ void MediaService::setVidSurface(QAbstractVideoSurface *videoSurface)
 
 void MediaService::processBuffer(QAudioBuffer buffer)
 {
-    qreal peakValue;
-    int duration;
-
-    if(buffer.frameCount() < 512)
+    if (buffer.frameCount() <= 0) {
         return;
+    }
 
-    levelLeft = levelRight = 0;
+    // Only grows: after the first buffers this never allocates
+    if (sample.size() < buffer.frameCount()) {
+        sample.resize(buffer.frameCount());
+    }
 
-    if(buffer.format().channelCount() != 2)
+    // One pass for the levels and the mono downmix the spectrum is computed on
+    const AudioMeter::Levels meter = AudioMeter::measure(buffer, sample.data());
+    if (meter.channels == 0) {
         return;
-
-    sample.resize(buffer.frameCount());
-    if(buffer.format().sampleType() == QAudioFormat::SignedInt){
-        QAudioBuffer::S16S *data = buffer.data<QAudioBuffer::S16S>();
-        if (buffer.format().sampleSize() == 32)
-            peakValue=INT_MAX;
-        else if (buffer.format().sampleSize() == 16)
-            peakValue=SHRT_MAX;
-        else
-            peakValue=CHAR_MAX;
-
-        for(int i=0; i<buffer.frameCount(); i++){
-            sample[i] = data[i].left/peakValue;
-#ifndef Q_OS_ANDROID
-            levelLeft+= abs(data[i].left)/peakValue;
-            levelRight+= abs(data[i].right)/peakValue;
-#else
-            levelLeft+= (data[i].left)/peakValue * ((data[i].left)/peakValue>0) - ((data[i].left)/peakValue<0);
-            levelRight+= (data[i].right)/peakValue * ((data[i].right)/peakValue>0) - ((data[i].right)/peakValue<0);
-#endif
-        }
     }
 
-    else if(buffer.format().sampleType() == QAudioFormat::UnSignedInt){
-        QAudioBuffer::S16U *data = buffer.data<QAudioBuffer::S16U>();
-        if (buffer.format().sampleSize() == 32)
-            peakValue=UINT_MAX;
-        else if (buffer.format().sampleSize() == 16)
-            peakValue=USHRT_MAX;
-        else
-            peakValue=UCHAR_MAX;
-        for(int i=0; i<buffer.frameCount(); i++){
-            sample[i] = data[i].left/peakValue;
-#ifndef Q_OS_ANDROID
-            levelLeft+= abs(data[i].left)/peakValue;
-            levelRight+= abs(data[i].right)/peakValue;
-#else
-            levelLeft+= (data[i].left)/peakValue * ((data[i].left)/peakValue>0) - ((data[i].left)/peakValue<0);
-            levelRight+= (data[i].right)/peakValue * ((data[i].right)/peakValue>0) - ((data[i].right)/peakValue<0);
-#endif
-        }
-    }
+    levelLeft = meter.mean[0];
+    levelRight = meter.channels > 1 ? meter.mean[1] : meter.mean[0];
 
-    else if(buffer.format().sampleType() == QAudioFormat::Float){
-        QAudioBuffer::S32F *data = buffer.data<QAudioBuffer::S32F>();
-        peakValue = 1.00003;
-        for(int i=0; i<buffer.frameCount(); i++){
-            sample[i] = data[i].left/peakValue;
-            if(sample[i] != sample[i]){
-                sample[i] = 0;
-            }
-            else{
-#ifndef Q_OS_ANDROID
-                levelLeft+= abs(data[i].left)/peakValue;
-                levelRight+= abs(data[i].right)/peakValue;
-#else
-                levelLeft+= (data[i].left)/peakValue * ((data[i].left)/peakValue>0) - ((data[i].left)/peakValue<0);
-                levelRight+= (data[i].right)/peakValue * ((data[i].right)/peakValue>0) - ((data[i].right)/peakValue<0);
-#endif
-            }
-        }
-    }
-    duration = buffer.format().durationForBytes(buffer.frameCount())/1000;
-    calculator->calc(sample, duration);
-    emit levels(levelLeft/buffer.frameCount(), levelRight/buffer.frameCount());
+    calculator->push(sample.constData(), buffer.frameCount(), buffer.format().sampleRate());
+    emit levels(levelLeft, levelRight);
 }
 
 void MediaService::playURL(const QString &filename)
 {
+    if (filename == m_nextTrack && nextReady()) {
+        m_player->stop();
+        swapToNext();
+        return;
+    }
+
     m_player->setMedia(QUrl(filename));
     m_player->play();
     setPlaybackState(QMediaPlayer::PlayingState);
-    connect(m_player, &QMediaPlayer::durationChanged, this, [&](qint64 dur) {
-        emit durationChanged(dur);
-    });
-    connect(m_player, &QMediaPlayer::positionChanged, this, [&](qint64 pos) {
-        emit positionChanged(pos);
-    });
 }
 
 void MediaService::playerStop()
@@ -195,6 +391,12 @@ void MediaService::playerRestart()
 
 void MediaService::playerNext()
 {
+    // Already here: no need to wait for the core to send it
+    if (nextReady()) {
+        m_player->stop();
+        swapToNext();
+        return;
+    }
     m_controller->sendRequest(QStringLiteral("gui.player.media.service.get.next"), m_emptyData);
 }
 
@@ -274,6 +476,11 @@ QMediaPlayer::State MediaService::playbackState() const
 
 void MediaService::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
 {
+    if (status == QMediaPlayer::EndOfMedia && !m_repeat && nextReady()) {
+        swapToNext();
+        return;
+    }
+
     emit mediaStatusChanged(status);
 
     m_currentMediaStatus.clear();
@@ -282,29 +489,34 @@ void MediaService::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
 
     if (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)
     {
-        QStringList metadataAvailableList = m_player->availableMetaData();
-        int availableListSize = metadataAvailableList.size();
-        QString availableMetaKey;
-        QVariant availableMetaVal;
-
-        m_metadataList.clear();
-        for (int idx = 0; idx < availableListSize; idx++)
-        {
-            availableMetaKey = metadataAvailableList.at(idx);
-            availableMetaVal = m_player->metaData(availableMetaKey);
-            m_metadataList.insert(availableMetaKey, availableMetaVal);
-
-            if(availableMetaKey == QStringLiteral("Title")){
-                m_title = m_player->metaData(availableMetaKey).toString();
-            }
-            if(availableMetaKey == QStringLiteral("Artist")){
-                m_artist = m_player->metaData(availableMetaKey).toString();
-            }
-        }
+        updateMetadata();
+    }
+}
+
+void MediaService::updateMetadata()
+{
+    QStringList metadataAvailableList = m_player->availableMetaData();
+    int availableListSize = metadataAvailableList.size();
+    QString availableMetaKey;
+    QVariant availableMetaVal;
 
-        emit metaUpdated();
-        m_controller->sendRequest(QStringLiteral("gui.player.media.service.get.meta"), m_metadataList);
+    m_metadataList.clear();
+    for (int idx = 0; idx < availableListSize; idx++)
+    {
+        availableMetaKey = metadataAvailableList.at(idx);
+        availableMetaVal = m_player->metaData(availableMetaKey);
+        m_metadataList.insert(availableMetaKey, availableMetaVal);
+
+        if(availableMetaKey == QStringLiteral("Title")){
+            m_title = m_player->metaData(availableMetaKey).toString();
+        }
+        if(availableMetaKey == QStringLiteral("Artist")){
+            m_artist = m_player->metaData(availableMetaKey).toString();
+        }
     }
+
+    emit metaUpdated();
+    m_controller->sendRequest(QStringLiteral("gui.player.media.service.get.meta"), m_metadataList);
 }
 
 void MediaService::onMainSocketIntentReceived(const QString &type, const QVariantMap &data)
@@ -313,10 +525,17 @@ void MediaService::onMainSocketIntentReceived(const QString &type, const QVarian
     if(type == QStringLiteral("gui.player.media.service.play")) {
         m_track = data[QStringLiteral("track")].toString();
         m_repeat = data[QStringLiteral("repeat")].toBool();
+        if (data.contains(QStringLiteral("next"))) {
+            prefetch(data[QStringLiteral("next")].toString());
+        }
 
         emit playRequested();
     }
 
+    if(type == QStringLiteral("gui.player.media.service.set.next")) {
+        prefetch(data[QStringLiteral("track")].toString());
+    }
+
     if(type == QStringLiteral("gui.player.media.service.pause")) {
         playerPause();
         emit pauseRequested();
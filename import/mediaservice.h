@@ -24,29 +24,70 @@
 #include <QMediaPlayer>
 #include <QAbstractVideoSurface>
 #include <QJsonDocument>
+#include <QTimer>
 #include "thirdparty/fftcalc.h"
+#include "videosurfaceproxy.h"
 #include "mycroftcontroller.h"
 
 class MediaService : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QVector<double> spectrum READ spectrum NOTIFY spectrumChanged)
+    Q_PROPERTY(QVector<double> spectrumPeaks READ spectrumPeaks NOTIFY spectrumChanged)
+    Q_PROPERTY(int spectrumBands READ spectrumBands WRITE setSpectrumBands NOTIFY spectrumBandsChanged)
+    Q_PROPERTY(SpectrumScale spectrumScale READ spectrumScale WRITE setSpectrumScale NOTIFY spectrumScaleChanged)
+    Q_PROPERTY(double spectrumDecay READ spectrumDecay WRITE setSpectrumDecay NOTIFY spectrumDecayChanged)
     Q_PROPERTY(QMediaPlayer::State playbackState READ playbackState NOTIFY playbackStateChanged)
     Q_PROPERTY(QAbstractVideoSurface* videoSurface READ videoSurface WRITE setVidSurface NOTIFY signalVideoSurfaceChanged)
+    // Track loaded ahead, to start as soon as the current one ends
+    Q_PROPERTY(QString nextTrack READ nextTrack NOTIFY nextTrackChanged)
+    // How the frames reach the surface: "texture" and "eglimage" are the zero-copy ones, "memory" gets uploaded at each frame
+    Q_PROPERTY(QString videoPath READ videoPath NOTIFY videoStatisticsChanged)
+    Q_PROPERTY(qint64 videoFramesPresented READ videoFramesPresented NOTIFY videoStatisticsChanged)
+    Q_PROPERTY(qint64 videoFramesDropped READ videoFramesDropped NOTIFY videoStatisticsChanged)
 
 public:
+    enum SpectrumScale {
+        LogarithmicScale = BufferProcessor::LogBands,
+        MelScale = BufferProcessor::MelBands,
+        LinearScale = BufferProcessor::LinearBands
+    };
+    Q_ENUM(SpectrumScale)
+
     explicit MediaService(QObject *parent = Q_NULLPTR);
+    ~MediaService() override;
 
     QMediaPlayer::State playerState() const {return m_playerState;}
     QVector<double> spectrum() const {return m_spectrum;}
+    // Where each bar has been recently, to be drawn on top of it
+    QVector<double> spectrumPeaks() const {return m_spectrumPeaks;}
+
+    // How many bars the spectrum has
+    int spectrumBands() const;
+    void setSpectrumBands(int bands);
+    // How the bars are spread over the frequencies
+    SpectrumScale spectrumScale() const;
+    void setSpectrumScale(SpectrumScale scale);
+    // How much of the full height the bars fall per second, 0 to follow the sound exactly
+    double spectrumDecay() const;
+    void setSpectrumDecay(double decay);
     QAbstractVideoSurface *videoSurface() const;
     void setVidSurface(QAbstractVideoSurface *videoSurface);
     QMediaPlayer::State getPlaybackState();
+    QString nextTrack() const;
+    QString videoPath() const;
+    qint64 videoFramesPresented() const;
+    qint64 videoFramesDropped() const;
 
 public Q_SLOTS:
     void setupProbeSource();
     void processBuffer(QAudioBuffer buffer);
     void playURL(const QString &filename);
+    /**
+     * Loads track in a second player, which takes over without gaps when the current
+     * track ends, or when the track is played or skipped to
+     */
+    void prefetch(const QString &track);
     void playerStop();
     void playerPause();
     void playerContinue();
@@ -79,19 +120,40 @@ Q_SIGNALS:
     void shuffleRequested();
     void metaReceived();
     void metaUpdated();
+    void nextTrackChanged();
+    void videoStatisticsChanged();
 
 private:
     MycroftController *m_controller;
     QAbstractVideoSurface *mVideoSurface;
+    // What the players draw on, forwarding to mVideoSurface
+    VideoSurfaceProxy *m_videoProxy;
+    QTimer m_videoStatisticsTimer;
     void onMainSocketIntentReceived(const QString &type, const QVariantMap &data);
     void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    // Forwards the signals of player while it's the current one
+    void connectPlayer(QMediaPlayer *player);
+    bool nextReady() const;
+    void swapToNext();
+    void updateMetadata();
+    void updateSpectrum();
 
-    QVector<double> sample;
+    QVector<float> sample;
     QVector<double> m_spectrum;
+    QVector<double> m_spectrumPeaks;
+    int m_spectrumBands = 20;
+    SpectrumScale m_spectrumScale = LogarithmicScale;
+    double m_spectrumDecay = 1.5;
+    // At most a spectrumChanged per frame, whatever the rate the analysis runs at
+    QTimer m_spectrumFrameTimer;
+    bool m_spectrumPending = false;
     QMediaPlayer::State m_playerState;
     double levelLeft, levelRight;
     FFTCalc *calculator;
     QMediaPlayer *m_player;
+    QMediaPlayer *m_nextPlayer;
+    QAudioProbe *m_probe = nullptr;
+    QString m_nextTrack;
     QString m_track;
     QString m_artist;
     QString m_album;
@@ -106,6 +168,9 @@ private:
 signals:
     int levels(double left, double right);
     void spectrumChanged();
+    void spectrumBandsChanged();
+    void spectrumScaleChanged();
+    void spectrumDecayChanged();
 };
 
 #endif // MEDIASERVICE_H
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "messagequeue.h"
+#include "guimessage.h"
+#include "socketconnection.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#ifdef MYCROFT_GUI_HAVE_CBOR
+#include <QCborValue>
+#endif
+
+MessageQueue::MessageQueue(SocketConnection *socket, QObject *parent)
+    : QObject(parent),
+      m_socket(socket)
+{
+    // About a frame at 60fps: all the writes done by the same round of bindings end up together
+    m_flushTimer.setInterval(16);
+    m_flushTimer.setSingleShot(true);
+    connect(&m_flushTimer, &QTimer::timeout, this, &MessageQueue::flush);
+}
+
+MessageQueue::~MessageQueue()
+{
+}
+
+void MessageQueue::enqueue(const QVariantMap &message)
+{
+    const QString type = message.value(QStringLiteral("type")).toString();
+
+    // Only the last pending message can be merged with, so the relative order
+    // of different messages is never changed
+    if (!m_pending.isEmpty()) {
+        QVariantMap &last = m_pending.last().message;
+        const bool pendingSet = last.value(QStringLiteral("type")).toString() == QLatin1String("mycroft.session.set")
+            && last.value(QStringLiteral("namespace")) == message.value(QStringLiteral("namespace"));
+
+        if (pendingSet && type == QLatin1String("mycroft.session.set")) {
+            QVariantMap data = last.value(QStringLiteral("data")).toMap();
+            const QVariantMap newData = message.value(QStringLiteral("data")).toMap();
+            for (auto it = newData.constBegin(); it != newData.constEnd(); ++it) {
+                data.insert(it.key(), it.value());
+            }
+            last[QStringLiteral("data")] = data;
+            updateLastFrame();
+            if (m_pendingBytes >= m_maximumBytes) {
+                flush();
+            }
+            return;
+
+        } else if (pendingSet && type == QLatin1String("mycroft.session.delete")) {
+            QVariantMap data = last.value(QStringLiteral("data")).toMap();
+            if (data.remove(message.value(QStringLiteral("property")).toString()) > 0) {
+                if (data.isEmpty()) {
+                    m_pendingBytes -= m_pending.last().frame.size();
+                    m_pending.removeLast();
+                } else {
+                    last[QStringLiteral("data")] = data;
+                    updateLastFrame();
+                }
+            }
+        }
+    }
+
+    Pending pending;
+    pending.message = message;
+    pending.frame = serialize(message);
+    m_pendingBytes += pending.frame.size();
+    m_pending << pending;
+
+    if (m_pending.size() >= m_maximumDepth || m_pendingBytes >= m_maximumBytes) {
+        flush();
+    } else if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void MessageQueue::flush()
+{
+    m_flushTimer.stop();
+
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    if (m_socket->state() != QAbstractSocket::ConnectedState) {
+        qWarning() << "Connection not open, dropping" << m_pending.size() << "queued messages";
+        m_pending.clear();
+        m_pendingBytes = 0;
+        return;
+    }
+
+    for (const auto &pending : m_pending) {
+        const QByteArray &frame = pending.frame;
+
+        if (m_binaryFraming) {
+            m_socket->sendBinaryMessage(frame);
+        } else {
+            m_socket->sendTextMessage(QString::fromUtf8(frame));
+        }
+
+        ++m_framesSent;
+        m_bytesSent += quint64(frame.size());
+    }
+
+    m_pending.clear();
+    m_pendingBytes = 0;
+}
+
+void MessageQueue::clear()
+{
+    m_flushTimer.stop();
+    m_pending.clear();
+    m_pendingBytes = 0;
+}
+
+bool MessageQueue::binaryFraming() const
+{
+    return m_binaryFraming;
+}
+
+void MessageQueue::setBinaryFraming(bool binary)
+{
+#ifndef MYCROFT_GUI_HAVE_CBOR
+    if (binary) {
+        qWarning() << "CBOR framing not supported by this build, falling back to JSON";
+        binary = false;
+    }
+#endif
+
+    if (m_binaryFraming == binary) {
+        return;
+    }
+
+    // What was queued with the old framing must go out with it
+    flush();
+    m_binaryFraming = binary;
+}
+
+int MessageQueue::maximumDepth() const
+{
+    return m_maximumDepth;
+}
+
+void MessageQueue::setMaximumDepth(int depth)
+{
+    m_maximumDepth = qMax(1, depth);
+}
+
+int MessageQueue::maximumBytes() const
+{
+    return m_maximumBytes;
+}
+
+void MessageQueue::setMaximumBytes(int bytes)
+{
+    m_maximumBytes = qMax(1, bytes);
+}
+
+int MessageQueue::depth() const
+{
+    return m_pending.size();
+}
+
+int MessageQueue::pendingBytes() const
+{
+    return m_pendingBytes;
+}
+
+quint64 MessageQueue::framesSent() const
+{
+    return m_framesSent;
+}
+
+quint64 MessageQueue::bytesSent() const
+{
+    return m_bytesSent;
+}
+
+void MessageQueue::updateLastFrame()
+{
+    Pending &last = m_pending.last();
+    m_pendingBytes -= last.frame.size();
+    last.frame = serialize(last.message);
+    m_pendingBytes += last.frame.size();
+}
+
+QByteArray MessageQueue::serialize(const QVariantMap &message) const
+{
+#ifdef MYCROFT_GUI_HAVE_CBOR
+    if (m_binaryFraming) {
+        return QCborValue::fromVariant(message).toCbor();
+    }
+#endif
+
+    return QJsonDocument(QJsonObject::fromVariantMap(message)).toJson(QJsonDocument::Compact);
+}
+
+#include "moc_messagequeue.cpp"
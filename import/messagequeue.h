@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QTimer>
+#include <QVariant>
+#include <QVector>
+
+class SocketConnection;
+
+/**
+ * Outbound messages for one web socket connection.
+ * Messages are collected and sent all together on the next frame tick,
+ * or as soon as too many are waiting, or too many bytes.
+ * They're encoded when queued, so what is waiting is known in bytes. Consecutive mycroft.session.set
+ * for the same namespace are merged in a single message, and a
+ * mycroft.session.delete drops the same key from a pending set.
+ */
+class MessageQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    MessageQueue(SocketConnection *socket, QObject *parent = nullptr);
+    ~MessageQueue() override;
+
+    /**
+     * Queues a message, to be sent on the next flush
+     */
+    void enqueue(const QVariantMap &message);
+
+    /**
+     * Sends all the pending messages right away
+     */
+    void flush();
+
+    /**
+     * Drops all the pending messages without sending them
+     */
+    void clear();
+
+    /**
+     * If true messages get sent as CBOR in binary frames, as compact JSON in text frames otherwise
+     */
+    bool binaryFraming() const;
+    void setBinaryFraming(bool binary);
+
+    /**
+     * How many messages can wait before the queue gets flushed without waiting the next tick
+     */
+    int maximumDepth() const;
+    void setMaximumDepth(int depth);
+
+    /**
+     * How many encoded bytes can wait before the queue gets flushed without waiting the next tick
+     */
+    int maximumBytes() const;
+    void setMaximumBytes(int bytes);
+
+    /**
+     * Number of messages currently waiting to be sent
+     */
+    int depth() const;
+
+    /**
+     * Size of the frames currently waiting to be sent
+     */
+    int pendingBytes() const;
+
+    /**
+     * Total number of frames and bytes written on the socket since the queue was created
+     */
+    quint64 framesSent() const;
+    quint64 bytesSent() const;
+
+private:
+    struct Pending {
+        QVariantMap message;
+        // message, encoded with the current framing
+        QByteArray frame;
+    };
+
+    QByteArray serialize(const QVariantMap &message) const;
+    // Encodes again the last message after it got merged with another
+    void updateLastFrame();
+
+    SocketConnection *m_socket;
+    QVector<Pending> m_pending;
+    QTimer m_flushTimer;
+    int m_maximumDepth = 64;
+    // A few frames of a paged list, or an image sent inline
+    int m_maximumBytes = 256 * 1024;
+    int m_pendingBytes = 0;
+    bool m_binaryFraming = false;
+    quint64 m_framesSent = 0;
+    quint64 m_bytesSent = 0;
+};
+
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QQuickWindow>
+
+static int bucketFor(qint64 nsecs)
+{
+    qint64 usecs = nsecs / 1000;
+    int bucket = 0;
+    while (usecs > 0 && bucket < Metrics::BucketCount - 1) {
+        usecs >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void Metrics::Histogram::add(qint64 nsecs)
+{
+    if (count == 0 || nsecs < min) {
+        min = nsecs;
+    }
+    if (count == 0 || nsecs > max) {
+        max = nsecs;
+    }
+    ++count;
+    sum += nsecs;
+    ++buckets[bucketFor(nsecs)];
+}
+
+qint64 Metrics::Histogram::percentile(int percentile) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    const quint64 wanted = qMax<quint64>(1, (count * quint64(percentile) + 99) / 100);
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= wanted) {
+            return qint64(1) << i;
+        }
+    }
+    return qint64(1) << (BucketCount - 1);
+}
+
+QVariantMap Metrics::Histogram::toVariant() const
+{
+    QVariantList counts;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts << buckets[i];
+    }
+
+    // In microseconds, that's what the buckets are in
+    return QVariantMap({
+        {QStringLiteral("count"), count},
+        {QStringLiteral("mean"), count > 0 ? double(sum) / count / 1000 : 0.0},
+        {QStringLiteral("min"), double(min) / 1000},
+        {QStringLiteral("max"), double(max) / 1000},
+        {QStringLiteral("p50"), percentile(50)},
+        {QStringLiteral("p90"), percentile(90)},
+        {QStringLiteral("p99"), percentile(99)},
+        {QStringLiteral("buckets"), counts}
+    });
+}
+
+Metrics *Metrics::instance()
+{
+    // The socket threads use it too
+    static Metrics *s_self = new Metrics;
+    return s_self;
+}
+
+Metrics::Metrics(QObject *parent)
+    : QObject(parent)
+{
+    // The local server needs the event loop of the gui, wherever this got created first
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+
+    // Starts the clock: 0 is never a valid timestamp
+    now();
+
+    // Field units get it turned on without touching the QML
+    if (qEnvironmentVariableIsSet("MYCROFT_GUI_METRICS")) {
+        setEnabled(true);
+    }
+    // The first instance() call may come from a socket thread: the local
+    // server must not be created there, so it's done from the gui event loop
+    if (qEnvironmentVariableIsSet("MYCROFT_GUI_METRICS_SOCKET")) {
+        QMetaObject::invokeMethod(this, "setServerName", Qt::QueuedConnection,
+                                  Q_ARG(QString, QString::fromLocal8Bit(qgetenv("MYCROFT_GUI_METRICS_SOCKET"))));
+    }
+}
+
+Metrics::~Metrics()
+{
+}
+
+qint64 Metrics::now()
+{
+    static QElapsedTimer s_clock;
+    static bool s_started = (s_clock.start(), true);
+    Q_UNUSED(s_started)
+
+    return s_clock.nsecsElapsed();
+}
+
+bool Metrics::enabled() const
+{
+    return m_enabled.loadAcquire();
+}
+
+void Metrics::setEnabled(bool enabled)
+{
+    if (Metrics::enabled() == enabled) {
+        return;
+    }
+
+    m_enabled.storeRelease(enabled ? 1 : 0);
+    emit enabledChanged();
+}
+
+QString Metrics::serverName() const
+{
+    return m_serverName;
+}
+
+void Metrics::setServerName(const QString &name)
+{
+    if (m_serverName == name) {
+        return;
+    }
+
+    m_serverName = name;
+    delete m_server;
+    m_server = nullptr;
+
+    if (!name.isEmpty()) {
+        setEnabled(true);
+
+        // Left behind by a crash, listen would fail
+        QLocalServer::removeServer(name);
+        m_server = new QLocalServer(this);
+        connect(m_server, &QLocalServer::newConnection, this, &Metrics::serveDump);
+        if (!m_server->listen(name)) {
+            qWarning() << "Can't serve the metrics on" << name << m_server->errorString();
+        }
+    }
+
+    emit serverNameChanged();
+}
+
+void Metrics::recordMessage(Channel channel, const QString &type, int bytes, qint64 parseNsecs)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+    TypeStats &stats = m_types[channel][type];
+    ++stats.count;
+    stats.bytes += quint64(bytes);
+    stats.parse.add(parseNsecs);
+}
+
+void Metrics::recordHandler(Channel channel, const QString &type, qint64 handlerNsecs)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_types[channel][type].handler.add(handlerNsecs);
+}
+
+void Metrics::recordTiming(const QString &name, qint64 nsecs)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_timings[name].add(nsecs);
+}
+
+void Metrics::recordNextFrame(QQuickWindow *window, qint64 since)
+{
+    if (!enabled() || !window || since <= 0) {
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_pendingFrames.find(window);
+    if (it == m_pendingFrames.end()) {
+        it = m_pendingFrames.insert(window, QVector<qint64>());
+
+        // Emitted in the render thread, if the render loop has one
+        connect(window, &QQuickWindow::frameSwapped, this, [this, window]() {
+            onFrameSwapped(window);
+        }, Qt::DirectConnection);
+        connect(window, &QObject::destroyed, this, [this, window]() {
+            QMutexLocker locker(&m_lock);
+            m_pendingFrames.remove(window);
+        });
+    }
+
+    it.value() << since;
+}
+
+void Metrics::onFrameSwapped(QQuickWindow *window)
+{
+    const qint64 swapped = now();
+
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_pendingFrames.find(window);
+    if (it == m_pendingFrames.end() || it.value().isEmpty()) {
+        return;
+    }
+
+    Histogram &histogram = m_timings[QStringLiteral("delegate.firstFrame")];
+    for (const qint64 since : it.value()) {
+        histogram.add(swapped - since);
+    }
+    it.value().clear();
+}
+
+Metrics::HandlerTimer::HandlerTimer(Channel channel, const QString &type)
+    : m_channel(channel),
+      m_type(type),
+      m_start(Metrics::instance()->enabled() ? Metrics::now() : -1)
+{
+}
+
+Metrics::HandlerTimer::~HandlerTimer()
+{
+    if (m_start >= 0) {
+        Metrics::instance()->recordHandler(m_channel, m_type, Metrics::now() - m_start);
+    }
+}
+
+QVariantMap Metrics::snapshot() const
+{
+    QMutexLocker locker(&m_lock);
+
+    QVariantMap root;
+    const QString channelNames[] = {QStringLiteral("bus"), QStringLiteral("gui")};
+
+    for (int channel = BusChannel; channel <= GuiChannel; ++channel) {
+        QVariantMap types;
+        for (auto it = m_types[channel].constBegin(); it != m_types[channel].constEnd(); ++it) {
+            types[it.key()] = QVariantMap({
+                {QStringLiteral("count"), it->count},
+                {QStringLiteral("bytes"), it->bytes},
+                {QStringLiteral("parse"), it->parse.toVariant()},
+                {QStringLiteral("handler"), it->handler.toVariant()}
+            });
+        }
+        root[channelNames[channel]] = types;
+    }
+
+    QVariantMap timings;
+    for (auto it = m_timings.constBegin(); it != m_timings.constEnd(); ++it) {
+        timings[it.key()] = it->toVariant();
+    }
+    root[QStringLiteral("timings")] = timings;
+    root[QStringLiteral("uptime")] = double(now()) / 1000000000;
+
+    return root;
+}
+
+QByteArray Metrics::toJson() const
+{
+    return QJsonDocument::fromVariant(snapshot()).toJson();
+}
+
+void Metrics::reset()
+{
+    QMutexLocker locker(&m_lock);
+
+    m_types[BusChannel].clear();
+    m_types[GuiChannel].clear();
+    m_timings.clear();
+}
+
+void Metrics::serveDump()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        socket->write(toJson());
+        // Closes once everything is written
+        socket->disconnectFromServer();
+    }
+}
+
+#include "moc_metrics.cpp"
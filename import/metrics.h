@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVariant>
+#include <QVector>
+
+class QLocalServer;
+class QQuickWindow;
+
+/**
+ * Counters and timings of the gui, to see how it behaves on real devices:
+ * per message type, for both sockets, how many arrived, their bytes and
+ * the time to parse and handle them, and as histograms the latency from a
+ * gui message arriving to it being handled and to the first frame showing
+ * the delegate it asked for, and the compile and incubation times of the
+ * delegates.
+ *
+ * Nothing is recorded unless enabled, by the property or by setting the
+ * MYCROFT_GUI_METRICS environment variable. All the record functions can
+ * be called from any thread.
+ */
+class Metrics : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    /**
+     * Name of a local socket serving the JSON dump of the metrics to whoever connects,
+     * as in `socat - UNIX-CONNECT:/tmp/<name>`. Empty (default) for none, it can be set
+     * with MYCROFT_GUI_METRICS_SOCKET. Setting it enables the metrics.
+     */
+    Q_PROPERTY(QString serverName READ serverName WRITE setServerName NOTIFY serverNameChanged)
+
+public:
+    enum Channel {
+        BusChannel = 0,
+        GuiChannel
+    };
+    Q_ENUM(Channel)
+
+    /**
+     * Log2 buckets of microseconds: the last one takes everything above 2^(BucketCount - 2) us, about 16s
+     */
+    enum {
+        BucketCount = 26
+    };
+
+    struct Histogram {
+        quint64 count = 0;
+        qint64 sum = 0;
+        qint64 min = 0;
+        qint64 max = 0;
+        quint64 buckets[BucketCount] = {};
+
+        void add(qint64 nsecs);
+        // Upper bound in microseconds of the bucket containing the percentile, like 50 or 99
+        qint64 percentile(int percentile) const;
+        QVariantMap toVariant() const;
+    };
+
+    static Metrics *instance();
+    ~Metrics() override;
+
+    /**
+     * Nanoseconds on a monotonic clock shared by all the threads, to time what spans them
+     */
+    static qint64 now();
+
+    bool enabled() const;
+    void setEnabled(bool enabled);
+
+    QString serverName() const;
+    // Invokable, so that the server gets created in the thread of the object
+    Q_INVOKABLE void setServerName(const QString &name);
+
+    // A message was parsed, in parseNsecs
+    void recordMessage(Channel channel, const QString &type, int bytes, qint64 parseNsecs);
+    // A message was acted upon, in handlerNsecs
+    void recordHandler(Channel channel, const QString &type, qint64 handlerNsecs);
+    // Any named timing, like "delegate.compile"
+    void recordTiming(const QString &name, qint64 nsecs);
+
+    /**
+     * Records as "delegate.firstFrame" the time from since to the next frame of window
+     */
+    void recordNextFrame(QQuickWindow *window, qint64 since);
+
+    /**
+     * Records a handler time when going out of scope
+     */
+    class HandlerTimer
+    {
+    public:
+        HandlerTimer(Channel channel, const QString &type);
+        ~HandlerTimer();
+
+    private:
+        Channel m_channel;
+        QString m_type;
+        qint64 m_start;
+    };
+
+    /**
+     * All the metrics as a map, also what toJson() writes
+     */
+    Q_INVOKABLE QVariantMap snapshot() const;
+    Q_INVOKABLE QByteArray toJson() const;
+    Q_INVOKABLE void reset();
+
+Q_SIGNALS:
+    void enabledChanged();
+    void serverNameChanged();
+
+private:
+    Metrics(QObject *parent = nullptr);
+
+    void onFrameSwapped(QQuickWindow *window);
+    void serveDump();
+
+    struct TypeStats {
+        quint64 count = 0;
+        quint64 bytes = 0;
+        Histogram parse;
+        Histogram handler;
+    };
+
+    QAtomicInt m_enabled;
+    mutable QMutex m_lock;
+    QHash<QString, TypeStats> m_types[2];
+    QHash<QString, Histogram> m_timings;
+    // Per window, the starting points of the latencies ending at its next frame
+    QHash<QQuickWindow *, QVector<qint64>> m_pendingFrames;
+
+    QString m_serverName;
+    QLocalServer *m_server = nullptr;
+};
+
@@ -21,7 +21,13 @@
 #include "abstractdelegate.h"
 #include "activeskillsmodel.h"
 #include "abstractskillview.h"
+#include "connectionmonitor.h"
 #include "controllerconfig.h"
+#include "messagequeue.h"
+#include "metrics.h"
+#include "sessionstore.h"
+#include "socketconnection.h"
+#include "ttsplayer.h"
 
 #include <QJsonObject>
 #include <QJsonArray>
@@ -34,7 +40,6 @@
 #include <QQmlContext>
 #include <QUuid>
 #include <QWebSocket>
-#include <QMediaPlayer>
 
 MycroftController *MycroftController::instance()
 {
@@ -46,26 +51,51 @@ MycroftController *MycroftController::instance()
 }
 
 
+// Announces a gui, together with the framings it can speak on its own socket.
+// Cores that don't know about "framing" just ignore it and stay on JSON.
+static QVariantMap guiConnectedData(const QString &guiId)
+{
+    return QVariantMap({
+        {QStringLiteral("gui_id"), guiId},
+        {QStringLiteral("framing"), AbstractSkillView::supportedFramings()}
+    });
+}
+
 MycroftController::MycroftController(QObject *parent)
     : QObject(parent),
-      m_appSettingObj(new GlobalSettings)
+      m_appSettingObj(new GlobalSettings),
+      m_filteredMessagePrefixes({QStringLiteral("enclosure"), QStringLiteral("mycroft-date")})
 {
-    connect(&m_mainWebSocket, &QWebSocket::connected, this,
-            [this] () {
-                m_reconnectTimer.stop();
-                emit socketStatusChanged();
-            });
-    connect(&m_mainWebSocket, &QWebSocket::disconnected, this, &MycroftController::closed);
-    connect(&m_mainWebSocket, &QWebSocket::stateChanged, this,
+    m_mainWebSocket = new SocketConnection(SocketWorker::BusDecoder, this);
+    m_mainWebSocket->setMessageFilter(m_filteredMessagePrefixes, QStringList());
+    m_sessionStore = new SessionStore(this);
+    m_sharedGuiConnection = m_appSettingObj->sharedGuiConnection();
+    m_outboundQueue = new MessageQueue(m_mainWebSocket, this);
+    m_connectionMonitor = new ConnectionMonitor(m_mainWebSocket, this);
+    m_ttsPlayer = new TtsPlayer(this);
+    m_ttsCache = new TtsCache(this);
+    m_ttsCache->setCapacity(m_appSettingObj->ttsCacheSize() * 1024 * 1024);
+    m_ttsCache->setDiskSpill(m_appSettingObj->ttsCacheOnDisk());
+    connect(m_appSettingObj, &GlobalSettings::ttsCacheSizeChanged, this, [this]() {
+        m_ttsCache->setCapacity(m_appSettingObj->ttsCacheSize() * 1024 * 1024);
+    });
+    connect(m_appSettingObj, &GlobalSettings::ttsCacheOnDiskChanged, this, [this]() {
+        m_ttsCache->setDiskSpill(m_appSettingObj->ttsCacheOnDisk());
+    });
+
+    connect(m_mainWebSocket, &SocketConnection::connected, this, &MycroftController::socketStatusChanged);
+    connect(m_mainWebSocket, &SocketConnection::disconnected, this, &MycroftController::closed);
+    connect(m_mainWebSocket, &SocketConnection::disconnected, m_outboundQueue, &MessageQueue::clear);
+    connect(m_mainWebSocket, &SocketConnection::stateChanged, this,
             [this] (QAbstractSocket::SocketState state) {
                 emit socketStatusChanged();
                 if (state == QAbstractSocket::ConnectedState) {
                     qWarning() << "Main Socket connected, trying to connect gui";
                     for (const auto &guiId : m_views.keys()) {
-                        sendRequest(QStringLiteral("mycroft.gui.connected"),
-                                    QVariantMap({{QStringLiteral("gui_id"), guiId}}));
+                        sendRequest(QStringLiteral("mycroft.gui.connected"), guiConnectedData(guiId));
                     }
-                    m_reannounceGuiTimer.start();
+                    m_reannounceAttempts = 0;
+                    m_reannounceGuiTimer.start(ConnectionMonitor::backoffDelay(m_reannounceAttempts++, 10000, 120000));
 
                     sendRequest(QStringLiteral("mycroft.skills.all_loaded"), QVariantMap());
                 } else {
@@ -76,26 +106,32 @@ MycroftController::MycroftController(QObject *parent)
                 }
             });
 
-    connect(&m_mainWebSocket, &QWebSocket::textMessageReceived, this, &MycroftController::onMainSocketMessageReceived);
+    connect(m_mainWebSocket, &SocketConnection::busMessageReceived, this, &MycroftController::onMainSocketMessageReceived);
 
-    m_reconnectTimer.setInterval(1000);
-    connect(&m_reconnectTimer, &QTimer::timeout, this, [this]() {
+    connect(m_connectionMonitor, &ConnectionMonitor::reconnectRequested, this, [this]() {
         QString socket = m_appSettingObj->webSocketAddress() + QStringLiteral(":8181/core");
-        m_mainWebSocket.open(QUrl(socket));
+        m_mainWebSocket->open(QUrl(socket));
+        emit socketStatusChanged();
     });
+    connect(m_connectionMonitor, &ConnectionMonitor::roundTripTimeChanged, this, &MycroftController::roundTripTimeChanged);
 
-    m_reannounceGuiTimer.setInterval(10000);
+    // A core that didn't answer is likely busy loading skills: ask again less and less often
+    m_reannounceGuiTimer.setSingleShot(true);
     connect(&m_reannounceGuiTimer, &QTimer::timeout, this, [this]() {
-        if (m_mainWebSocket.state() != QAbstractSocket::ConnectedState) {
+        if (m_mainWebSocket->state() != QAbstractSocket::ConnectedState) {
             return;
         }
+        bool pending = false;
         for (const auto &guiId : m_views.keys()) {
             if (m_views[guiId]->status() != Open) {
                 qWarning()<<"Retrying to announce gui";
-                sendRequest(QStringLiteral("mycroft.gui.connected"),
-                            QVariantMap({{QStringLiteral("gui_id"), guiId}}));
+                sendRequest(QStringLiteral("mycroft.gui.connected"), guiConnectedData(guiId));
+                pending = true;
             }
         }
+        if (pending) {
+            m_reannounceGuiTimer.start(ConnectionMonitor::backoffDelay(m_reannounceAttempts++, 10000, 120000));
+        }
     });
 
 #ifdef Q_OS_ANDROID
@@ -119,8 +155,8 @@ void MycroftController::start()
 {
     //auto appSettingObj = new GlobalSettings;
     QString socket = m_appSettingObj->webSocketAddress() + QStringLiteral(":8181/core");
-    m_mainWebSocket.open(QUrl(socket));
-    connect(&m_mainWebSocket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
+    m_mainWebSocket->open(QUrl(socket));
+    connect(m_mainWebSocket, &SocketConnection::error,
             this, [this] (const QAbstractSocket::SocketError &error) {
         //qDebug() << error;
 
@@ -138,7 +174,7 @@ void MycroftController::start()
                 QProcess::startDetached(QStringLiteral("mycroft-gui-ptt-loader"), QStringList());
             }
         }
-        m_reconnectTimer.start();
+        m_connectionMonitor->scheduleReconnect();
         emit socketStatusChanged();
     });
 
@@ -148,8 +184,8 @@ void MycroftController::start()
 void MycroftController::disconnectSocket()
 {
     qDebug() << "in reconnect";
-    m_mainWebSocket.close();
-    m_reconnectTimer.stop();
+    m_mainWebSocket->close();
+    m_connectionMonitor->stop();
     if (m_mycroftLaunched) {
         QProcess::startDetached(QStringLiteral("mycroft-gui-core-stop"), QStringList());
         m_mycroftLaunched = false;
@@ -160,8 +196,8 @@ void MycroftController::disconnectSocket()
 void MycroftController::reconnect()
 {
     qDebug() << "in reconnect";
-    m_mainWebSocket.close();
-    m_reconnectTimer.start();
+    m_mainWebSocket->close();
+    m_connectionMonitor->scheduleReconnect();
     emit socketStatusChanged();
 }
 
@@ -170,32 +206,86 @@ void MycroftController::startPTTClient()
     QProcess::startDetached(QStringLiteral("mycroft-gui-ptt-loader"), QStringList());
 }
 
-void MycroftController::onMainSocketMessageReceived(const QString &message)
+QStringList MycroftController::filteredMessagePrefixes() const
 {
-    auto doc = QJsonDocument::fromJson(message.toUtf8());
+    return m_filteredMessagePrefixes;
+}
 
-    if (doc.isEmpty()) {
-        qWarning() << "Empty or invalid JSON message arrived on the main socket:" << message;
+void MycroftController::setFilteredMessagePrefixes(const QStringList &prefixes)
+{
+    if (m_filteredMessagePrefixes == prefixes) {
         return;
     }
 
-    auto type = doc[QStringLiteral("type")].toString();
+    m_filteredMessagePrefixes = prefixes;
+    m_mainWebSocket->setMessageFilter(m_filteredMessagePrefixes, m_allowedMessageTypes.values());
+    emit filteredMessagePrefixesChanged();
+}
 
-    if (type.isEmpty()) {
-        qWarning() << "Empty type in the JSON message on the main socket";
+QStringList MycroftController::allowedMessageTypes() const
+{
+    return m_allowedMessageTypes.values();
+}
+
+void MycroftController::setAllowedMessageTypes(const QStringList &types)
+{
+    const QSet<QString> typesSet = QSet<QString>::fromList(types);
+    if (m_allowedMessageTypes == typesSet) {
+        return;
+    }
+
+    m_allowedMessageTypes = typesSet;
+    m_mainWebSocket->setMessageFilter(m_filteredMessagePrefixes, m_allowedMessageTypes.values());
+    emit allowedMessageTypesChanged();
+}
+
+bool MycroftController::sharedGuiConnection() const
+{
+    return m_sharedGuiConnection;
+}
+
+void MycroftController::setSharedGuiConnection(bool shared)
+{
+    if (m_sharedGuiConnection == shared) {
         return;
     }
 
-    //filter out the noise so we can print debug stuff later without drowning in noise
-    if (type.startsWith(QStringLiteral("enclosure")) || type.startsWith(QStringLiteral("mycroft-date"))) {
+    m_sharedGuiConnection = shared;
+    // The views already there keep the connection they have
+    m_guiChannel = nullptr;
+    emit sharedGuiConnectionChanged();
+}
+
+void MycroftController::subscribeIntent(const QString &type)
+{
+    ++m_intentSubscriptions[type];
+}
+
+void MycroftController::unsubscribeIntent(const QString &type)
+{
+    auto it = m_intentSubscriptions.find(type);
+    if (it == m_intentSubscriptions.end()) {
         return;
     }
 
+    if (--it.value() <= 0) {
+        m_intentSubscriptions.erase(it);
+    }
+}
+
+void MycroftController::onMainSocketMessageReceived(const QString &type, const QJsonDocument &doc)
+{
+    Metrics::HandlerTimer timer(Metrics::BusChannel, type);
+
+    //filtering and parsing already happened in the socket thread
 #ifdef DEBUG_MYCROFT_MESSAGEBUS
     qDebug() << "type" << type;
 #endif
 
-    emit intentRecevied(type, doc[QStringLiteral("data")].toVariant().toMap());
+    //build the variant map only when somebody is interested in this type
+    if (m_intentSubscriptions.contains(type) || m_intentSubscriptions.contains(QStringLiteral("*"))) {
+        emit intentRecevied(type, doc[QStringLiteral("data")].toVariant().toMap());
+    }
 
 #ifdef Q_OS_ANDROID
     if (type == QLatin1String("speak") && m_speech->state() != QTextToSpeech::Speaking) {
@@ -209,22 +299,40 @@ void MycroftController::onMainSocketMessageReceived(const QString &message)
     }
 #endif
 
+    if (type == QLatin1String("speak") && m_appSettingObj->usesRemoteTTS()) {
+        const QJsonValue data = doc[QStringLiteral("data")];
+        const QString utterance = data[QStringLiteral("utterance")].toString();
+        const QString key = TtsCache::key(utterance, data[QStringLiteral("voice")].toString(), data[QStringLiteral("lang")].toString());
+
+        // A core that stopped sending audio doesn't make the keys pile up
+        while (m_pendingTtsKeys.count() >= 16) {
+            const QString dropped = m_pendingTtsKeys.dequeue();
+            if (!m_playedTtsKeys.remove(dropped)) {
+                m_ttsPlayer->release(dropped);
+            }
+        }
+        m_pendingTtsKeys.enqueue(key);
+
+        // Its audio plays after the one of the sentences before, even if those are still on their way
+        m_ttsPlayer->reserve(key);
+
+        // Played right away, and the core is told it doesn't need to send the audio
+        m_playedTtsKeys.remove(key);
+        if (m_ttsCache->contains(key)) {
+            const QByteArray audio = m_ttsCache->lookup(key);
+            if (!audio.isEmpty()) {
+                m_ttsPlayer->appendChunk(key, audio, true);
+                m_playedTtsKeys.insert(key);
+                sendRequest(QStringLiteral("remote.tts.cached"), QVariantMap({
+                    {QStringLiteral("hash"), key},
+                    {QStringLiteral("utterance"), utterance}
+                }));
+            }
+        }
+    }
+
     if (type == QLatin1String("remote.tts.audio") && m_appSettingObj->usesRemoteTTS()) {
-        QString aud = doc[QStringLiteral("data")][QStringLiteral("wave")].toString();
-        auto innerdoc = QJsonDocument::fromJson(aud.toUtf8());
-        QJsonValue qjv = innerdoc[QStringLiteral("py/b64")];
-        QString aud_values = qjv.toString();
-        QByteArray audioopt;
-        audioopt.append(qUtf8Printable(aud_values));
-        QByteArray aud_array = QByteArray::fromBase64(audioopt, QByteArray::Base64UrlEncoding);
-        QByteArray ret_aud = QByteArray::fromBase64(aud_array);
-        QFile file(QStringLiteral("/tmp/incoming.wav"));
-        file.open(QIODevice::WriteOnly);
-        file.write(ret_aud);
-        file.close();
-        QMediaPlayer *player = new QMediaPlayer;
-        player->setMedia(QUrl::fromLocalFile(QStringLiteral("/tmp/incoming.wav")));
-        player->play();
+        onRemoteTtsAudio(doc[QStringLiteral("data")]);
     }
 
     // Try catching intent_failure from another method because of issue: https://github.com/MycroftAI/mycroft-core/issues/2490
@@ -299,6 +407,13 @@ void MycroftController::onMainSocketMessageReceived(const QString &message)
             return;
         }
 
+        const QString framing = doc[QStringLiteral("data")][QStringLiteral("framing")].toString();
+        if (framing == QLatin1String("cbor")) {
+            m_views[guiId]->setFraming(AbstractSkillView::CborFraming);
+        } else {
+            m_views[guiId]->setFraming(AbstractSkillView::JsonFraming);
+        }
+
         QUrl url(QStringLiteral("%1:%2/gui").arg(m_appSettingObj->webSocketAddress()).arg(port));
         m_views[guiId]->setUrl(url);
         m_reannounceGuiTimer.stop();
@@ -331,26 +446,25 @@ void MycroftController::onMainSocketMessageReceived(const QString &message)
 
 void MycroftController::sendRequest(const QString &type, const QVariantMap &data, const QVariantMap &context)
 {
-    if (m_mainWebSocket.state() != QAbstractSocket::ConnectedState) {
+    if (m_mainWebSocket->state() != QAbstractSocket::ConnectedState) {
         qWarning() << "mycroft connection not open!";
         return;
     }
-    QJsonObject root;
+    QVariantMap root;
 
     root[QStringLiteral("type")] = type;
-    root[QStringLiteral("data")] = QJsonObject::fromVariantMap(data);
+    root[QStringLiteral("data")] = data;
 
     if(m_appSettingObj->useHivemindProtocol()){
-        root[QStringLiteral("context")] = QJsonObject::fromVariantMap(context);
+        root[QStringLiteral("context")] = context;
     }
 
-    QJsonDocument doc(root);
-    m_mainWebSocket.sendTextMessage(QString::fromUtf8(doc.toJson()));
+    m_outboundQueue->enqueue(root);
 }
 
 void MycroftController::sendBinary(const QString &type, const QJsonObject &data, const QVariantMap &context)
 {
-    if (m_mainWebSocket.state() != QAbstractSocket::ConnectedState) {
+    if (m_mainWebSocket->state() != QAbstractSocket::ConnectedState) {
         qWarning() << "mycroft connection not open!";
         return;
     }
@@ -365,7 +479,20 @@ void MycroftController::sendBinary(const QString &type, const QJsonObject &data,
     QJsonDocument doc;
     doc.setObject(socketObject);
     QByteArray docbin = doc.toJson(QJsonDocument::Compact);
-    m_mainWebSocket.sendBinaryMessage(docbin);
+    //don't overtake what is still queued
+    m_outboundQueue->flush();
+    m_mainWebSocket->sendBinaryMessage(docbin);
+}
+
+void MycroftController::sendBinaryFrame(const QByteArray &frame)
+{
+    if (m_mainWebSocket->state() != QAbstractSocket::ConnectedState) {
+        qWarning() << "mycroft connection not open!";
+        return;
+    }
+
+    m_outboundQueue->flush();
+    m_mainWebSocket->sendBinaryMessage(frame);
 }
 
 void MycroftController::sendText(const QString &message)
@@ -381,21 +508,157 @@ void MycroftController::registerView(AbstractSkillView *view)
 {
     Q_ASSERT(!view->id().isEmpty());
     Q_ASSERT(!m_views.contains(view->id()));
+
+    if (m_sharedGuiConnection) {
+        view->setSessionStore(m_sessionStore);
+        // Only the first view is known to the server, the others get what it receives
+        if (m_guiChannel) {
+            m_guiChannel->addFollower(view);
+            return;
+        }
+        m_guiChannel = view;
+    }
+
     m_views[view->id()] = view;
-//TODO: manage view destruction
-    if (m_mainWebSocket.state() == QAbstractSocket::ConnectedState) {
-        sendRequest(QStringLiteral("mycroft.gui.connected"),
-                    QVariantMap({{QStringLiteral("gui_id"), view->id()}}));
+    if (m_mainWebSocket->state() == QAbstractSocket::ConnectedState) {
+        sendRequest(QStringLiteral("mycroft.gui.connected"), guiConnectedData(view->id()));
+    }
+}
+
+void MycroftController::unregisterView(AbstractSkillView *view)
+{
+    m_views.remove(view->id());
+
+    const bool wasChannel = view == m_guiChannel;
+    if (wasChannel) {
+        m_guiChannel = nullptr;
+    }
+
+    const QList<AbstractSkillView *> followers = view->followers();
+    if (followers.isEmpty()) {
+        return;
+    }
+
+    // The first follower takes over the connection, all start from scratch with it
+    for (auto *follower : followers) {
+        view->removeFollower(follower);
+    }
+
+    AbstractSkillView *channel = followers.first();
+    channel->setupGuiConnection();
+    m_sessionStore->setWriter(channel);
+    for (int i = 1; i < followers.count(); ++i) {
+        channel->addFollower(followers[i]);
+    }
+    if (wasChannel) {
+        m_guiChannel = channel;
+    }
+
+    m_views[channel->id()] = channel;
+    if (m_mainWebSocket->state() == QAbstractSocket::ConnectedState) {
+        sendRequest(QStringLiteral("mycroft.gui.connected"), guiConnectedData(channel->id()));
+    }
+}
+
+void MycroftController::onRemoteTtsAudio(const QJsonValue &data)
+{
+    const QString aud = data[QStringLiteral("wave")].toString();
+    const auto innerdoc = QJsonDocument::fromJson(aud.toUtf8());
+    const QByteArray aud_values = innerdoc[QStringLiteral("py/b64")].toString().toLatin1();
+    const QByteArray ret_aud = QByteArray::fromBase64(QByteArray::fromBase64(aud_values, QByteArray::Base64UrlEncoding));
+
+    // Servers that split the audio identify the pieces of the same utterance with a stream id
+    const QString stream = data[QStringLiteral("stream")].toString();
+    const bool last = stream.isEmpty() || data[QStringLiteral("last")].toBool(true);
+
+    // Cores that know the hash send it, otherwise it's the audio of the oldest speak message still waiting
+    QString key = m_ttsStreamKeys.value(stream);
+    if (key.isEmpty()) {
+        key = data[QStringLiteral("hash")].toString();
+        if (key.isEmpty() && data[QStringLiteral("utterance")].isString()) {
+            key = TtsCache::key(data[QStringLiteral("utterance")].toString(), data[QStringLiteral("voice")].toString(), data[QStringLiteral("lang")].toString());
+        }
+        key = takePendingTtsKey(key);
+        if (!stream.isEmpty()) {
+            m_ttsStreamKeys[stream] = key;
+        }
+    }
+
+    if (last) {
+        m_ttsStreamKeys.remove(stream);
+    }
+
+    // Already played from the cache: a core not knowing about remote.tts.cached sent it anyway
+    if (!key.isEmpty() && m_playedTtsKeys.contains(key)) {
+        if (last) {
+            m_playedTtsKeys.remove(key);
+        }
+        return;
+    }
+
+    // The speak message reserved the place of its audio in the player, under its key
+    const QString slot = key.isEmpty() ? stream : key;
+    if (slot.isEmpty()) {
+        m_ttsPlayer->enqueue(ret_aud);
+        return;
+    }
+    m_ttsPlayer->appendChunk(slot, ret_aud, last);
+
+    if (key.isEmpty()) {
+        return;
+    } else if (stream.isEmpty()) {
+        m_ttsCache->insert(key, ret_aud);
+        return;
+    }
+    m_ttsStreamAudio[stream].append(ret_aud);
+    if (last) {
+        m_ttsCache->insert(key, m_ttsStreamAudio.take(stream));
     }
 }
 
+QString MycroftController::takePendingTtsKey(const QString &key)
+{
+    if (key.isEmpty()) {
+        return m_pendingTtsKeys.isEmpty() ? QString() : m_pendingTtsKeys.dequeue();
+    }
+
+    // The audio comes in the order of the speak messages: the ones before
+    // got none, the core skipped them as they were played from the cache
+    if (m_pendingTtsKeys.contains(key)) {
+        while (m_pendingTtsKeys.head() != key) {
+            const QString skipped = m_pendingTtsKeys.dequeue();
+            if (!m_playedTtsKeys.remove(skipped)) {
+                m_ttsPlayer->release(skipped);
+            }
+        }
+        m_pendingTtsKeys.dequeue();
+    }
+
+    return key;
+}
+
+TtsCache *MycroftController::ttsCache() const
+{
+    return m_ttsCache;
+}
+
+SessionStore *MycroftController::sessionStore() const
+{
+    return m_sessionStore;
+}
+
+MessageQueue *MycroftController::outboundQueue() const
+{
+    return m_outboundQueue;
+}
+
 MycroftController::Status MycroftController::status() const
 {
-    if (m_reconnectTimer.isActive()) {
+    if (m_connectionMonitor->isReconnecting()) {
         return Connecting;
     }
 
-    switch(m_mainWebSocket.state())
+    switch(m_mainWebSocket->state())
     {
     case QAbstractSocket::ConnectingState:
     case QAbstractSocket::BoundState:
@@ -438,4 +701,9 @@ bool MycroftController::serverReady() const
     return m_serverReady;
 }
 
+int MycroftController::roundTripTime() const
+{
+    return m_connectionMonitor->roundTripTime();
+}
+
 #include "moc_mycroftcontroller.cpp"
@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QWebSocket>
+#include <QJsonDocument>
 #include <QPointer>
 #include <QQuickItem>
 
@@ -29,8 +30,16 @@
 #endif
 
 #include <QTimer>
+#include <QSet>
 
+#include "ttscache.h"
+
+class ConnectionMonitor;
 class GlobalSettings;
+class MessageQueue;
+class SessionStore;
+class SocketConnection;
+class TtsPlayer;
 class QQmlPropertyMap;
 class ActiveSkillsModel;
 class AbstractSkillView;
@@ -48,6 +57,33 @@ class MycroftController : public QObject
 
     Q_PROPERTY(bool serverReady READ serverReady NOTIFY serverReadyChanged)
 
+    /**
+     * Round trip time to the core in milliseconds, -1 when not connected
+     */
+    Q_PROPERTY(int roundTripTime READ roundTripTime NOTIFY roundTripTimeChanged)
+
+    /**
+     * Messages on the main bus whose type starts with one of those prefixes are dropped
+     * before being parsed. By default "enclosure" and "mycroft-date".
+     */
+    Q_PROPERTY(QStringList filteredMessagePrefixes READ filteredMessagePrefixes WRITE setFilteredMessagePrefixes NOTIFY filteredMessagePrefixesChanged)
+
+    /**
+     * Message types that are never dropped, even if they match filteredMessagePrefixes
+     */
+    Q_PROPERTY(QStringList allowedMessageTypes READ allowedMessageTypes WRITE setAllowedMessageTypes NOTIFY allowedMessageTypesChanged)
+
+    /**
+     * If true all the views share a single gui connection and a single copy of the session data,
+     * instead of one each. Only affects the views created afterwards, by default it's the
+     * sharedGuiConnection of the global settings.
+     */
+    Q_PROPERTY(bool sharedGuiConnection READ sharedGuiConnection WRITE setSharedGuiConnection NOTIFY sharedGuiConnectionChanged)
+    /**
+     * Audio of the remote text to speech already received, with its hit statistics
+     */
+    Q_PROPERTY(TtsCache *ttsCache READ ttsCache CONSTANT)
+
     Q_ENUMS(Status)
 public:
     enum Status {
@@ -62,12 +98,35 @@ public:
     bool isSpeaking() const;
     bool isListening() const;
     bool serverReady() const;
+    int roundTripTime() const;
     Status status() const;
     QString currentSkill() const;
     QString currentIntent() const;
 
+    QStringList filteredMessagePrefixes() const;
+    void setFilteredMessagePrefixes(const QStringList &prefixes);
+
+    QStringList allowedMessageTypes() const;
+    void setAllowedMessageTypes(const QStringList &types);
+
+    bool sharedGuiConnection() const;
+    void setSharedGuiConnection(bool shared);
+
     //Public API NOT to be used with QML
     void registerView(AbstractSkillView *view);
+    void unregisterView(AbstractSkillView *view);
+
+    /**
+     * @returns the session data shared by the views, when sharedGuiConnection is true
+     */
+    SessionStore *sessionStore() const;
+
+    TtsCache *ttsCache() const;
+
+    /**
+     * @returns the queue of messages waiting to be sent on the main socket
+     */
+    MessageQueue *outboundQueue() const;
 
 Q_SIGNALS:
     //socket stuff
@@ -82,9 +141,14 @@ Q_SIGNALS:
     void currentSkillChanged();
     void currentIntentChanged();
     void serverReadyChanged();
+    void roundTripTimeChanged();
+    void filteredMessagePrefixesChanged();
+    void allowedMessageTypesChanged();
+    void sharedGuiConnectionChanged();
     void speechRequestedChanged(bool expectingResponse);
 
     //signal with nearly all data
+    //emitted only for the types requested with subscribeIntent()
     //TODO: remove?
     void intentRecevied(const QString &type, const QVariantMap &data);
 
@@ -102,16 +166,38 @@ public Q_SLOTS:
     void sendRequest(const QString &type, const QVariantMap &data, const QVariantMap &context = QVariantMap({}));
     void sendBinary(const QString &type, const QJsonObject &data, const QVariantMap &context = QVariantMap({}));
     void sendText(const QString &message);
+    // Sends data as is in a binary frame, after whatever is still queued
+    void sendBinaryFrame(const QByteArray &frame);
     void startPTTClient();
 
+    /**
+     * Ask for intentRecevied to be emitted for messages of the given type.
+     * Subscriptions are reference counted, "*" subscribes to every message.
+     */
+    void subscribeIntent(const QString &type);
+    void unsubscribeIntent(const QString &type);
+
 private:
     explicit MycroftController(QObject *parent = nullptr);
-    void onMainSocketMessageReceived(const QString &message);
-
-    QWebSocket m_mainWebSocket;
-
-    QTimer m_reconnectTimer;
+    void onMainSocketMessageReceived(const QString &type, const QJsonDocument &doc);
+    void onRemoteTtsAudio(const QJsonValue &data);
+    // The key of the speak message some audio answers, key if the core sent it
+    QString takePendingTtsKey(const QString &key);
+
+    SocketConnection *m_mainWebSocket;
+    MessageQueue *m_outboundQueue;
+
+    ConnectionMonitor *m_connectionMonitor;
+    TtsPlayer *m_ttsPlayer;
+    TtsCache *m_ttsCache;
+    // Keys of the speak messages still waiting for their audio, oldest first
+    QQueue<QString> m_pendingTtsKeys;
+    // Played from the cache, the audio the core may still send is ignored
+    QSet<QString> m_playedTtsKeys;
+    QHash<QString, QString> m_ttsStreamKeys;
+    QHash<QString, QByteArray> m_ttsStreamAudio;
     QTimer m_reannounceGuiTimer;
+    int m_reannounceAttempts = 0;
 
     GlobalSettings *m_appSettingObj;
 
@@ -121,8 +207,17 @@ private:
 
     QHash<QString, AbstractSkillView *> m_views;
 
+    SessionStore *m_sessionStore;
+    // With a shared connection, the only view announced to the server
+    QPointer<AbstractSkillView> m_guiChannel;
+    bool m_sharedGuiConnection = false;
+
     QHash<QString, QQmlPropertyMap*> m_skillData;
 
+    QStringList m_filteredMessagePrefixes;
+    QSet<QString> m_allowedMessageTypes;
+    QHash<QString, int> m_intentSubscriptions;
+
 #ifdef Q_OS_ANDROID
     QTextToSpeech *m_speech;
     bool m_isExpectingSpeechResponse = false;
@@ -29,6 +29,9 @@
 #include "sessiondatamap.h"
 #include "audiorec.h"
 #include "mediaservice.h"
+#include "skillindex.h"
+#include "imageprovider.h"
+#include "metrics.h"
 
 #include <QQmlEngine>
 #include <QQmlContext>
@@ -59,6 +62,15 @@ static QObject *mycroftControllerSingletonProvider(QQmlEngine *engine, QJSEngine
     return MycroftController::instance();
 }
 
+static QObject *metricsSingletonProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(scriptEngine);
+
+    // Shared with the socket threads, qml should never delete it
+    engine->setObjectOwnership(Metrics::instance(), QQmlEngine::CppOwnership);
+    return Metrics::instance();
+}
+
 static QObject *audioRecSingletonProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
 {
     Q_UNUSED(engine)
@@ -84,10 +96,14 @@ void MycroftPlugin::registerTypes(const char *uri)
     qmlRegisterSingletonType<FileReader>(uri, 1, 0, "FileReader", fileReaderSingletonProvider);
     qmlRegisterSingletonType<AudioRec>(uri, 1, 0, "AudioRec", audioRecSingletonProvider);
     qmlRegisterSingletonType<MediaService>(uri, 1, 0, "MediaService", mediaServiceSingletonProvider);
+    qmlRegisterSingletonType<Metrics>(uri, 1, 0, "Metrics", metricsSingletonProvider);
+    // Created here, in the gui thread, before any socket thread can ask for it
+    Metrics::instance();
     qmlRegisterSingletonType(QUrl(QStringLiteral("qrc:/qml/Units.qml")), uri, 1, 0, "Units");
     qmlRegisterSingletonType(QUrl(QStringLiteral("qrc:/qml/SoundEffects.qml")), uri, 1, 0, "SoundEffects");
     qmlRegisterType<AbstractSkillView>(uri, 1, 0, "AbstractSkillView");
     qmlRegisterType<AbstractDelegate>(uri, 1, 0, "AbstractDelegate");
+    qmlRegisterType<SkillIndex>(uri, 1, 0, "SkillIndex");
     qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/AudioPlayer.qml")), uri, 1, 0, "AudioPlayer");
     qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/AutoFitLabel.qml")), uri, 1, 0, "AutoFitLabel");
     qmlRegisterType(QUrl(QStringLiteral("qrc:/qml/Delegate.qml")), uri, 1, 0, "Delegate");
@@ -112,5 +128,13 @@ void MycroftPlugin::registerTypes(const char *uri)
    // qmlProtectModule(uri, 1);
 }
 
+void MycroftPlugin::initializeEngine(QQmlEngine *engine, const char *uri)
+{
+    QQmlExtensionPlugin::initializeEngine(engine, uri);
+
+    // Owned by the engine from now on
+    engine->addImageProvider(QStringLiteral("mycroft"), new ImageProvider);
+}
+
 #include "moc_mycroftplugin.cpp"
 
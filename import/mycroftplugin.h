@@ -32,6 +32,8 @@ class MycroftPlugin : public QQmlExtensionPlugin
 
 public:
     void registerTypes(const char *uri) override;
+    // Adds the image://mycroft provider, see ImageProvider
+    void initializeEngine(QQmlEngine *engine, const char *uri) override;
 };
 
 #endif
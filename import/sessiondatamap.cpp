@@ -19,24 +19,34 @@
 #include "abstractskillview.h"
 #include "sessiondatamodel.h"
 
+#include <QDataStream>
 #include <QDebug>
 #include <QJSValue>
 #include <cstddef>
 
 SessionDataMap::SessionDataMap(const QString &skillId, AbstractSkillView *parent)
+    : SessionDataMap(skillId, parent, parent)
+{
+}
+
+SessionDataMap::SessionDataMap(const QString &skillId, AbstractSkillView *view, QObject *parent)
     : QQmlPropertyMap(this, parent),
       m_skillId(skillId),
-      m_view(parent)
+      m_view(view)
 {
     m_updateTimer = new QTimer(this);
     m_updateTimer->setSingleShot(true);
     m_updateTimer->setInterval(250); //arbitrary
     connect(m_updateTimer, &QTimer::timeout, this, [this]() {
-        if (!m_propertiesToUpdate.isEmpty()) {
+        if (!m_view) {
+            qWarning() << "No connection to write the session data of" << m_skillId;
+        } else if (!m_propertiesToUpdate.isEmpty()) {
             m_view->writeProperties(m_skillId, m_propertiesToUpdate);
         }
         for (auto k : m_propertiesToDelete) {
-            m_view->deleteProperty(m_skillId, k);
+            if (m_view) {
+                m_view->deleteProperty(m_skillId, k);
+            }
         }
         m_propertiesToUpdate.clear();
         m_propertiesToDelete.clear();
@@ -47,6 +57,16 @@ SessionDataMap::~SessionDataMap()
 {
 }
 
+AbstractSkillView *SessionDataMap::view() const
+{
+    return m_view;
+}
+
+void SessionDataMap::setView(AbstractSkillView *view)
+{
+    m_view = view;
+}
+
 QVariant SessionDataMap::updateValue(const QString &key, const QVariant &newValue)
 {
     if (value(key).canConvert<SessionDataModel *>()) {
@@ -77,4 +97,115 @@ void SessionDataMap::clearAndNotify(const QString &key)
     emit dataCleared(key);
 }
 
+QByteArray SessionDataMap::serialize() const
+{
+    QVariantMap values;
+    QStringList models;
+    // Key -> total count and page size of the paged models
+    QVariantMap paging;
+
+    for (const auto &key : keys()) {
+        const QVariant v = value(key);
+        SessionDataModel *dm = v.value<SessionDataModel *>();
+
+        if (dm) {
+            QVariantList rows;
+            for (int i = 0; i < dm->rowCount(); ++i) {
+                rows << dm->rowData(i);
+            }
+            values[key] = rows;
+            models << key;
+            if (dm->totalCount() >= 0) {
+                paging[key] = QVariantList({dm->totalCount(), dm->pageSize()});
+            }
+        } else {
+            values[key] = v;
+        }
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    // Kept in snapshots, which must load with whatever Qt comes next
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << values << models << paging;
+
+    return qCompress(data);
+}
+
+void SessionDataMap::restore(const QByteArray &data)
+{
+    QDataStream stream(qUncompress(data));
+    stream.setVersion(QDataStream::Qt_5_9);
+    QVariantMap values;
+    QStringList models;
+    QVariantMap paging;
+    stream >> values >> models;
+    // Not there in data saved before lists could be paged
+    if (!stream.atEnd()) {
+        stream >> paging;
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Error: corrupted session data for" << m_skillId;
+        return;
+    }
+
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        if (models.contains(it.key())) {
+            SessionDataModel *dm = new SessionDataModel(this);
+            QList<QVariantMap> rows;
+            for (const auto &row : it.value().toList()) {
+                rows << row.toMap();
+            }
+            dm->insertData(0, rows);
+            const QVariantList paged = paging.value(it.key()).toList();
+            if (paged.count() == 2) {
+                dm->setPaged(paged[0].toInt(), paged[1].toInt());
+                connectPagedModel(it.key(), dm);
+            }
+            insertAndNotify(it.key(), QVariant::fromValue(dm));
+        } else {
+            insertAndNotify(it.key(), it.value());
+        }
+    }
+}
+
+QStringList SessionDataMap::serializedKeys(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return QStringList();
+    }
+
+    QDataStream stream(qUncompress(data));
+    stream.setVersion(QDataStream::Qt_5_9);
+    QVariantMap values;
+    stream >> values;
+
+    return values.keys();
+}
+
+void SessionDataMap::connectPagedModel(const QString &key, SessionDataModel *model)
+{
+    disconnect(model, &SessionDataModel::fetchMoreRequested, this, nullptr);
+    connect(model, &SessionDataModel::fetchMoreRequested, this, [this, key, model](int position, int count) {
+        if (!m_view) {
+            qWarning() << "No connection to fetch the list" << key << "of" << m_skillId;
+            model->cancelFetch();
+            return;
+        }
+        if (!m_view->fetchListItems(m_skillId, key, position, count)) {
+            model->cancelFetch();
+        }
+    });
+}
+
+void SessionDataMap::cancelFetches()
+{
+    for (const auto &key : keys()) {
+        if (SessionDataModel *dm = value(key).value<SessionDataModel *>()) {
+            dm->cancelFetch();
+        }
+    }
+}
+
 #include "moc_sessiondatamap.cpp"
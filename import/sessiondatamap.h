@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <QPointer>
 #include <QQmlPropertyMap>
 
 class QTimer;
+class SessionDataModel;
 class AbstractSkillView;
 
 class SessionDataMap : public QQmlPropertyMap
@@ -28,6 +30,10 @@ class SessionDataMap : public QQmlPropertyMap
 
 public:
     SessionDataMap(const QString &skillId, AbstractSkillView *parent);
+    /**
+     * Data not owned by the view it's written back through, as when shared by several views
+     */
+    SessionDataMap(const QString &skillId, AbstractSkillView *view, QObject *parent);
     ~SessionDataMap() override;
 
     /**
@@ -40,6 +46,39 @@ public:
      */
     void clearAndNotify(const QString &key);
 
+    /**
+     * @returns all the values, models included, in a compact binary form
+     * to be given to restore() when the map is needed again
+     */
+    QByteArray serialize() const;
+
+    /**
+     * Inserts the values saved by serialize(), lists become models again
+     */
+    void restore(const QByteArray &data);
+
+    /**
+     * @returns the keys of data saved by serialize(), without restoring it
+     */
+    static QStringList serializedKeys(const QByteArray &data);
+
+    /**
+     * Sends the page requests of the paged model under key to the server,
+     * through whichever view() the map has at the time
+     */
+    void connectPagedModel(const QString &key, SessionDataModel *model);
+
+    /**
+     * The pages asked to the server won't come, as the connection went away
+     */
+    void cancelFetches();
+
+    /**
+     * The view whose connection carries the changes done by the delegates back to the server
+     */
+    AbstractSkillView *view() const;
+    void setView(AbstractSkillView *view);
+
 Q_SIGNALS:
     /**
      * Key has been removed fro the map
@@ -54,6 +93,6 @@ private:
     QVariantMap m_propertiesToUpdate;
     QStringList m_propertiesToDelete;
     QTimer *m_updateTimer;
-    AbstractSkillView *m_view;
+    QPointer<AbstractSkillView> m_view;
 };
 
@@ -16,8 +16,10 @@
  */
 
 #include "sessiondatamodel.h"
+#include "sessiondatapatch.h"
 
 #include <QDebug>
+#include <QSet>
 
 SessionDataModel::SessionDataModel(QObject *parent)
     : QAbstractListModel(parent)
@@ -31,10 +33,15 @@ SessionDataModel::~SessionDataModel()
 
 void SessionDataModel::insertData(int position, const QList<QVariantMap> &dataList)
 {
-    if (position < 0 || position > m_data.count()) {
+    if (dataList.isEmpty()) {
         return;
     }
-    if (dataList.isEmpty()) {
+    // Added by the server past the rows fetched so far: they'll come with their page
+    if (m_totalCount >= 0 && position > m_data.count() && position <= m_totalCount) {
+        m_totalCount += dataList.count();
+        return;
+    }
+    if (position < 0 || position > m_data.count()) {
         return;
     }
 
@@ -44,19 +51,43 @@ void SessionDataModel::insertData(int position, const QList<QVariantMap> &dataLi
         int role = Qt::UserRole + 1;
         for (const auto &key : dataList.first().keys()) {
             m_roles[role] = key.toUtf8();
+            m_columns[key] = role - Qt::UserRole - 1;
             ++role;
         }
     }
 
+    // Either the page asked by fetchMore, or items the server added to the list
+    if (m_fetchPending && position == m_fetchPosition) {
+        m_fetchPending = false;
+    } else if (m_totalCount >= 0) {
+        m_totalCount += dataList.count();
+    }
+
     beginInsertRows(QModelIndex(), position, position + dataList.count() - 1);
+    m_data.insert(position, dataList.count(), QVector<QVariant>());
     int i = 0;
     for (const auto &item : dataList) {
-        m_data.insert(position + i, item);
+        m_data[position + i] = rowFromMap(item);
         ++i;
     }
     endInsertRows();
 }
 
+QVector<QVariant> SessionDataModel::rowFromMap(const QVariantMap &item) const
+{
+    QVector<QVariant> row(m_columns.count());
+
+    for (auto it = item.constBegin(); it != item.constEnd(); ++it) {
+        const int column = m_columns.value(it.key(), -1);
+        // Keys which are not roles can't be accessed from QML anyways
+        if (column >= 0) {
+            row[column] = it.value();
+        }
+    }
+
+    return row;
+}
+
 void SessionDataModel::updateData(int position, const QList<QVariantMap> &dataList)
 {
     if (dataList.isEmpty()) {
@@ -69,18 +100,238 @@ void SessionDataModel::updateData(int position, const QList<QVariantMap> &dataLi
 
     QSet<int> roles;
 
-    int i = 0;
-    for (auto it = m_data.begin() + position; it < m_data.begin() + position + dataList.count(); ++it) {
-        const QVariantMap newValues = dataList[i];
-        for (auto newIt = newValues.begin(); newIt != newValues.end(); ++newIt) {
-            (*it)[newIt.key()] = newIt.value();
-            roles.insert(m_roles.key(newIt.key().toUtf8()));
+    for (int i = 0; i < dataList.count(); ++i) {
+        QVector<QVariant> &row = m_data[position + i];
+        const QVariantMap &newValues = dataList[i];
+        for (auto newIt = newValues.constBegin(); newIt != newValues.constEnd(); ++newIt) {
+            const int column = m_columns.value(newIt.key(), -1);
+            if (column < 0) {
+                continue;
+            }
+            row[column] = newIt.value();
+            roles.insert(column + Qt::UserRole + 1);
         }
-        ++i;
     }
     emit dataChanged(index(position, 0), index(position + dataList.length() - 1, 0), roles.values().toVector());
 }
 
+void SessionDataModel::replaceData(const QList<QVariantMap> &dataList, const QString &identityKey)
+{
+    // The whole list is here now
+    setPaged(-1, m_pageSize);
+
+    if (m_data.isEmpty()) {
+        insertData(0, dataList);
+        return;
+    }
+    if (dataList.isEmpty()) {
+        removeRows(0, m_data.count());
+        return;
+    }
+
+    if (!identityKey.isEmpty()) {
+        replaceDataByIdentity(dataList, identityKey);
+    } else {
+        replaceDataByPosition(dataList);
+    }
+}
+
+bool SessionDataModel::updateRow(int row, const QVariantMap &newItem, QSet<int> &roles)
+{
+    QVector<QVariant> &item = m_data[row];
+    const QVector<QVariant> newRow = rowFromMap(newItem);
+    bool changed = false;
+
+    for (int column = 0; column < newRow.count(); ++column) {
+        if (item[column] != newRow[column]) {
+            roles.insert(column + Qt::UserRole + 1);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        item = newRow;
+    }
+    return changed;
+}
+
+void SessionDataModel::replaceDataByPosition(const QList<QVariantMap> &dataList)
+{
+    const int common = qMin(m_data.count(), dataList.count());
+
+    // Contiguous changed rows are notified together
+    int firstChanged = -1;
+    QSet<int> roles;
+    for (int row = 0; row < common; ++row) {
+        if (updateRow(row, dataList[row], roles)) {
+            if (firstChanged < 0) {
+                firstChanged = row;
+            }
+        } else if (firstChanged >= 0) {
+            emit dataChanged(index(firstChanged, 0), index(row - 1, 0), roles.values().toVector());
+            firstChanged = -1;
+            roles.clear();
+        }
+    }
+    if (firstChanged >= 0) {
+        emit dataChanged(index(firstChanged, 0), index(common - 1, 0), roles.values().toVector());
+    }
+
+    if (m_data.count() > common) {
+        removeRows(common, m_data.count() - common);
+    } else if (dataList.count() > common) {
+        insertData(common, dataList.mid(common));
+    }
+}
+
+void SessionDataModel::replaceDataByIdentity(const QList<QVariantMap> &dataList, const QString &identityKey)
+{
+    QSet<QString> newIds;
+    QStringList newIdList;
+    newIdList.reserve(dataList.count());
+
+    for (const auto &item : dataList) {
+        const QVariant id = item.value(identityKey);
+        if (!id.isValid() || newIds.contains(id.toString())) {
+            qWarning() << "Items without an unique" << identityKey << ", comparing them by position";
+            replaceDataByPosition(dataList);
+            return;
+        }
+        newIds.insert(id.toString());
+        newIdList << id.toString();
+    }
+
+    const int idColumn = m_columns.value(identityKey, -1);
+    if (idColumn < 0) {
+        qWarning() << identityKey << "is not a role of the model, comparing items by position";
+        replaceDataByPosition(dataList);
+        return;
+    }
+
+    QSet<QString> oldIds;
+    for (const auto &item : m_data) {
+        const QVariant &id = item[idColumn];
+        if (!id.isValid() || oldIds.contains(id.toString())) {
+            replaceDataByPosition(dataList);
+            return;
+        }
+        oldIds.insert(id.toString());
+    }
+
+    // First the rows that went away, from the bottom so positions stay valid, a run of rows at a time
+    for (int row = m_data.count() - 1; row >= 0;) {
+        if (newIds.contains(m_data[row][idColumn].toString())) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !newIds.contains(m_data[first - 1][idColumn].toString())) {
+            --first;
+        }
+        removeRows(first, row - first + 1);
+        row = first - 1;
+    }
+
+    // Then walk the new order: every row is either already in place, to be moved there or new
+    for (int row = 0; row < dataList.count(); ++row) {
+        const QString &id = newIdList[row];
+
+        if (row >= m_data.count() || m_data[row][idColumn].toString() != id) {
+            int from = -1;
+            if (oldIds.contains(id)) {
+                for (int i = row + 1; i < m_data.count(); ++i) {
+                    if (m_data[i][idColumn].toString() == id) {
+                        from = i;
+                        break;
+                    }
+                }
+            }
+
+            if (from < 0) {
+                insertData(row, {dataList[row]});
+                continue;
+            }
+
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_data.move(from, row);
+            endMoveRows();
+        }
+
+        QSet<int> roles;
+        if (updateRow(row, dataList[row], roles)) {
+            emit dataChanged(index(row, 0), index(row, 0), roles.values().toVector());
+        }
+    }
+}
+
+bool SessionDataModel::applyPatch(const SessionDataPatch &patch, int depth)
+{
+    if (depth >= patch.path.count()) {
+        return false;
+    }
+
+    bool ok = true;
+    const QString &rowSegment = patch.path[depth];
+    const int row = rowSegment == QLatin1String("-") ? m_data.count() : rowSegment.toInt(&ok);
+    if (!ok || row < 0 || row > m_data.count()) {
+        return false;
+    }
+
+    // The path addresses a whole row
+    if (depth == patch.path.count() - 1) {
+        if (patch.operation == SessionDataPatch::Add) {
+            if (patch.value.type() != QVariant::Map) {
+                return false;
+            }
+            insertData(row, {patch.value.toMap()});
+            return true;
+        } else if (row == m_data.count()) {
+            return false;
+        } else if (patch.operation == SessionDataPatch::Remove) {
+            return removeRows(row, 1);
+        }
+
+        if (patch.value.type() != QVariant::Map) {
+            return false;
+        }
+        QSet<int> roles;
+        if (updateRow(row, patch.value.toMap(), roles)) {
+            emit dataChanged(index(row, 0), index(row, 0), roles.values().toVector());
+        }
+        return true;
+    }
+
+    if (row == m_data.count()) {
+        return false;
+    }
+
+    // Otherwise a role of the row, or something nested in it
+    const QString &key = patch.path[depth + 1];
+    const int column = m_columns.value(key, -1);
+    if (column < 0) {
+        qWarning() << "Can't patch" << key << "which is not a role of the model";
+        return false;
+    }
+
+    QVariant &value = m_data[row][column];
+    if (depth + 1 == patch.path.count() - 1) {
+        if (patch.operation == SessionDataPatch::Remove) {
+            value = QVariant();
+        } else {
+            value = patch.value;
+        }
+    } else {
+        QVariant newValue = value;
+        if (!patch.applyTo(newValue, depth + 2)) {
+            return false;
+        }
+        value = newValue;
+    }
+
+    emit dataChanged(index(row, 0), index(row, 0), {column + Qt::UserRole + 1});
+    return true;
+}
+
 void SessionDataModel::clear()
 {
     beginResetModel();
@@ -121,13 +372,23 @@ bool SessionDataModel::moveRows(const QModelIndex &sourceParent, int sourceRow,
 
 bool SessionDataModel::removeRows(int row, int count, const QModelIndex &parent)
 {
-    if (row < 0 || count <= 0 || row + count > m_data.count() || parent.isValid()) {
+    // A paged list can lose items not fetched yet too
+    if (row < 0 || count <= 0 || row + count > listCount() || parent.isValid()) {
         return false;
     }
 
-    beginRemoveRows(parent, row, row + count - 1);
+    if (m_totalCount >= 0) {
+        m_totalCount -= count;
+    }
+
+    const int loaded = qMin(count, m_data.count() - row);
+    if (loaded <= 0) {
+        return true;
+    }
+
+    beginRemoveRows(parent, row, row + loaded - 1);
 
-    m_data.erase(m_data.begin() + row, m_data.begin() + row + count);
+    m_data.remove(row, loaded);
     endRemoveRows();
     return true;
 }
@@ -148,11 +409,32 @@ QVariant SessionDataModel::data(const QModelIndex &index, int role) const
     }
     const int row = index.row();
 
-    if (row < 0 || row >= m_data.count() || !m_roles.contains(role)) {
+    const int column = role - Qt::UserRole - 1;
+
+    if (row < 0 || row >= m_data.count() || column < 0 || column >= m_columns.count()) {
         return QVariant();
     }
 
-    return m_data[row][QString::fromUtf8(m_roles[role])];
+    return m_data[row][column];
+}
+
+QVariantMap SessionDataModel::rowData(int row) const
+{
+    QVariantMap item;
+
+    if (row < 0 || row >= m_data.count()) {
+        return item;
+    }
+
+    const QVector<QVariant> &values = m_data[row];
+    for (auto it = m_roles.constBegin(); it != m_roles.constEnd(); ++it) {
+        const QVariant &value = values[it.key() - Qt::UserRole - 1];
+        if (value.isValid()) {
+            item[QString::fromUtf8(it.value())] = value;
+        }
+    }
+
+    return item;
 }
 
 QHash<int, QByteArray> SessionDataModel::roleNames() const
@@ -160,3 +442,50 @@ QHash<int, QByteArray> SessionDataModel::roleNames() const
     return m_roles;
 }
 
+void SessionDataModel::setPaged(int totalCount, int pageSize)
+{
+    m_totalCount = totalCount < 0 ? -1 : totalCount;
+    m_pageSize = qMax(1, pageSize);
+    m_fetchPending = false;
+}
+
+int SessionDataModel::totalCount() const
+{
+    return m_totalCount;
+}
+
+int SessionDataModel::listCount() const
+{
+    return m_totalCount >= 0 ? m_totalCount : m_data.count();
+}
+
+int SessionDataModel::pageSize() const
+{
+    return m_pageSize;
+}
+
+void SessionDataModel::cancelFetch()
+{
+    m_fetchPending = false;
+}
+
+bool SessionDataModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid() || m_totalCount < 0 || m_fetchPending) {
+        return false;
+    }
+
+    return m_data.count() < m_totalCount;
+}
+
+void SessionDataModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    m_fetchPending = true;
+    m_fetchPosition = m_data.count();
+    emit fetchMoreRequested(m_data.count(), qMin(m_pageSize, m_totalCount - m_data.count()));
+}
+
@@ -18,9 +18,12 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QSet>
+#include <QVector>
 
 class AbstractDelegate;
 class DelegatesModel;
+struct SessionDataPatch;
 
 class SessionDataModel : public QAbstractListModel
 {
@@ -43,21 +46,97 @@ public:
      */
     void updateData(int position, const QList<QVariantMap> &dataList);
 
+    /**
+     * Replaces the whole contents of the model with dataList, notifying only what actually changed,
+     * so the views keep the delegates of the rows that are still there.
+     * @param identityKey if not empty, the key whose value identifies an item across updates:
+     *        items are then matched by it and moved around as needed. If empty, or if some item
+     *        doesn't have an unique value for it, items are compared by position.
+     */
+    void replaceData(const QList<QVariantMap> &dataList, const QString &identityKey = QString());
+
+    /**
+     * Applies a mycroft.session.patch operation in place. The path elements
+     * before depth address the model itself, then come a row number and a role name.
+     * Only the affected row is notified.
+     * @returns false if the path doesn't address anything in the model
+     */
+    bool applyPatch(const SessionDataPatch &patch, int depth);
+
     /**
      * clears the whole model
      */
     void clear();
 
+    /**
+     * @returns all the values of row, by role name
+     */
+    QVariantMap rowData(int row) const;
+
+    /**
+     * Puts the model in paged mode: the list on the server has totalCount items,
+     * of which only the first rowCount() are here. When the view needs more,
+     * fetchMoreRequested is emitted, asking for pageSize items at a time.
+     * A negative totalCount disables the paged mode.
+     */
+    void setPaged(int totalCount, int pageSize);
+
+    /**
+     * Total items of the list on the server side, -1 if not paged
+     */
+    int totalCount() const;
+
+    /**
+     * Items of the list on the server side: totalCount() if paged, rowCount() otherwise
+     */
+    int listCount() const;
+
+    /**
+     * Items asked to the server at a time in paged mode
+     */
+    int pageSize() const;
+
+    /**
+     * Forgets the page asked to the server, which isn't coming anymore,
+     * so that it can be asked again
+     */
+    void cancelFetch();
+
 //REIMPLEMENTED
     bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationChild) override;
     bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::UserRole + 1) const override;
     QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+Q_SIGNALS:
+    /**
+     * In paged mode, the view needs count more items starting from position
+     */
+    void fetchMoreRequested(int position, int count);
 
 private:
+    void replaceDataByPosition(const QList<QVariantMap> &dataList);
+    void replaceDataByIdentity(const QList<QVariantMap> &dataList, const QString &identityKey);
+    // Writes newItem in row, accumulating the changed roles
+    bool updateRow(int row, const QVariantMap &newItem, QSet<int> &roles);
+    // Converts an item in a row of m_data, with its values in role order
+    QVector<QVariant> rowFromMap(const QVariantMap &item) const;
+
     QHash<int, QByteArray> m_roles;
-    QList<QVariantMap> m_data;
+    // Role name -> column in the rows, column is role - Qt::UserRole - 1
+    QHash<QString, int> m_columns;
+    // Each row has a value for every role, invalid if missing
+    QVector<QVector<QVariant>> m_data;
+
+    int m_totalCount = -1;
+    int m_pageSize = 50;
+    // Don't ask again for the same page while the server is sending it
+    bool m_fetchPending = false;
+    // Where the page asked for goes, only its insertion clears m_fetchPending
+    int m_fetchPosition = 0;
 };
 
 
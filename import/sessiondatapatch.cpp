@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "sessiondatapatch.h"
+
+#include <QDebug>
+
+static QStringList parsePointer(const QString &pointer)
+{
+    QStringList path;
+
+    // The root itself can't be patched: top level keys are the minimum
+    if (!pointer.startsWith(QLatin1Char('/'))) {
+        return path;
+    }
+
+    const QStringList segments = pointer.mid(1).split(QLatin1Char('/'));
+    for (QString segment : segments) {
+        segment.replace(QStringLiteral("~1"), QStringLiteral("/"));
+        segment.replace(QStringLiteral("~0"), QStringLiteral("~"));
+        path << segment;
+    }
+
+    return path;
+}
+
+QList<SessionDataPatch> SessionDataPatch::fromVariant(const QVariant &data)
+{
+    QList<SessionDataPatch> patches;
+
+    if (data.type() != QVariant::List) {
+        qWarning() << "Error: mycroft.session.patch data is not an Array" << data;
+        return patches;
+    }
+
+    for (const auto &item : data.toList()) {
+        const QVariantMap map = item.toMap();
+        SessionDataPatch patch;
+
+        const QString op = map.value(QStringLiteral("op")).toString();
+        if (op == QLatin1String("add")) {
+            patch.operation = Add;
+        } else if (op == QLatin1String("replace")) {
+            patch.operation = Replace;
+        } else if (op == QLatin1String("remove")) {
+            patch.operation = Remove;
+        } else {
+            qWarning() << "Error: unknown operation in mycroft.session.patch:" << op;
+            return QList<SessionDataPatch>();
+        }
+
+        patch.path = parsePointer(map.value(QStringLiteral("path")).toString());
+        if (patch.path.isEmpty() || patch.path.first().isEmpty()) {
+            qWarning() << "Error: invalid path in mycroft.session.patch:" << map.value(QStringLiteral("path"));
+            return QList<SessionDataPatch>();
+        }
+
+        if (patch.operation != Remove) {
+            if (!map.contains(QStringLiteral("value"))) {
+                qWarning() << "Error: no value for the" << op << "operation in mycroft.session.patch";
+                return QList<SessionDataPatch>();
+            }
+            patch.value = map.value(QStringLiteral("value"));
+        }
+
+        patches << patch;
+    }
+
+    return patches;
+}
+
+bool SessionDataPatch::applyTo(QVariant &target, int depth) const
+{
+    if (depth < 0 || depth >= path.count()) {
+        return false;
+    }
+
+    const QString &segment = path[depth];
+    const bool last = depth == path.count() - 1;
+
+    // Containers are copied on write: only the ones along the path get detached
+    if (target.type() == QVariant::Map) {
+        QVariantMap map = target.toMap();
+
+        if (last) {
+            if (operation == Remove) {
+                if (map.remove(segment) == 0) {
+                    return false;
+                }
+            } else if (operation == Replace && !map.contains(segment)) {
+                // Only "add" creates keys
+                return false;
+            } else {
+                map[segment] = value;
+            }
+        } else {
+            auto it = map.find(segment);
+            if (it == map.end() || !applyTo(it.value(), depth + 1)) {
+                return false;
+            }
+        }
+
+        target = map;
+        return true;
+
+    } else if (target.type() == QVariant::List) {
+        QVariantList list = target.toList();
+
+        bool ok = true;
+        const int index = segment == QLatin1String("-") ? list.count() : segment.toInt(&ok);
+        if (!ok || index < 0 || index > list.count()) {
+            return false;
+        }
+
+        if (last && operation == Add) {
+            list.insert(index, value);
+        } else if (index == list.count()) {
+            // "-" or one past the end only make sense to append
+            return false;
+        } else if (last && operation == Remove) {
+            list.removeAt(index);
+        } else if (last) {
+            list[index] = value;
+        } else if (!applyTo(list[index], depth + 1)) {
+            return false;
+        }
+
+        target = list;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+
+/**
+ * One operation of a mycroft.session.patch message: changes a single
+ * value nested somewhere in the session data, addressed by a path in
+ * the JSON Pointer syntax, like "/forecast/2/temperature".
+ */
+struct SessionDataPatch
+{
+    enum Operation {
+        Invalid = 0,
+        Add, // inserts in a list, or sets a key of an object
+        Replace, // sets an existing element
+        Remove // removes an element of a list or a key of an object
+    };
+
+    /**
+     * @returns the operations contained in the "data" of a patch message,
+     * an empty list if any of them is malformed
+     */
+    static QList<SessionDataPatch> fromVariant(const QVariant &data);
+
+    /**
+     * Applies the operation on a nested value, which is the one addressed
+     * by the path elements before depth.
+     * @returns false if the path doesn't address an element of target
+     */
+    bool applyTo(QVariant &target, int depth) const;
+
+    Operation operation = Invalid;
+    // The path already split and unescaped
+    QStringList path;
+    QVariant value;
+};
+
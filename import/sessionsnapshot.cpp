@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "sessionsnapshot.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// "MGSS", then the version of the layout below
+static const quint32 s_magic = 0x4d475353;
+static const quint32 s_format = 1;
+static const int s_headerSize = 4 + 4 + 8 + 4;
+
+SessionSnapshot::SessionSnapshot(const QString &fileName)
+    : m_fileName(fileName)
+{
+}
+
+SessionSnapshot::~SessionSnapshot()
+{
+}
+
+QString SessionSnapshot::fileName() const
+{
+    return m_fileName;
+}
+
+bool SessionSnapshot::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < s_headerSize) {
+        return false;
+    }
+
+    uchar *memory = file.map(0, file.size());
+    if (!memory) {
+        qWarning() << "Can't map the session snapshot" << m_fileName << file.errorString();
+        return false;
+    }
+
+    // The stream copies the records out, nothing keeps pointing in the mapping
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char *>(memory), int(file.size()));
+    QDataStream stream(raw);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 magic = 0;
+    quint32 format = 0;
+    quint64 stateVersion = 0;
+    quint32 count = 0;
+    stream >> magic >> format >> stateVersion >> count;
+
+    bool valid = stream.status() == QDataStream::Ok && magic == s_magic && format == s_format;
+    QVector<Skill> skills;
+    QHash<QString, QByteArray> records;
+
+    for (quint32 i = 0; valid && i < count; ++i) {
+        QByteArray record;
+        Skill skill;
+        stream >> record;
+        valid = stream.status() == QDataStream::Ok && decode(record, skill) && !records.contains(skill.skillId);
+        if (valid) {
+            skills << skill;
+            records.insert(skill.skillId, record);
+        }
+    }
+
+    file.unmap(memory);
+
+    if (!valid) {
+        qWarning() << "Ignoring the corrupted session snapshot" << m_fileName;
+        return false;
+    }
+
+    m_loaded = skills;
+    m_records = records;
+    m_stateVersion = stateVersion;
+    return true;
+}
+
+QVector<SessionSnapshot::Skill> SessionSnapshot::skills() const
+{
+    return m_loaded;
+}
+
+quint64 SessionSnapshot::stateVersion() const
+{
+    return m_stateVersion;
+}
+
+void SessionSnapshot::setSkill(const Skill &skill)
+{
+    m_records[skill.skillId] = encode(skill);
+}
+
+bool SessionSnapshot::save(const QStringList &order, quint64 stateVersion)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << s_magic << s_format << stateVersion << quint32(order.count());
+
+    // Skills not active anymore are dropped along the way
+    QHash<QString, QByteArray> records;
+    for (const auto &skillId : order) {
+        QByteArray record = m_records.value(skillId);
+        if (record.isEmpty()) {
+            Skill skill;
+            skill.skillId = skillId;
+            record = encode(skill);
+        }
+        records.insert(skillId, record);
+        stream << record;
+    }
+    m_records = records;
+    m_stateVersion = stateVersion;
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+    // Never a half written file, even if the application dies meanwhile
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "Can't write the session snapshot" << m_fileName << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void SessionSnapshot::clear()
+{
+    m_records.clear();
+    m_loaded.clear();
+    m_stateVersion = 0;
+    QFile::remove(m_fileName);
+}
+
+QByteArray SessionSnapshot::encode(const Skill &skill)
+{
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << skill.skillId << skill.delegateUrls << qint32(skill.currentIndex) << skill.sessionData;
+
+    return record;
+}
+
+bool SessionSnapshot::decode(const QByteArray &record, Skill &skill)
+{
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    qint32 currentIndex = 0;
+    stream >> skill.skillId >> skill.delegateUrls >> currentIndex >> skill.sessionData;
+    skill.currentIndex = currentIndex;
+
+    return stream.status() == QDataStream::Ok && !skill.skillId.isEmpty();
+}
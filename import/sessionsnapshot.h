@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+/**
+ * The state of a skill view saved to a file, to show the last screen again
+ * right away when the application restarts, before the core sends it.
+ * Each skill is kept already encoded: a save only encodes again the skills
+ * given to setSkill() since the previous one. The writing is not
+ * incremental though: every save() rewrites the whole file, the unchanged
+ * skills included, through a QSaveFile, so that a crash leaves the previous
+ * file whole. The cost of a save grows with the size of all the saved
+ * state, not only with what changed. The file is mapped in memory to be
+ * read back.
+ */
+class SessionSnapshot
+{
+public:
+    struct Skill {
+        QString skillId;
+        QList<QUrl> delegateUrls;
+        int currentIndex = 0;
+        // As returned by SessionDataMap::serialize()
+        QByteArray sessionData;
+    };
+
+    explicit SessionSnapshot(const QString &fileName);
+    ~SessionSnapshot();
+
+    QString fileName() const;
+
+    /**
+     * Reads the file back
+     * @returns false if there is none or it's not a valid snapshot
+     */
+    bool load();
+
+    /**
+     * The skills as of the last load(), in the order of the active skills model
+     */
+    QVector<Skill> skills() const;
+
+    /**
+     * The number of gui messages the saved state is the result of
+     */
+    quint64 stateVersion() const;
+
+    /**
+     * Replaces what is saved for the skill, from the next save()
+     */
+    void setSkill(const Skill &skill);
+
+    /**
+     * Writes the file with the skills in order, skills without a setSkill() are saved without pages or data
+     * @returns false if the file couldn't be written
+     */
+    bool save(const QStringList &order, quint64 stateVersion);
+
+    /**
+     * Forgets all the skills and removes the file
+     */
+    void clear();
+
+private:
+    static QByteArray encode(const Skill &skill);
+    static bool decode(const QByteArray &record, Skill &skill);
+
+    QString m_fileName;
+    QHash<QString, QByteArray> m_records;
+    QVector<Skill> m_loaded;
+    quint64 m_stateVersion = 0;
+};
+
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "sessionstore.h"
+#include "sessiondatamap.h"
+
+#include <QDebug>
+
+SessionStore::SessionStore(QObject *parent)
+    : QObject(parent)
+{
+}
+
+SessionStore::~SessionStore()
+{
+}
+
+SessionDataMap *SessionStore::acquire(const QString &skillId, AbstractSkillView *writer)
+{
+    Entry &entry = m_entries[skillId];
+
+    if (!entry.map) {
+        entry.map = new SessionDataMap(skillId, writer, this);
+    }
+    ++entry.refCount;
+
+    return entry.map;
+}
+
+void SessionStore::release(const QString &skillId)
+{
+    auto it = m_entries.find(skillId);
+    if (it == m_entries.end()) {
+        qWarning() << "Releasing session data never acquired:" << skillId;
+        return;
+    }
+
+    if (--it->refCount > 0) {
+        return;
+    }
+
+    // The removed delegates can still be around for their animation
+    it->map->deleteLater();
+    m_entries.erase(it);
+}
+
+SessionDataMap *SessionStore::value(const QString &skillId) const
+{
+    return m_entries.value(skillId).map;
+}
+
+int SessionStore::refCount(const QString &skillId) const
+{
+    return m_entries.value(skillId).refCount;
+}
+
+int SessionStore::count() const
+{
+    return m_entries.count();
+}
+
+void SessionStore::setWriter(AbstractSkillView *writer)
+{
+    for (auto &entry : m_entries) {
+        entry.map->setView(writer);
+    }
+}
+
+#include "moc_sessionstore.cpp"
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+
+class AbstractSkillView;
+class SessionDataMap;
+
+/**
+ * The session data of the skills, when several views share a single gui
+ * connection: every update is applied once, to data every view binds to.
+ * Each view holds a reference on the skills it shows, the data of a skill
+ * is deleted when the last one lets it go.
+ */
+class SessionStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionStore(QObject *parent = nullptr);
+    ~SessionStore() override;
+
+    /**
+     * @returns the data of skillId with one more reference, created if needed.
+     * Changes done by the delegates are sent through writer.
+     */
+    SessionDataMap *acquire(const QString &skillId, AbstractSkillView *writer);
+
+    /**
+     * Drops a reference taken with acquire
+     */
+    void release(const QString &skillId);
+
+    /**
+     * @returns the data of skillId, without taking a reference, nullptr if nobody holds it
+     */
+    SessionDataMap *value(const QString &skillId) const;
+
+    int refCount(const QString &skillId) const;
+
+    /**
+     * Number of skills with data in the store
+     */
+    int count() const;
+
+    /**
+     * Sends the changes done by the delegates of all the skills through writer from now on
+     */
+    void setWriter(AbstractSkillView *writer);
+
+private:
+    struct Entry {
+        SessionDataMap *map = nullptr;
+        int refCount = 0;
+    };
+    QHash<QString, Entry> m_entries;
+};
+
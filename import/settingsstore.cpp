@@ -0,0 +1,189 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "settingsstore.h"
+#include "fileworker.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFileInfo>
+
+// What is read from the file is text: the same value set from code may have another type
+static bool sameValue(const QVariant &a, const QVariant &b)
+{
+    if (a == b) {
+        return true;
+    }
+
+    return a.isValid() && b.isValid() && a.canConvert<QString>() && b.canConvert<QString>()
+        && a.toString() == b.toString();
+}
+
+SettingsStore *SettingsStore::instance()
+{
+    static SettingsStore *s_self = nullptr;
+    if (!s_self) {
+        s_self = new SettingsStore;
+    }
+    return s_self;
+}
+
+SettingsStore::SettingsStore(QObject *parent)
+    : QObject(parent)
+{
+    for (const auto &key : m_settings.allKeys()) {
+        m_values.insert(key, m_settings.value(key));
+    }
+
+    m_thread.setObjectName(QStringLiteral("MycroftSettings"));
+
+    m_worker = new FileWorker;
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &FileWorker::settingsWritten, this, [this](const QString &fileName, bool ok) {
+        if (!ok) {
+            qWarning() << "Can't write the settings to" << fileName;
+        }
+        // Writing replaces the file, which drops it from the watcher
+        watchFile();
+    });
+
+    m_thread.start();
+
+    // A settings page usually changes a few of them in a row
+    m_syncTimer.setInterval(1000);
+    m_syncTimer.setSingleShot(true);
+    connect(&m_syncTimer, &QTimer::timeout, this, [this]() {
+        write(Qt::QueuedConnection);
+    });
+
+    // The timer may not get to run anymore
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &SettingsStore::sync);
+    }
+
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &SettingsStore::reload);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &SettingsStore::reload);
+    watchFile();
+}
+
+SettingsStore::~SettingsStore()
+{
+    sync();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    return m_values.value(key, defaultValue);
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    auto it = m_values.constFind(key);
+    if (it != m_values.constEnd() && sameValue(it.value(), value)) {
+        return;
+    }
+
+    m_values[key] = value;
+    m_pending[key] = value;
+
+    if (!m_syncTimer.isActive()) {
+        m_syncTimer.start();
+    }
+
+    emit valueChanged(key);
+}
+
+void SettingsStore::sync()
+{
+    write(Qt::BlockingQueuedConnection);
+}
+
+void SettingsStore::write(Qt::ConnectionType type)
+{
+    m_syncTimer.stop();
+
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    // After the writes queued before, if any
+    QMetaObject::invokeMethod(m_worker, "writeSettings", type, Q_ARG(QVariantHash, QVariantHash(m_pending)));
+    m_pending.clear();
+}
+
+void SettingsStore::reload()
+{
+    // Ours go first, then this brings in what the other processes wrote
+    sync();
+    m_settings.sync();
+
+    QHash<QString, QVariant> values;
+    for (const auto &key : m_settings.allKeys()) {
+        values.insert(key, m_settings.value(key));
+    }
+
+    // Our own writes come back here as well, they just make no difference
+    QStringList changed;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        auto old = m_values.constFind(it.key());
+        if (old == m_values.constEnd() || !sameValue(old.value(), it.value())) {
+            changed << it.key();
+        }
+    }
+    for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        if (!values.contains(it.key())) {
+            changed << it.key();
+        }
+    }
+
+    if (changed.isEmpty()) {
+        return;
+    }
+
+    // Keeps the values as they were set from code, for the ones which didn't change
+    for (const auto &key : changed) {
+        if (values.contains(key)) {
+            m_values[key] = values.value(key);
+        } else {
+            m_values.remove(key);
+        }
+    }
+
+    for (const auto &key : changed) {
+        emit valueChanged(key);
+    }
+}
+
+void SettingsStore::watchFile()
+{
+    const QString fileName = m_settings.fileName();
+
+    if (QFileInfo::exists(fileName) && !m_watcher.files().contains(fileName)) {
+        m_watcher.addPath(fileName);
+    }
+
+    // The directory sees the file coming back, if it was ever removed
+    const QString directory = QFileInfo(fileName).absolutePath();
+    if (QFileInfo::exists(directory) && !m_watcher.directories().contains(directory)) {
+        m_watcher.addPath(directory);
+    }
+}
+
+#include "moc_settingsstore.cpp"
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include <QVariant>
+
+class FileWorker;
+
+/**
+ * The application settings, shared by the whole process: values are read
+ * once and then served from memory, writes reach the disk a bit later, all
+ * together, from a thread of their own. Changes done to the file by other processes are picked up, and
+ * every change is announced with valueChanged, whoever did it.
+ */
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SettingsStore *instance();
+    ~SettingsStore() override;
+
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    void setValue(const QString &key, const QVariant &value);
+
+    /**
+     * Writes the pending changes right away, waiting for them to be on disk
+     */
+    void sync();
+
+Q_SIGNALS:
+    void valueChanged(const QString &key);
+
+private:
+    SettingsStore(QObject *parent = nullptr);
+
+    // Hands the pending changes to the worker
+    void write(Qt::ConnectionType type);
+    // Reads the file again, after someone else changed it
+    void reload();
+    void watchFile();
+
+    QSettings m_settings;
+    QHash<QString, QVariant> m_values;
+    // Set since the last sync
+    QHash<QString, QVariant> m_pending;
+    QFileSystemWatcher m_watcher;
+    QTimer m_syncTimer;
+    QThread m_thread;
+    FileWorker *m_worker;
+};
+
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "skillindex.h"
+
+#include <QDebug>
+
+SkillIndex::SkillIndex(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    qRegisterMetaType<SkillIndexEntry>();
+    qRegisterMetaType<QVector<SkillIndexEntry>>();
+
+    m_thread.setObjectName(QStringLiteral("MycroftSkillIndex"));
+
+    m_worker = new FileWorker;
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &FileWorker::skillsScanned, this, &SkillIndex::onSkillsScanned);
+
+    m_thread.start();
+
+    m_scanTimer.setSingleShot(true);
+    connect(&m_scanTimer, &QTimer::timeout, this, &SkillIndex::scan);
+
+    // Installing or updating a skill touches many files: scanned once it settles
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        scheduleScan(250);
+    });
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        scheduleScan(250);
+    });
+}
+
+SkillIndex::~SkillIndex()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QString SkillIndex::rootPath() const
+{
+    return m_rootPath;
+}
+
+void SkillIndex::setRootPath(const QString &path)
+{
+    if (m_rootPath == path) {
+        return;
+    }
+
+    m_rootPath = path;
+
+    if (!m_entries.isEmpty()) {
+        beginResetModel();
+        m_entries.clear();
+        endResetModel();
+        emit countChanged();
+    }
+    updateWatches(QStringList());
+
+    emit rootPathChanged();
+    // Both properties are usually set together
+    scheduleScan(0);
+}
+
+QString SkillIndex::metaFile() const
+{
+    return m_metaFile;
+}
+
+void SkillIndex::setMetaFile(const QString &file)
+{
+    if (m_metaFile == file) {
+        return;
+    }
+
+    m_metaFile = file;
+    emit metaFileChanged();
+    scheduleScan(0);
+}
+
+bool SkillIndex::scanning() const
+{
+    return m_scanning;
+}
+
+QVariantMap SkillIndex::get(int row) const
+{
+    QVariantMap values;
+
+    if (row < 0 || row >= m_entries.count()) {
+        return values;
+    }
+
+    const QModelIndex idx = index(row, 0);
+    const auto roles = roleNames();
+    for (auto it = roles.constBegin(); it != roles.constEnd(); ++it) {
+        values[QString::fromLatin1(it.value())] = data(idx, it.key());
+    }
+
+    return values;
+}
+
+void SkillIndex::scheduleScan(int delay)
+{
+    if (m_rootPath.isEmpty() || m_metaFile.isEmpty()) {
+        return;
+    }
+
+    m_scanTimer.start(delay);
+}
+
+void SkillIndex::scan()
+{
+    if (m_scanning) {
+        m_rescan = true;
+        return;
+    }
+
+    m_scanning = true;
+    emit scanningChanged();
+
+    QMetaObject::invokeMethod(m_worker, "scanSkills", Qt::QueuedConnection,
+                              Q_ARG(QString, m_rootPath), Q_ARG(QString, m_metaFile));
+}
+
+void SkillIndex::onSkillsScanned(const QString &rootPath, const QVector<SkillIndexEntry> &entries, const QStringList &directories)
+{
+    m_scanning = false;
+
+    // What arrived is already out of date
+    if (m_rescan || rootPath != m_rootPath) {
+        m_rescan = false;
+        scan();
+        return;
+    }
+
+    const int oldCount = m_entries.count();
+
+    // Both lists are sorted by path: one pass finds what was removed, added and changed
+    int row = 0;
+    int i = 0;
+    while (row < m_entries.count() || i < entries.count()) {
+        if (i >= entries.count() || (row < m_entries.count() && m_entries[row].path < entries[i].path)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_entries.remove(row);
+            endRemoveRows();
+
+        } else if (row >= m_entries.count() || entries[i].path < m_entries[row].path) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_entries.insert(row, entries[i]);
+            endInsertRows();
+            ++row;
+            ++i;
+
+        } else {
+            SkillIndexEntry &entry = m_entries[row];
+            if (entry.modified != entries[i].modified || entry.size != entries[i].size || entry.content != entries[i].content) {
+                entry = entries[i];
+                const QModelIndex idx = index(row, 0);
+                emit dataChanged(idx, idx);
+            }
+            ++row;
+            ++i;
+        }
+    }
+
+    updateWatches(directories);
+
+    emit scanningChanged();
+    if (m_entries.count() != oldCount) {
+        emit countChanged();
+    }
+    emit scanned();
+}
+
+void SkillIndex::updateWatches(const QStringList &directories)
+{
+    QSet<QString> wanted;
+    if (!m_rootPath.isEmpty()) {
+        wanted.insert(m_rootPath);
+    }
+    // New skills show up in the root, metadata files added to a skill in its directory
+    for (const auto &directory : directories) {
+        wanted.insert(directory);
+    }
+    // Metadata files edited in place
+    for (const auto &entry : m_entries) {
+        wanted.insert(entry.metaPath);
+    }
+
+    QStringList stale;
+    for (const auto &path : m_watcher.files() + m_watcher.directories()) {
+        if (!wanted.remove(path)) {
+            stale << path;
+        }
+    }
+    if (!stale.isEmpty()) {
+        m_watcher.removePaths(stale);
+    }
+
+    QStringList added;
+    for (const auto &path : wanted) {
+        added << path;
+    }
+    if (!added.isEmpty()) {
+        m_watcher.addPaths(added);
+    }
+}
+
+int SkillIndex::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return m_entries.count();
+}
+
+QVariant SkillIndex::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_entries.count()) {
+        return QVariant();
+    }
+
+    const SkillIndexEntry &entry = m_entries[index.row()];
+
+    switch (role) {
+    case SkillPath:
+        return entry.path;
+    case SkillName:
+        return entry.name;
+    case MetaPath:
+        return entry.metaPath;
+    case MetaContent:
+        return QString::fromUtf8(entry.content);
+    case Modified:
+        return entry.modified;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> SkillIndex::roleNames() const
+{
+    return {
+        {SkillPath, "skillPath"},
+        {SkillName, "skillName"},
+        {MetaPath, "metaPath"},
+        {MetaContent, "metaContent"},
+        {Modified, "modified"}
+    };
+}
+
+#include "moc_skillindex.cpp"
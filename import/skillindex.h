@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include "fileworker.h"
+
+#include <QAbstractListModel>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+
+/**
+ * The skills installed in a directory which have a given metadata file,
+ * like their README.md, together with its content. Directories are
+ * scanned and files read in a thread, the model follows the changes on
+ * disk: only the skills added, removed or whose metadata changed are
+ * updated, and only their files read again.
+ */
+class SkillIndex : public QAbstractListModel
+{
+    Q_OBJECT
+    /**
+     * The directory the skills are installed in, like /opt/mycroft/skills
+     */
+    Q_PROPERTY(QString rootPath READ rootPath WRITE setRootPath NOTIFY rootPathChanged)
+    /**
+     * Name of the file the skill directories must contain, README.md by default
+     */
+    Q_PROPERTY(QString metaFile READ metaFile WRITE setMetaFile NOTIFY metaFileChanged)
+    // True until the model reflects the directory as it is on disk
+    Q_PROPERTY(bool scanning READ scanning NOTIFY scanningChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        SkillPath = Qt::UserRole + 1,
+        SkillName,
+        MetaPath,
+        MetaContent,
+        Modified
+    };
+
+    explicit SkillIndex(QObject *parent = nullptr);
+    ~SkillIndex() override;
+
+    QString rootPath() const;
+    void setRootPath(const QString &path);
+
+    QString metaFile() const;
+    void setMetaFile(const QString &file);
+
+    bool scanning() const;
+
+    /**
+     * @returns the roles of row, by their name
+     */
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+//REIMPLEMENTED
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = SkillPath) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+Q_SIGNALS:
+    void rootPathChanged();
+    void metaFileChanged();
+    void scanningChanged();
+    void countChanged();
+    // The model was updated after a scan, whether something changed or not
+    void scanned();
+
+private:
+    void scheduleScan(int delay);
+    void scan();
+    void onSkillsScanned(const QString &rootPath, const QVector<SkillIndexEntry> &entries, const QStringList &directories);
+    // Moves the watches to the paths of the last scan
+    void updateWatches(const QStringList &directories);
+
+    QString m_rootPath;
+    QString m_metaFile = QStringLiteral("README.md");
+    QVector<SkillIndexEntry> m_entries;
+
+    QThread m_thread;
+    FileWorker *m_worker;
+    QFileSystemWatcher m_watcher;
+    QTimer m_scanTimer;
+    bool m_scanning = false;
+    // Something changed while a scan was running
+    bool m_rescan = false;
+};
+
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "skilltranslator.h"
+
+#include <QCoreApplication>
+#include <QLocale>
+#include <QRunnable>
+
+class TranslationLoadJob : public QRunnable
+{
+public:
+    TranslationLoadJob(SkillTranslator *receiver, const QString &skillId, const QString &directory)
+        : m_receiver(receiver),
+          m_skillId(skillId),
+          m_directory(directory)
+    {
+    }
+
+    void run() override
+    {
+        // QTranslator maps the .qm file in memory where possible, rather than reading it
+        QTranslator *translator = new QTranslator;
+        if (translator->load(QLocale(), m_skillId, QStringLiteral("_"), m_directory)) {
+            translator->moveToThread(m_receiver->thread());
+        } else {
+            delete translator;
+            translator = nullptr;
+        }
+
+        QMetaObject::invokeMethod(m_receiver, "addTranslator", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_skillId), Q_ARG(QTranslator *, translator));
+    }
+
+private:
+    SkillTranslator *m_receiver;
+    QString m_skillId;
+    QString m_directory;
+};
+
+SkillTranslator::SkillTranslator(QObject *parent)
+    : QTranslator(parent)
+{
+    qRegisterMetaType<QTranslator *>();
+    m_loadingPool.setMaxThreadCount(1);
+}
+
+SkillTranslator::~SkillTranslator()
+{
+    // The jobs still running point to us
+    m_loadingPool.clear();
+    m_loadingPool.waitForDone();
+
+    // The translators of the finished jobs are in calls still queued, which would be dropped with them
+    m_destroying = true;
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    qDeleteAll(m_translators);
+}
+
+SkillTranslator::Status SkillTranslator::status(const QString &skillId) const
+{
+    return m_status.value(skillId, NotLoaded);
+}
+
+void SkillTranslator::load(const QString &skillId, const QString &directory)
+{
+    if (status(skillId) != NotLoaded) {
+        return;
+    }
+
+    m_status[skillId] = Loading;
+    m_loadingPool.start(new TranslationLoadJob(this, skillId, directory));
+}
+
+bool SkillTranslator::isEmpty() const
+{
+    return m_translators.isEmpty();
+}
+
+QString SkillTranslator::translate(const char *context, const char *sourceText, const char *disambiguation, int n) const
+{
+    for (auto translator : m_translators) {
+        const QString result = translator->translate(context, sourceText, disambiguation, n);
+        if (!result.isNull()) {
+            return result;
+        }
+    }
+
+    return QString();
+}
+
+void SkillTranslator::addTranslator(const QString &skillId, QTranslator *translator)
+{
+    if (m_destroying) {
+        delete translator;
+        return;
+    }
+
+    m_status[skillId] = Loaded;
+
+    if (translator) {
+        delete m_translators.value(skillId);
+        m_translators[skillId] = translator;
+    }
+
+    emit loaded(skillId);
+}
+
+#include "moc_skilltranslator.cpp"
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QThreadPool>
+#include <QTranslator>
+
+/**
+ * The translations of all the skills, installed once application-wide.
+ * The .qm file of each skill is loaded in a background thread the first time
+ * the skill shows a page and kept for the whole session, even if the skill
+ * gets deactivated. Adding the translations of a skill doesn't install a new
+ * translator, so it doesn't cause a LanguageChange of the whole application.
+ */
+class SkillTranslator : public QTranslator
+{
+    Q_OBJECT
+
+public:
+    enum Status {
+        NotLoaded = 0,
+        Loading,
+        Loaded // The skill may have no translations for the current locale
+    };
+
+    explicit SkillTranslator(QObject *parent = nullptr);
+    ~SkillTranslator() override;
+
+    Status status(const QString &skillId) const;
+
+    /**
+     * Starts loading the translations of skillId from directory,
+     * emits loaded when done
+     */
+    void load(const QString &skillId, const QString &directory);
+
+    bool isEmpty() const override;
+    QString translate(const char *context, const char *sourceText, const char *disambiguation = nullptr, int n = -1) const override;
+
+Q_SIGNALS:
+    void loaded(const QString &skillId);
+
+private Q_SLOTS:
+    // translator is nullptr if the skill has no translations
+    void addTranslator(const QString &skillId, QTranslator *translator);
+
+private:
+    QHash<QString, Status> m_status;
+    QHash<QString, QTranslator *> m_translators;
+    QThreadPool m_loadingPool;
+    // Pending results are only collected, nobody is told anymore
+    bool m_destroying = false;
+};
+
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "socketconnection.h"
+
+#include <QDebug>
+
+SocketConnection::SocketConnection(SocketWorker::Decoder decoder, QObject *parent)
+    : QObject(parent)
+{
+    // Everything crossing the thread boundary must be known to the meta type system
+    qRegisterMetaType<GuiMessage>();
+    qRegisterMetaType<QAbstractSocket::SocketState>();
+    qRegisterMetaType<QAbstractSocket::SocketError>();
+
+    m_thread.setObjectName(decoder == SocketWorker::GuiDecoder ? QStringLiteral("MycroftGuiSocket") : QStringLiteral("MycroftBusSocket"));
+
+    m_worker = new SocketWorker(decoder);
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    connect(m_worker, &SocketWorker::stateChanged, this,
+            [this](QAbstractSocket::SocketState state) {
+                m_state = state;
+                emit stateChanged(state);
+            });
+    connect(m_worker, &SocketWorker::connected, this, &SocketConnection::connected);
+    connect(m_worker, &SocketWorker::disconnected, this, &SocketConnection::disconnected);
+    connect(m_worker, &SocketWorker::error, this, &SocketConnection::error);
+    connect(m_worker, &SocketWorker::pong, this, &SocketConnection::pong);
+    connect(m_worker, &SocketWorker::busMessageReceived, this, &SocketConnection::busMessageReceived);
+    connect(m_worker, &SocketWorker::guiMessageReceived, this, &SocketConnection::guiMessageReceived);
+
+    m_thread.start();
+}
+
+SocketConnection::~SocketConnection()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QAbstractSocket::SocketState SocketConnection::state() const
+{
+    return m_state;
+}
+
+void SocketConnection::open(const QUrl &url)
+{
+    QMetaObject::invokeMethod(m_worker, "open", Qt::QueuedConnection, Q_ARG(QUrl, url));
+}
+
+void SocketConnection::close()
+{
+    QMetaObject::invokeMethod(m_worker, "close", Qt::QueuedConnection);
+}
+
+void SocketConnection::sendTextMessage(const QString &message)
+{
+    QMetaObject::invokeMethod(m_worker, "sendTextMessage", Qt::QueuedConnection, Q_ARG(QString, message));
+}
+
+void SocketConnection::sendBinaryMessage(const QByteArray &message)
+{
+    QMetaObject::invokeMethod(m_worker, "sendBinaryMessage", Qt::QueuedConnection, Q_ARG(QByteArray, message));
+}
+
+void SocketConnection::ping()
+{
+    QMetaObject::invokeMethod(m_worker, "ping", Qt::QueuedConnection);
+}
+
+void SocketConnection::setMessageFilter(const QStringList &prefixes, const QStringList &allowed)
+{
+    QMetaObject::invokeMethod(m_worker, "setMessageFilter", Qt::QueuedConnection,
+                              Q_ARG(QStringList, prefixes), Q_ARG(QStringList, allowed));
+}
+
+#include "moc_socketconnection.cpp"
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include "socketworker.h"
+
+#include <QObject>
+#include <QThread>
+
+/**
+ * A web socket connection whose I/O and message decoding happen in a
+ * thread of its own. Lives in the GUI thread and mirrors the socket state,
+ * so it can be used like a QWebSocket. What arrives gets delivered already
+ * decoded, leaving to the GUI thread only the update of the models.
+ */
+class SocketConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SocketConnection(SocketWorker::Decoder decoder, QObject *parent = nullptr);
+    ~SocketConnection() override;
+
+    /**
+     * Last state reported by the socket thread
+     */
+    QAbstractSocket::SocketState state() const;
+
+    void open(const QUrl &url);
+    void close();
+    void sendTextMessage(const QString &message);
+    void sendBinaryMessage(const QByteArray &message);
+    void ping();
+
+    /**
+     * @see SocketWorker::setMessageFilter
+     */
+    void setMessageFilter(const QStringList &prefixes, const QStringList &allowed);
+
+Q_SIGNALS:
+    void connected();
+    void disconnected();
+    void stateChanged(QAbstractSocket::SocketState state);
+    void error(QAbstractSocket::SocketError error);
+    void pong(quint64 elapsedTime);
+
+    void busMessageReceived(const QString &type, const QJsonDocument &doc);
+    void guiMessageReceived(const GuiMessage &message);
+
+private:
+    QThread m_thread;
+    SocketWorker *m_worker;
+    QAbstractSocket::SocketState m_state = QAbstractSocket::UnconnectedState;
+};
+
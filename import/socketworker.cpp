@@ -0,0 +1,300 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "socketworker.h"
+#include "metrics.h"
+#include "trafficrecorder.h"
+
+#include <QDebug>
+#include <QJsonObject>
+#include <QWebSocket>
+
+#ifdef MYCROFT_GUI_HAVE_CBOR
+#include <QCborMap>
+#include <QCborValue>
+#endif
+
+// Extracts the value of the top level "type" key by walking the raw text,
+// without building any document. Returns an empty string when the message
+// doesn't look like a plain JSON object with a simple string type, in which
+// case the caller should fall back to a full parse.
+static QString scanMessageType(const QString &message)
+{
+    const QChar *c = message.constData();
+    const QChar *end = c + message.size();
+    int depth = 0;
+    bool expectKey = false;
+
+    while (c < end) {
+        const ushort ch = c->unicode();
+
+        if (ch == '"') {
+            const QChar *start = ++c;
+            bool escaped = false;
+            bool hasEscapes = false;
+            while (c < end && (escaped || c->unicode() != '"')) {
+                escaped = !escaped && c->unicode() == '\\';
+                hasEscapes = hasEscapes || escaped;
+                ++c;
+            }
+            if (c >= end) {
+                return QString();
+            }
+            const int length = c - start;
+            ++c;
+
+            if (depth != 1 || !expectKey) {
+                continue;
+            }
+            expectKey = false;
+
+            if (hasEscapes || QString::fromRawData(start, length) != QLatin1String("type")) {
+                continue;
+            }
+
+            // Found the key, the value must follow
+            while (c < end && (c->isSpace() || c->unicode() == ':')) {
+                ++c;
+            }
+            if (c >= end || c->unicode() != '"') {
+                return QString();
+            }
+            const QChar *valueStart = ++c;
+            while (c < end && c->unicode() != '"') {
+                if (c->unicode() == '\\') {
+                    return QString();
+                }
+                ++c;
+            }
+            if (c >= end) {
+                return QString();
+            }
+            return QString(valueStart, c - valueStart);
+        }
+
+        switch (ch) {
+        case '{':
+            ++depth;
+            expectKey = depth == 1;
+            break;
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            --depth;
+            break;
+        case ',':
+            expectKey = depth == 1;
+            break;
+        default:
+            break;
+        }
+        ++c;
+    }
+
+    return QString();
+}
+
+SocketWorker::SocketWorker(Decoder decoder, QObject *parent)
+    : QObject(parent),
+      m_decoder(decoder)
+{
+    // Child of the worker, so it follows it when moved to its thread
+    m_socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+
+    connect(m_socket, &QWebSocket::connected, this, &SocketWorker::connected);
+    connect(m_socket, &QWebSocket::disconnected, this, &SocketWorker::disconnected);
+    connect(m_socket, &QWebSocket::stateChanged, this, &SocketWorker::stateChanged);
+    connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this, &SocketWorker::error);
+    connect(m_socket, &QWebSocket::textMessageReceived, this, &SocketWorker::onTextMessageReceived);
+    connect(m_socket, &QWebSocket::binaryMessageReceived, this, &SocketWorker::onBinaryMessageReceived);
+    connect(m_socket, &QWebSocket::pong, this, [this](quint64 elapsedTime) {
+        emit pong(elapsedTime);
+    });
+}
+
+SocketWorker::~SocketWorker()
+{
+}
+
+void SocketWorker::open(const QUrl &url)
+{
+    m_socket->open(url);
+}
+
+void SocketWorker::close()
+{
+    m_socket->close();
+}
+
+void SocketWorker::ping()
+{
+    m_socket->ping();
+}
+
+void SocketWorker::sendTextMessage(const QString &message)
+{
+    m_socket->sendTextMessage(message);
+}
+
+void SocketWorker::sendBinaryMessage(const QByteArray &message)
+{
+    m_socket->sendBinaryMessage(message);
+}
+
+void SocketWorker::setMessageFilter(const QStringList &prefixes, const QStringList &allowed)
+{
+    m_filteredPrefixes = prefixes;
+    m_allowedTypes = QSet<QString>::fromList(allowed);
+}
+
+bool SocketWorker::isMessageTypeFiltered(const QString &type) const
+{
+    if (m_allowedTypes.contains(type)) {
+        return false;
+    }
+
+    for (const auto &prefix : m_filteredPrefixes) {
+        if (type.startsWith(prefix)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SocketWorker::onTextMessageReceived(const QString &message)
+{
+    // Everything as it came, the filtered noise too: it's part of the load
+    TrafficRecorder *recorder = TrafficRecorder::instance();
+    if (recorder->isRecording()) {
+        recorder->record(m_decoder == BusDecoder ? Metrics::BusChannel : Metrics::GuiChannel, message.toUtf8(), false);
+    }
+
+    if (m_decoder == BusDecoder) {
+        decodeBusMessage(message);
+    } else {
+        decodeGuiMessage(message);
+    }
+}
+
+void SocketWorker::decodeBusMessage(const QString &message)
+{
+    //filter out the noise before paying for a full parse, also so we can print debug stuff later without drowning in noise
+    const QString scannedType = scanMessageType(message);
+    if (!scannedType.isEmpty() && isMessageTypeFiltered(scannedType)) {
+        return;
+    }
+
+    const qint64 start = Metrics::instance()->enabled() ? Metrics::now() : 0;
+    const QByteArray utf8 = message.toUtf8();
+    auto doc = QJsonDocument::fromJson(utf8);
+
+    if (doc.isEmpty()) {
+        qWarning() << "Empty or invalid JSON message arrived on the main socket:" << message;
+        return;
+    }
+
+    auto type = doc[QStringLiteral("type")].toString();
+
+    if (type.isEmpty()) {
+        qWarning() << "Empty type in the JSON message on the main socket";
+        return;
+    }
+
+    //the scanner couldn't tell the type, filter now
+    if (scannedType.isEmpty() && isMessageTypeFiltered(type)) {
+        return;
+    }
+
+    if (start > 0) {
+        Metrics::instance()->recordMessage(Metrics::BusChannel, type, utf8.size(), Metrics::now() - start);
+    }
+
+    emit busMessageReceived(type, doc);
+}
+
+void SocketWorker::decodeGuiMessage(const QString &message)
+{
+    const qint64 start = Metrics::instance()->enabled() ? Metrics::now() : 0;
+    const QByteArray utf8 = message.toUtf8();
+    QJsonParseError parseError;
+    auto doc = QJsonDocument::fromJson(utf8, &parseError);
+
+    if (doc.isEmpty()) {
+        qWarning() << "Empty or invalid JSON message arrived on the gui socket:" << message << "Error:" << parseError.errorString();
+        return;
+    }
+
+    GuiMessage guiMessage = GuiMessage::fromJson(doc.object());
+
+    if (guiMessage.typeName.isEmpty()) {
+        qWarning() << "Empty type in the JSON message on the gui socket";
+        return;
+    }
+
+    if (start > 0) {
+        guiMessage.receivedAt = start;
+        Metrics::instance()->recordMessage(Metrics::GuiChannel, guiMessage.typeName, utf8.size(), Metrics::now() - start);
+    }
+
+    emit guiMessageReceived(guiMessage);
+}
+
+void SocketWorker::onBinaryMessageReceived(const QByteArray &message)
+{
+    TrafficRecorder *recorder = TrafficRecorder::instance();
+    if (recorder->isRecording()) {
+        recorder->record(m_decoder == BusDecoder ? Metrics::BusChannel : Metrics::GuiChannel, message, true);
+    }
+
+    if (m_decoder != GuiDecoder) {
+        qWarning() << "Unexpected binary message on the main socket";
+        return;
+    }
+
+#ifdef MYCROFT_GUI_HAVE_CBOR
+    const qint64 start = Metrics::instance()->enabled() ? Metrics::now() : 0;
+    QCborParserError parseError;
+    const QCborValue value = QCborValue::fromCbor(message, &parseError);
+
+    if (parseError.error != QCborError::NoError || !value.isMap()) {
+        qWarning() << "Invalid CBOR message arrived on the gui socket, Error:" << parseError.errorString();
+        return;
+    }
+
+    GuiMessage guiMessage = GuiMessage::fromCbor(value.toMap());
+
+    if (guiMessage.typeName.isEmpty()) {
+        qWarning() << "Empty type in the CBOR message on the gui socket";
+        return;
+    }
+
+    if (start > 0) {
+        guiMessage.receivedAt = start;
+        Metrics::instance()->recordMessage(Metrics::GuiChannel, guiMessage.typeName, message.size(), Metrics::now() - start);
+    }
+
+    emit guiMessageReceived(guiMessage);
+#else
+    Q_UNUSED(message)
+    qWarning() << "Binary message arrived on the gui socket, but CBOR framing is not supported by this build";
+#endif
+}
+
+#include "moc_socketworker.cpp"
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include "guimessage.h"
+
+#include <QObject>
+#include <QAbstractSocket>
+#include <QJsonDocument>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+class QWebSocket;
+
+/**
+ * @internal Owns a web socket and decodes what arrives on it.
+ * Lives in the thread of a SocketConnection and is only ever
+ * talked to with queued signals and slots.
+ */
+class SocketWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Decoder {
+        BusDecoder, // messages of the core bus, as JSON documents
+        GuiDecoder // messages of the gui protocol, as GuiMessage
+    };
+
+    explicit SocketWorker(Decoder decoder, QObject *parent = nullptr);
+    ~SocketWorker() override;
+
+public Q_SLOTS:
+    void open(const QUrl &url);
+    void close();
+    void sendTextMessage(const QString &message);
+    void sendBinaryMessage(const QByteArray &message);
+    void ping();
+
+    /**
+     * Bus messages whose type starts with one of prefixes, and is not in allowed, are dropped
+     */
+    void setMessageFilter(const QStringList &prefixes, const QStringList &allowed);
+
+Q_SIGNALS:
+    void connected();
+    void disconnected();
+    void stateChanged(QAbstractSocket::SocketState state);
+    void error(QAbstractSocket::SocketError error);
+    // Answer to ping, elapsedTime in milliseconds
+    void pong(quint64 elapsedTime);
+
+    void busMessageReceived(const QString &type, const QJsonDocument &doc);
+    void guiMessageReceived(const GuiMessage &message);
+
+private:
+    void onTextMessageReceived(const QString &message);
+    void onBinaryMessageReceived(const QByteArray &message);
+    void decodeBusMessage(const QString &message);
+    void decodeGuiMessage(const QString &message);
+    bool isMessageTypeFiltered(const QString &type) const;
+
+    Decoder m_decoder;
+    QWebSocket *m_socket;
+    QStringList m_filteredPrefixes;
+    QSet<QString> m_allowedTypes;
+};
+
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <vector>
+
+/**
+ * Lock free ring of samples between exactly one producer thread and one
+ * consumer thread. The producer never waits: when the consumer lags behind
+ * too much the oldest samples get overwritten, and the consumer skips them.
+ *
+ * Overwrites are detected like in a seqlock: the producer announces how far
+ * it's going to write before touching the samples, the consumer checks that
+ * after copying and throws away what may have been overwritten meanwhile.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity)
+        : m_buffer(roundedCapacity(capacity)),
+          m_mask(m_buffer.size() - 1)
+    {
+    }
+
+    size_t capacity() const
+    {
+        return m_buffer.size();
+    }
+
+    // Producer side
+    void push(const T *data, size_t count)
+    {
+        // Only the last capacity() samples can survive anyway
+        if (count > capacity()) {
+            data += count - capacity();
+            m_written.fetch_add(count - capacity(), std::memory_order_relaxed);
+            count = capacity();
+        }
+
+        const quint64 start = m_written.load(std::memory_order_relaxed);
+        m_claimed.store(start + count, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < count; ++i) {
+            m_buffer[(start + i) & m_mask].store(data[i], std::memory_order_relaxed);
+        }
+
+        m_written.store(start + count, std::memory_order_release);
+    }
+
+    // Consumer side: number of samples that can be popped
+    size_t available() const
+    {
+        const quint64 written = m_written.load(std::memory_order_acquire);
+        return size_t(qMin<quint64>(written - m_read, capacity()));
+    }
+
+    /**
+     * Consumer side: copies up to count of the oldest samples not read yet
+     * @returns the number of samples copied
+     */
+    size_t pop(T *data, size_t count)
+    {
+        const quint64 written = m_written.load(std::memory_order_acquire);
+        if (written - m_read > capacity()) {
+            m_dropped.fetch_add(written - capacity() - m_read, std::memory_order_relaxed);
+            m_read = written - capacity();
+        }
+
+        count = size_t(qMin<quint64>(count, written - m_read));
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = m_buffer[(m_read + i) & m_mask].load(std::memory_order_relaxed);
+        }
+
+        // Did the producer start writing over what we just copied?
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const quint64 claimed = m_claimed.load(std::memory_order_relaxed);
+        if (claimed - m_read > capacity()) {
+            // Not worth moving the good part: the caller gets it again on the next pop
+            const quint64 oldest = claimed - capacity();
+            m_dropped.fetch_add(oldest - m_read, std::memory_order_relaxed);
+            m_read = oldest;
+            return 0;
+        }
+
+        m_read += count;
+        return count;
+    }
+
+    // Consumer side: drops up to count of the oldest samples
+    void skip(size_t count)
+    {
+        m_read += qMin<quint64>(count, available());
+    }
+
+    // Samples overwritten before the consumer could read them
+    quint64 dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static size_t roundedCapacity(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<std::atomic<T>> m_buffer;
+    size_t m_mask;
+    // Total samples written, and the end of the ones being written
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_claimed{0};
+    std::atomic<quint64> m_dropped{0};
+    // Only touched by the consumer
+    quint64 m_read = 0;
+};
+
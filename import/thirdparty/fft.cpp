@@ -8,6 +8,14 @@
 
 #include "fft.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FFT_USE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FFT_USE_NEON
+#endif
+
 void fft(CArray& x){
     const size_t N = x.size();
     if (N <= 1) return;
@@ -32,3 +40,142 @@ void ifft(CArray& x){
     x = x.apply(std::conj);
     x /= x.size();
 }
+
+// count butterflies between a[j] and b[j] with twiddle w[j]:
+// a[j] = a[j] + w[j]*b[j], b[j] = a[j] - w[j]*b[j]
+// std::complex<double> is laid out as two doubles, real part first
+static void butterflies(Complex *a, Complex *b, const Complex *w, size_t count){
+#if defined(FFT_USE_SSE2)
+    const __m128d negateReal = _mm_set_pd(0.0, -0.0);
+    for (size_t j = 0; j < count; ++j){
+        double *pa = reinterpret_cast<double *>(a + j);
+        double *pb = reinterpret_cast<double *>(b + j);
+        const __m128d u = _mm_loadu_pd(pa);
+        const __m128d v = _mm_loadu_pd(pb);
+        const __m128d tw = _mm_loadu_pd(reinterpret_cast<const double *>(w + j));
+        // (vr*wr - vi*wi, vi*wr + vr*wi)
+        const __m128d re = _mm_mul_pd(v, _mm_unpacklo_pd(tw, tw));
+        const __m128d im = _mm_mul_pd(_mm_shuffle_pd(v, v, 1), _mm_unpackhi_pd(tw, tw));
+        const __m128d t = _mm_add_pd(re, _mm_xor_pd(im, negateReal));
+        _mm_storeu_pd(pa, _mm_add_pd(u, t));
+        _mm_storeu_pd(pb, _mm_sub_pd(u, t));
+    }
+#elif defined(FFT_USE_NEON)
+    const float64x2_t negateReal = {-1.0, 1.0};
+    for (size_t j = 0; j < count; ++j){
+        double *pa = reinterpret_cast<double *>(a + j);
+        double *pb = reinterpret_cast<double *>(b + j);
+        const float64x2_t u = vld1q_f64(pa);
+        const float64x2_t v = vld1q_f64(pb);
+        const float64x2_t tw = vld1q_f64(reinterpret_cast<const double *>(w + j));
+        const float64x2_t re = vmulq_laneq_f64(v, tw, 0);
+        const float64x2_t im = vmulq_laneq_f64(vextq_f64(v, v, 1), tw, 1);
+        const float64x2_t t = vfmaq_f64(re, im, negateReal);
+        vst1q_f64(pa, vaddq_f64(u, t));
+        vst1q_f64(pb, vsubq_f64(u, t));
+    }
+#else
+    for (size_t j = 0; j < count; ++j){
+        const Complex t = w[j] * b[j];
+        b[j] = a[j] - t;
+        a[j] += t;
+    }
+#endif
+}
+
+static unsigned int log2Size(size_t size){
+    unsigned int bits = 0;
+    while ((size_t(1) << bits) < size)
+        ++bits;
+    return bits;
+}
+
+static void buildTables(size_t n, std::vector<Complex> &twiddles, std::vector<unsigned int> &bitReverse){
+    const unsigned int bits = log2Size(n);
+
+    bitReverse.resize(n);
+    for (size_t i = 0; i < n; ++i){
+        unsigned int reversed = 0;
+        for (unsigned int b = 0; b < bits; ++b){
+            if (i & (size_t(1) << b))
+                reversed |= 1u << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+
+    // Every stage gets its own contiguous twiddles, so the kernels read them in order
+    twiddles.resize(n > 1 ? n - 1 : 0);
+    for (size_t half = 1; half < n; half <<= 1){
+        for (size_t j = 0; j < half; ++j)
+            twiddles[half - 1 + j] = std::polar(1.0, -PI * j / half);
+    }
+}
+
+static void runTransform(Complex *x, size_t n, const std::vector<Complex> &twiddles, const std::vector<unsigned int> &bitReverse){
+    for (size_t i = 0; i < n; ++i){
+        const size_t j = bitReverse[i];
+        if (i < j)
+            std::swap(x[i], x[j]);
+    }
+
+    for (size_t half = 1; half < n; half <<= 1){
+        const Complex *w = twiddles.data() + half - 1;
+        for (size_t i = 0; i < n; i += 2 * half)
+            butterflies(x + i, x + i + half, w, half);
+    }
+}
+
+FFTEngine::FFTEngine(size_t size)
+    : m_size(size){
+    // Only powers of two, at least 2
+    if (m_size < 2 || (m_size & (m_size - 1)) != 0){
+        std::cerr << "FFTEngine: size " << size << " is not a power of two, using "
+                  << (size_t(1) << log2Size(m_size < 2 ? 2 : m_size)) << std::endl;
+        m_size = size_t(1) << log2Size(m_size < 2 ? 2 : m_size);
+    }
+
+    const size_t half = m_size / 2;
+    buildTables(half, m_twiddles, m_bitReverse);
+    buildTables(m_size, m_fullTwiddles, m_fullBitReverse);
+
+    m_splitTwiddles.resize(half);
+    for (size_t k = 0; k < half; ++k)
+        m_splitTwiddles[k] = std::polar(1.0, -2 * PI * k / m_size);
+
+    m_scratch.resize(half);
+}
+
+size_t FFTEngine::size() const{
+    return m_size;
+}
+
+void FFTEngine::transform(Complex *x) const{
+    runTransform(x, m_size, m_fullTwiddles, m_fullBitReverse);
+}
+
+void FFTEngine::transformHalf(Complex *x) const{
+    runTransform(x, m_size / 2, m_twiddles, m_bitReverse);
+}
+
+void FFTEngine::transformReal(const double *input, Complex *output){
+    const size_t half = m_size / 2;
+
+    // Even samples as real parts, odd ones as imaginary parts
+    for (size_t n = 0; n < half; ++n)
+        m_scratch[n] = Complex(input[2 * n], input[2 * n + 1]);
+
+    transformHalf(m_scratch.data());
+
+    // X[k] = E[k] + W^k O[k], with E and O recovered from the symmetries of Z
+    const Complex z0 = m_scratch[0];
+    output[0] = Complex(z0.real() + z0.imag(), 0);
+    output[half] = Complex(z0.real() - z0.imag(), 0);
+
+    for (size_t k = 1; k < half; ++k){
+        const Complex zk = m_scratch[k];
+        const Complex zc = std::conj(m_scratch[half - k]);
+        const Complex even = 0.5 * (zk + zc);
+        const Complex odd = Complex(0, -0.5) * (zk - zc);
+        output[k] = even + m_splitTwiddles[k] * odd;
+    }
+}
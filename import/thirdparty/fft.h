@@ -12,12 +12,48 @@
 #include <complex>
 #include <iostream>
 #include <valarray>
+#include <vector>
 
 const double PI = 3.141592653589793238460;
 
 typedef std::complex<double> Complex;
 typedef std::valarray<Complex> CArray;
 
+// Recursive reference implementation, allocates at every level
 void fft(CArray& x);
 
+/*
+ * Iterative radix-2 FFT of a fixed power of two size, with the twiddles
+ * and the bit reversal permutation computed once. Transforms are done in
+ * place and never allocate, butterflies use SSE2 or NEON when available.
+ */
+class FFTEngine{
+public:
+    explicit FFTEngine(size_t size);
+
+    size_t size() const;
+
+    // Complex transform of size() values, in place
+    void transform(Complex *x) const;
+
+    // Transform of size() real samples, through a complex one of half the size.
+    // Writes the size()/2 + 1 non redundant bins, the others are their conjugates.
+    void transformReal(const double *input, Complex *output);
+
+private:
+    void transformHalf(Complex *x) const;
+
+    size_t m_size;
+    // Twiddles of all the stages of the size()/2 transform, stage with h butterflies at h - 1
+    std::vector<Complex> m_twiddles;
+    std::vector<unsigned int> m_bitReverse;
+    // exp(-2 pi i k / size()) to split the half size transform in the real one
+    std::vector<Complex> m_splitTwiddles;
+    std::vector<Complex> m_scratch;
+
+    // Same tables for transform(), of the full size
+    std::vector<Complex> m_fullTwiddles;
+    std::vector<unsigned int> m_fullBitReverse;
+};
+
 #endif
@@ -11,16 +11,18 @@
 #undef CLAMP
 #define CLAMP(a,min,max) ((a) < (min) ? (min) : (a) > (max) ? (max) : (a))
 
+// Samples kept waiting for the processing, about 0.4s at 44.1KHz
+static const int RINGSIZE = 32*SPECSIZE;
+// How often to look for samples while nothing is playing
+static const int IDLEINTERVAL = 100;
+
 FFTCalc::FFTCalc(QObject *parent)
     :QObject(parent){
 
     processor.moveToThread(&processorThread);
 
-    qRegisterMetaType< QVector<double> >("QVector<double>");
-    connect(&processor, SIGNAL(calculatedSpectrum(QVector<double>)), SLOT(setSpectrum(QVector<double>)));
-    connect(&processor, SIGNAL(allDone()),SLOT(freeCalc()));
+    connect(&processor, &BufferProcessor::spectrumReady, this, &FFTCalc::calculatedSpectrum);
     processorThread.start(QThread::LowestPriority);
-    isBusy = false;
 }
 
 FFTCalc::~FFTCalc(){
@@ -28,37 +30,63 @@ FFTCalc::~FFTCalc(){
     processorThread.wait(10000);
 }
 
-void FFTCalc::calc(QVector<double> &_array, int duration){
-    QMetaObject::invokeMethod(&processor, "processBuffer",
-                              Qt::QueuedConnection, Q_ARG(QVector<double>, _array), Q_ARG(int, duration));
+void FFTCalc::push(const float *samples, int count, int sampleRate){
+    if(count <= 0)
+        return;
+    processor.ringSampleRate.store(sampleRate, std::memory_order_relaxed);
+    processor.ring.push(samples, count);
+}
+
+void FFTCalc::configure(int bands, BufferProcessor::BandScale scale, double decay){
+    QMetaObject::invokeMethod(&processor, "configure", Qt::QueuedConnection,
+                              Q_ARG(int, bands), Q_ARG(int, scale), Q_ARG(double, decay));
+}
+
+bool FFTCalc::updateSpectrum(){
+    processor.spectrumPending.store(false, std::memory_order_relaxed);
+    return processor.spectra.update();
+}
+
+const SpectrumFrame &FFTCalc::spectrum() const{
+    return processor.spectra.readBuffer();
+}
+
+quint64 FFTCalc::droppedSamples() const{
+    return processor.ring.dropped();
 }
 
-void FFTCalc::setSpectrum(QVector<double> spectrum){
-    emit calculatedSpectrum(spectrum);
+// How long a peak stays on top of its bar
+static const double PEAKHOLD = 0.5;
+
+static double melFromHz(double hz){
+    return 2595*log10(1 + hz/700);
 }
 
-void FFTCalc::freeCalc()
-{
-    isBusy = false;
+static double hzFromMel(double mel){
+    return 700*(pow(10, mel/2595) - 1);
 }
 
-BufferProcessor::BufferProcessor(QObject *parent){
+BufferProcessor::BufferProcessor(QObject *parent)
+    : sampleRate(0),
+      bandCount(20),
+      bandScale(LogBands),
+      decay(1.5),
+      engine(SPECSIZE),
+      ring(RINGSIZE),
+      ringSampleRate(0),
+      spectrumPending(false){
     Q_UNUSED(parent);
     timer = new QTimer(this);
     connect(timer,SIGNAL(timeout()),this,SLOT(run()));
     window.resize(SPECSIZE);
-    complexFrame.resize(SPECSIZE);
-    spectrum.resize(SPECSIZE/2);
-    logscale.resize(SPECSIZE/2+1);
-    compressed = true;
+    samples.resize(SPECSIZE);
+    frame.resize(SPECSIZE);
+    complexFrame.resize(SPECSIZE/2+1);
     for(int i=0; i<SPECSIZE;i++){
         window[i] = 0.5 * (1 - cos((2*PI*i)/(SPECSIZE)));
     }
-    for(int i=0; i<=SPECSIZE/2; i++){
-        logscale[i] = powf (SPECSIZE/2, (float) 2*i / SPECSIZE) - 0.5f;
-    }
-    running = false;
-    timer->start(100);
+    updateScale();
+    timer->start(IDLEINTERVAL);
 }
 
 BufferProcessor::~BufferProcessor(){
@@ -66,34 +94,75 @@ BufferProcessor::~BufferProcessor(){
 
 }
 
-void BufferProcessor::processBuffer(QVector<double> _array, int duration){
-    if(array.size() != _array.size()){
-        numberOfChunks = _array.size()/SPECSIZE;
-        array.resize(_array.size());
+void BufferProcessor::configure(int bands, int scale, double _decay){
+    bandCount = CLAMP(bands, 1, SPECSIZE/2);
+    bandScale = BandScale(CLAMP(scale, int(LogBands), int(LinearBands)));
+    decay = qMax(0.0, _decay);
+    updateScale();
+}
+
+void BufferProcessor::updateScale(){
+    // The bins past the DC one and before the Nyquist one, as the original log scale
+    const double first = 0.5;
+    const double last = SPECSIZE/2 - 0.5;
+
+    logscale.resize(bandCount+1);
+    if(bandScale == LogBands){
+        for(int i=0; i<=bandCount; i++){
+            logscale[i] = pow(SPECSIZE/2, double(i)/bandCount) - 0.5;
+        }
+    }
+    else if(bandScale == MelBands){
+        // Unknown until something plays, any common rate gives about the same bands
+        const double rate = sampleRate > 0 ? sampleRate : 44100;
+        const double melFirst = melFromHz(first*rate/SPECSIZE);
+        const double melLast = melFromHz(last*rate/SPECSIZE);
+        for(int i=0; i<=bandCount; i++){
+            logscale[i] = hzFromMel(melFirst + (melLast - melFirst)*i/bandCount)*SPECSIZE/rate;
+        }
     }
-    interval = duration/numberOfChunks;
-    if(interval < 1)
-        interval = 1;
-    array = _array;
-    pass = 0;
-    timer->start(interval);
+    else{
+        for(int i=0; i<=bandCount; i++){
+            logscale[i] = first + (last - first)*i/bandCount;
+        }
+    }
+
+    // Configuration changes are rare: allocating here is fine
+    bandLevels.fill(0, bandCount);
+    bandPeaks.fill(0, bandCount);
+    bandHold.fill(0, bandCount);
 }
 
 void BufferProcessor::run(){
-    unsigned long bufferSize;
     qreal amplitude;
-    if(pass == numberOfChunks){
-        emit allDone();
+
+    if(ring.available() < SPECSIZE){
+        if(timer->interval() != IDLEINTERVAL)
+            timer->start(IDLEINTERVAL);
         return;
     }
-    bufferSize = array.size();
-    if(bufferSize < SPECSIZE){
-        return;
+
+    // One chunk per tick, at the pace it's played
+    int rate = ringSampleRate.load(std::memory_order_relaxed);
+    if(rate != sampleRate || timer->interval() == IDLEINTERVAL){
+        const bool rateChanged = rate != sampleRate;
+        sampleRate = rate;
+        timer->start(qMax(1, sampleRate > 0 ? 1000*SPECSIZE/sampleRate : IDLEINTERVAL));
+        if(rateChanged && bandScale == MelBands)
+            updateScale();
     }
+    // Fallen behind: what's that old is not shown anymore
+    if(ring.available() > 4*SPECSIZE)
+        ring.skip(ring.available() - 2*SPECSIZE);
+
+    size_t got = ring.pop(samples.data(), SPECSIZE);
+    if(got < SPECSIZE)
+        return;
+
     for(uint i=0; i<SPECSIZE; i++){
-        complexFrame[i] = Complex(window[i]*array[i+pass*SPECSIZE],0);
+        frame[i] = window[i]*samples[i];
     }
-    fft(complexFrame);
+    engine.transformReal(frame.constData(), complexFrame.data());
     for(uint i=0; i<SPECSIZE/2;i++){
         qreal SpectrumAnalyserMultiplier = 1e-2;
         amplitude = SpectrumAnalyserMultiplier*std::abs(complexFrame[i]);
@@ -102,34 +171,59 @@ void BufferProcessor::run(){
         complexFrame[i] = amplitude;
     }
 
-    if(compressed){
-        for (int i = 0; i <SPECSIZE/2; i ++){
-            int a = ceilf (logscale[i]);
-            int b = floorf (logscale[i+1]);
-            float sum = 0;
-
-            if (b < a)
-                sum += complexFrame[b].real()*(logscale[i+1]-logscale[i]);
-            else{
-                if (a > 0)
-                    sum += complexFrame[a-1].real()*(a-logscale[i]);
-                for (; a < b; a++)
-                    sum += complexFrame[a].real();
-                if (b < SPECSIZE/2)
-                    sum += complexFrame[b].real()*(logscale[i+1] - b);
-            }
-
-            sum *= (float) SPECSIZE/24;
-            float val = 20*log10f (sum);
-            val = 1 + val / 40;
-            spectrum[i] = CLAMP (val, 0, 1);
+    // Wider bands sum more bins: scaled so the levels look the same at any band count,
+    // the original one being a band per bin
+    const double bandWidth = (logscale[bandCount] - logscale[0])/bandCount;
+    const double elapsed = double(SPECSIZE)/(sampleRate > 0 ? sampleRate : 44100);
+
+    for (int i = 0; i < bandCount; i ++){
+        int a = ceil (logscale[i]);
+        int b = floor (logscale[i+1]);
+        float sum = 0;
+
+        if (b < a)
+            sum += complexFrame[b].real()*(logscale[i+1]-logscale[i]);
+        else{
+            if (a > 0)
+                sum += complexFrame[a-1].real()*(a-logscale[i]);
+            for (; a < b; a++)
+                sum += complexFrame[a].real();
+            if (b < SPECSIZE/2)
+                sum += complexFrame[b].real()*(logscale[i+1] - b);
         }
-    }
-    else{
-        for(int i=0; i<SPECSIZE/2; i++){
-            spectrum[i] = CLAMP(complexFrame[i].real()*100,0,1);
+
+        sum *= (float) SPECSIZE/24/bandWidth;
+        float val = 20*log10f (sum);
+        val = 1 + val / 40;
+        const double level = CLAMP (val, 0, 1);
+
+        // Bars jump up and fall back slowly, the peaks wait a bit and then fall slower
+        if(decay > 0)
+            bandLevels[i] = qMax(level, bandLevels[i] - decay*elapsed);
+        else
+            bandLevels[i] = level;
+
+        if(bandLevels[i] >= bandPeaks[i]){
+            bandPeaks[i] = bandLevels[i];
+            bandHold[i] = PEAKHOLD;
         }
+        else if(bandHold[i] > 0)
+            bandHold[i] -= elapsed;
+        else
+            bandPeaks[i] = qMax(bandLevels[i], bandPeaks[i] - decay/2*elapsed);
+    }
+
+    // Only after a configuration change the slot doesn't have the right size yet
+    SpectrumFrame &spectrum = spectra.writeBuffer();
+    spectrum.levels.resize(bandCount);
+    spectrum.peaks.resize(bandCount);
+    for(int i=0; i<bandCount; i++){
+        spectrum.levels[i] = bandLevels[i];
+        spectrum.peaks[i] = bandPeaks[i];
     }
-    emit calculatedSpectrum(spectrum);
-    pass++;
+    spectra.publish();
+
+    // A single notification until the gui thread catches up
+    if(!spectrumPending.exchange(true))
+        emit spectrumReady();
 }
@@ -10,58 +10,106 @@
 #define FFTCALC_H
 
 #include <QThread>
-#include <QWaitCondition>
-#include <QMutex>
 #include <QVector>
 #include <QDebug>
 #include <QTimer>
 #include <QObject>
+#include <atomic>
 #include "fft.h"
+#include "../spscring.h"
+#include "../triplebuffer.h"
 
 #define SPECSIZE 512
 
+// What the gui gets for every chunk: bar heights and their peaks, between 0 and 1
+struct SpectrumFrame{
+    QVector<double> levels;
+    QVector<double> peaks;
+};
+
+/*
+ * Runs in its own thread: takes SPECSIZE samples at a time from the ring,
+ * at the pace they get played, and publishes their spectrum grouped in bands.
+ */
 class BufferProcessor: public QObject{
     Q_OBJECT
-    QVector<double> array;
+public:
+    enum BandScale{
+        LogBands = 0,
+        MelBands,
+        LinearBands
+    };
+
+private:
     QVector<double> window;
-    QVector<double> spectrum;
+    // Edges of the bands in bins, fractional: band i goes from logscale[i] to logscale[i+1]
     QVector<double> logscale;
     QTimer *timer;
-    bool compressed;
-    bool running;
-    int numberOfChunks;
-    int interval;
-    int pass;
-    CArray complexFrame;
+    int sampleRate;
+    int bandCount;
+    BandScale bandScale;
+    // Fraction of the full scale the bars fall per second, 0 to follow the signal as is
+    double decay;
+    QVector<double> bandLevels;
+    QVector<double> bandPeaks;
+    // Seconds the peaks stay before falling
+    QVector<double> bandHold;
+    FFTEngine engine;
+    QVector<float> samples;
+    QVector<double> frame;
+    // Only the first SPECSIZE/2 + 1 bins, the input is real
+    QVector<Complex> complexFrame;
+
+    void updateScale();
+
+public:
+    SpscRing<float> ring;
+    TripleBuffer<SpectrumFrame> spectra;
+    // Producer side of the sample rate, read by the processing thread
+    std::atomic<int> ringSampleRate;
+    // Set when a spectrum is published, cleared when the gui thread picks it
+    std::atomic<bool> spectrumPending;
 
 public slots:
-    void processBuffer(QVector<double> _array, int duration);
+    void configure(int bands, int scale, double decay);
 signals:
-    void calculatedSpectrum(QVector<double> spectrum);
-    void allDone(void);
+    void spectrumReady();
 protected slots:
     void run();
 public:
     explicit BufferProcessor(QObject *parent=0);
     ~BufferProcessor();
-    void calc(QVector<double> &_array, int duration);
 };
 class FFTCalc : public QObject{
     Q_OBJECT
 private:
-    bool isBusy;
     BufferProcessor processor;
     QThread processorThread;
 
 public:
     explicit FFTCalc(QObject *parent = 0);
     ~FFTCalc();
-    void calc(QVector<double> &_array, int duration);
-public slots:
-    void setSpectrum(QVector<double> spectrum);
-    void freeCalc();
+    /*
+     * Feeds count mono samples, safe to call from any single thread:
+     * never blocks nor allocates, the oldest samples are dropped if the
+     * processing can't keep up.
+     */
+    void push(const float *samples, int count, int sampleRate);
+    /*
+     * Number of bands, between 1 and SPECSIZE/2, how they're spread over the
+     * frequencies, and how fast the bars fall back
+     */
+    void configure(int bands, BufferProcessor::BandScale scale, double decay);
+    /*
+     * To be called from the thread of the FFTCalc loop: takes the latest spectrum,
+     * returns false if none was computed since the last call
+     */
+    bool updateSpectrum();
+    // Valid until the next updateSpectrum
+    const SpectrumFrame &spectrum() const;
+    quint64 droppedSamples() const;
 signals:
-    void calculatedSpectrum(QVector<double> spectrum);
+    void calculatedSpectrum();
 };
 
 #endif // FFTCALC_H
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "trafficrecorder.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QTimer>
+
+#include <limits>
+
+// "MGTR", then the version of the layout below
+static const quint32 s_magic = 0x4d475452;
+static const quint32 s_format = 1;
+// Uncompressed, a few seconds of a busy skill
+static const int s_blockSize = 64 * 1024;
+// Low bits of the flags of a frame, the channel being 0 or 1
+static const quint8 s_binaryFlag = 0x2;
+// A crash or a kill loses at most this much of the recording
+static const int s_flushInterval = 1000;
+
+TrafficRecorder *TrafficRecorder::instance()
+{
+    // Stops when the application quits, or at exit without one
+    static TrafficRecorder s_self;
+    return &s_self;
+}
+
+TrafficRecorder::TrafficRecorder()
+{
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        QTimer *timer = new QTimer;
+        timer->setInterval(s_flushInterval);
+        timer->moveToThread(app->thread());
+        // Deleted with the application, before the recorder
+        timer->setParent(app);
+        QObject::connect(timer, &QTimer::timeout, timer, [this]() {
+            flush();
+        });
+        QObject::connect(app, &QCoreApplication::aboutToQuit, timer, [this]() {
+            stop();
+        });
+        m_flushTimer = timer;
+    }
+
+    // Lets recording traffic on a device without touching anything else
+    if (qEnvironmentVariableIsSet("MYCROFT_GUI_RECORD")) {
+        start(QString::fromLocal8Bit(qgetenv("MYCROFT_GUI_RECORD")));
+    }
+}
+
+TrafficRecorder::~TrafficRecorder()
+{
+    stop();
+}
+
+bool TrafficRecorder::start(const QString &fileName)
+{
+    stop();
+
+    QMutexLocker locker(&m_lock);
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Can't record the traffic in" << fileName << m_file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&m_file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << s_magic << s_format;
+
+    m_block.clear();
+    m_block.reserve(s_blockSize);
+    m_lastTime = 0;
+    m_frameCount = 0;
+    m_clock.start();
+    m_recording.storeRelease(1);
+
+    // start() may be called from any thread, the timer belongs to the application one
+    if (m_flushTimer) {
+        QMetaObject::invokeMethod(m_flushTimer, "start", Qt::QueuedConnection);
+    }
+
+    return true;
+}
+
+void TrafficRecorder::stop()
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_recording.loadAcquire()) {
+        return;
+    }
+
+    m_recording.storeRelease(0);
+    writeBlock();
+    m_file.close();
+
+    if (m_flushTimer) {
+        QMetaObject::invokeMethod(m_flushTimer, "stop", Qt::QueuedConnection);
+    }
+}
+
+void TrafficRecorder::flush()
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_recording.loadAcquire()) {
+        writeBlock();
+    }
+}
+
+bool TrafficRecorder::isRecording() const
+{
+    return m_recording.loadAcquire();
+}
+
+QString TrafficRecorder::fileName() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_file.fileName();
+}
+
+quint64 TrafficRecorder::frameCount() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_frameCount;
+}
+
+void TrafficRecorder::record(Metrics::Channel channel, const QByteArray &payload, bool binary)
+{
+    if (!isRecording()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    // Stopped while waiting for the lock
+    if (!m_recording.loadAcquire()) {
+        return;
+    }
+
+    // Times are stored as the distance from the previous frame, which almost always fits few bits
+    const qint64 time = m_clock.nsecsElapsed() / 1000;
+    const quint32 delta = quint32(qMin<qint64>(time - m_lastTime, std::numeric_limits<quint32>::max()));
+    m_lastTime = time;
+
+    QDataStream stream(&m_block, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << quint8(channel | (binary ? s_binaryFlag : 0)) << delta << payload;
+    ++m_frameCount;
+
+    if (m_block.size() >= s_blockSize) {
+        writeBlock();
+    }
+}
+
+void TrafficRecorder::writeBlock()
+{
+    if (m_block.isEmpty()) {
+        return;
+    }
+
+    QDataStream stream(&m_file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << qCompress(m_block);
+    m_file.flush();
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Error writing the traffic recording" << m_file.fileName() << m_file.errorString();
+    }
+
+    m_block.clear();
+}
+
+QVector<TrafficRecorder::Frame> TrafficRecorder::load(const QString &fileName)
+{
+    QVector<Frame> frames;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't open the traffic recording" << fileName << file.errorString();
+        return frames;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 magic = 0;
+    quint32 format = 0;
+    stream >> magic >> format;
+    if (stream.status() != QDataStream::Ok || magic != s_magic || format != s_format) {
+        qWarning() << fileName << "is not a traffic recording";
+        return frames;
+    }
+
+    qint64 time = 0;
+
+    while (!stream.atEnd()) {
+        QByteArray compressed;
+        stream >> compressed;
+        const QByteArray block = qUncompress(compressed);
+
+        if (stream.status() != QDataStream::Ok || block.isEmpty()) {
+            qWarning() << "The traffic recording" << fileName << "is truncated after" << frames.count() << "frames";
+            break;
+        }
+
+        QDataStream blockStream(block);
+        blockStream.setVersion(QDataStream::Qt_5_9);
+
+        while (!blockStream.atEnd()) {
+            quint8 flags = 0;
+            quint32 delta = 0;
+            Frame frame;
+            blockStream >> flags >> delta >> frame.payload;
+
+            if (blockStream.status() != QDataStream::Ok) {
+                qWarning() << "Corrupted block in the traffic recording" << fileName;
+                return frames;
+            }
+
+            time += delta;
+            frame.time = time;
+            frame.channel = (flags & 0x1) ? Metrics::GuiChannel : Metrics::BusChannel;
+            frame.binary = flags & s_binaryFlag;
+            frames << frame;
+        }
+    }
+
+    return frames;
+}
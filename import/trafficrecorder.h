@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include "metrics.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QPointer>
+#include <QVector>
+
+class QTimer;
+
+/**
+ * Writes what arrives on the bus and gui sockets to a file, with the time
+ * each frame arrived, so the same traffic can be played again against the
+ * gui by the trafficreplay tool of the autotests.
+ *
+ * Recording starts by itself when MYCROFT_GUI_RECORD is set to the path of
+ * the file, or with start(). Frames are compressed together in blocks,
+ * written when full, every second while recording, and on stop(), which
+ * also happens when the application quits.
+ * record() can be called from any thread.
+ */
+class TrafficRecorder
+{
+public:
+    struct Frame {
+        // Microseconds since the recording started
+        qint64 time = 0;
+        Metrics::Channel channel = Metrics::BusChannel;
+        // It came in a binary frame, as text otherwise
+        bool binary = false;
+        QByteArray payload;
+    };
+
+    static TrafficRecorder *instance();
+    ~TrafficRecorder();
+
+    /**
+     * Starts recording in fileName, replacing it, after stopping any recording going on
+     * @returns false if the file can't be written
+     */
+    bool start(const QString &fileName);
+    void stop();
+
+    bool isRecording() const;
+    QString fileName() const;
+
+    // Frames recorded since start()
+    quint64 frameCount() const;
+
+    /**
+     * Adds a frame arrived now, does nothing when not recording
+     */
+    void record(Metrics::Channel channel, const QByteArray &payload, bool binary);
+
+    /**
+     * @returns the frames of a recording in order, empty if fileName is not one.
+     * A recording cut short is read up to its last complete block.
+     */
+    static QVector<Frame> load(const QString &fileName);
+
+private:
+    TrafficRecorder();
+    // Compresses and writes the frames collected so far
+    void writeBlock();
+    // Writes the block if still recording, called by the timer
+    void flush();
+
+    // Lives in the application thread, whichever thread created the recorder
+    QPointer<QTimer> m_flushTimer;
+    QAtomicInt m_recording;
+    mutable QMutex m_lock;
+    QFile m_file;
+    QByteArray m_block;
+    QElapsedTimer m_clock;
+    qint64 m_lastTime = 0;
+    quint64 m_frameCount = 0;
+};
+
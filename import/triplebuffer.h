@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+
+/**
+ * Hands the latest value from a producer thread to a consumer thread
+ * without locks or copies: each side has its own slot, and a third one is
+ * swapped with them when a value gets published or picked up. Values are
+ * dropped if the producer is faster, the consumer always gets the latest.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    // Producer side: the slot to fill before publish()
+    T &writeBuffer()
+    {
+        return m_slots[m_back];
+    }
+
+    void publish()
+    {
+        const int previous = m_middle.exchange(m_back | Fresh, std::memory_order_acq_rel);
+        m_back = previous & SlotMask;
+    }
+
+    // Consumer side: takes the value published last, if any
+    // @returns false if nothing new was published since the last call
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & Fresh)) {
+            return false;
+        }
+        const int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & SlotMask;
+        return true;
+    }
+
+    const T &readBuffer() const
+    {
+        return m_slots[m_front];
+    }
+
+    // Not thread safe: to set up every slot before the two sides start
+    T *buffers()
+    {
+        return m_slots;
+    }
+
+private:
+    enum {
+        SlotMask = 3,
+        Fresh = 4
+    };
+
+    T m_slots[3];
+    std::atomic<int> m_middle{1};
+    int m_back = 0;
+    int m_front = 2;
+};
+
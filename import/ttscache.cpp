@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ttscache.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+TtsCache::TtsCache(QObject *parent)
+    : QObject(parent),
+      m_diskDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/tts"))
+{
+    // A couple of minutes of 16KHz speech
+    m_entries.setMaxCost(8 * 1024 * 1024);
+}
+
+TtsCache::~TtsCache()
+{
+}
+
+QString TtsCache::key(const QString &utterance, const QString &voice, const QString &lang)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    // Separated by a character none of them can contain
+    hash.addData(utterance.toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(voice.toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(lang.toLower().toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool TtsCache::contains(const QString &key) const
+{
+    return m_entries.contains(key) || (m_diskSpill && QFile::exists(diskPath(key)));
+}
+
+QByteArray TtsCache::lookup(const QString &key)
+{
+    if (const QByteArray *audio = m_entries.object(key)) {
+        ++m_hits;
+        emit statisticsChanged();
+        return *audio;
+    }
+
+    QByteArray audio;
+    if (m_diskSpill) {
+        QFile file(diskPath(key));
+        if (file.open(QIODevice::ReadOnly)) {
+            audio = file.readAll();
+        }
+    }
+
+    if (audio.isEmpty()) {
+        ++m_misses;
+    } else {
+        ++m_hits;
+        // Back in memory, it's likely to be said again soon
+        m_entries.insert(key, new QByteArray(audio), audio.size());
+    }
+    emit statisticsChanged();
+    return audio;
+}
+
+void TtsCache::insert(const QString &key, const QByteArray &audio)
+{
+    if (key.isEmpty() || audio.isEmpty()) {
+        return;
+    }
+
+    // QCache refuses what's bigger than the whole capacity
+    m_entries.insert(key, new QByteArray(audio), audio.size());
+
+    if (m_diskSpill) {
+        QDir().mkpath(m_diskDirectory);
+        QFile file(diskPath(key));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "Unable to write the text to speech cache" << file.fileName() << file.errorString();
+        } else {
+            file.write(audio);
+            file.close();
+            pruneDisk();
+        }
+    }
+
+    emit statisticsChanged();
+}
+
+int TtsCache::count() const
+{
+    return m_entries.count();
+}
+
+qint64 TtsCache::size() const
+{
+    return m_entries.totalCost();
+}
+
+int TtsCache::hits() const
+{
+    return m_hits;
+}
+
+int TtsCache::misses() const
+{
+    return m_misses;
+}
+
+int TtsCache::capacity() const
+{
+    return m_entries.maxCost();
+}
+
+void TtsCache::setCapacity(int capacity)
+{
+    capacity = qMax(0, capacity);
+    if (m_entries.maxCost() == capacity) {
+        return;
+    }
+
+    m_entries.setMaxCost(capacity);
+    if (m_diskSpill) {
+        pruneDisk();
+    }
+    emit capacityChanged();
+    emit statisticsChanged();
+}
+
+bool TtsCache::diskSpill() const
+{
+    return m_diskSpill;
+}
+
+void TtsCache::setDiskSpill(bool spill)
+{
+    if (m_diskSpill == spill) {
+        return;
+    }
+
+    m_diskSpill = spill;
+    emit diskSpillChanged();
+}
+
+void TtsCache::clear()
+{
+    m_entries.clear();
+    QDir(m_diskDirectory).removeRecursively();
+    m_hits = 0;
+    m_misses = 0;
+    emit statisticsChanged();
+}
+
+QString TtsCache::diskPath(const QString &key) const
+{
+    return m_diskDirectory + QLatin1Char('/') + key;
+}
+
+void TtsCache::pruneDisk()
+{
+    const qint64 limit = qint64(m_entries.maxCost()) * 4;
+
+    // Newest first: what's past the limit is what hasn't been written for a while
+    const QFileInfoList files = QDir(m_diskDirectory).entryInfoList(QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &info : files) {
+        total += info.size();
+        if (total > limit) {
+            QFile::remove(info.absoluteFilePath());
+        }
+    }
+}
+
+#include "moc_ttscache.cpp"
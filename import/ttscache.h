@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QObject>
+
+/**
+ * Audio of remote text to speech, kept to play the same sentences again
+ * without downloading them: in memory up to capacity bytes, least recently
+ * used first out, and optionally also on disk, up to 4 times as much.
+ * Audio is addressed by a hash of what it says and how, see key().
+ */
+class TtsCache : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 size READ size NOTIFY statisticsChanged)
+    Q_PROPERTY(int hits READ hits NOTIFY statisticsChanged)
+    Q_PROPERTY(int misses READ misses NOTIFY statisticsChanged)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(bool diskSpill READ diskSpill WRITE setDiskSpill NOTIFY diskSpillChanged)
+
+public:
+    explicit TtsCache(QObject *parent = nullptr);
+    ~TtsCache() override;
+
+    /**
+     * @returns the hash the audio of utterance, spoken by voice in lang, is cached with
+     */
+    static QString key(const QString &utterance, const QString &voice, const QString &lang);
+
+    /**
+     * @returns true if the audio for key is in memory or on disk, without counting a hit
+     */
+    bool contains(const QString &key) const;
+
+    /**
+     * @returns the audio cached for key, empty if there is none
+     */
+    QByteArray lookup(const QString &key);
+
+    void insert(const QString &key, const QByteArray &audio);
+
+    // Entries and bytes in memory
+    int count() const;
+    qint64 size() const;
+
+    int hits() const;
+    int misses() const;
+
+    /**
+     * Bytes of audio kept in memory
+     */
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    bool diskSpill() const;
+    void setDiskSpill(bool spill);
+
+    /**
+     * Drops everything, on disk as well
+     */
+    Q_INVOKABLE void clear();
+
+Q_SIGNALS:
+    void statisticsChanged();
+    void capacityChanged();
+    void diskSpillChanged();
+
+private:
+    QString diskPath(const QString &key) const;
+    void pruneDisk();
+
+    QCache<QString, QByteArray> m_entries;
+    QString m_diskDirectory;
+    bool m_diskSpill = false;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
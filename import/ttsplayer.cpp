@@ -0,0 +1,382 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ttsplayer.h"
+
+#include <QAudioOutput>
+#include <QDebug>
+#include <QMediaPlayer>
+#include <QUrl>
+#include <QtEndian>
+
+#include <limits>
+
+static quint32 readUInt32(const char *data)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+static quint16 readUInt16(const char *data)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+
+// A name with the extension of what the audio looks like
+static QString mediaFileName(const QByteArray &data)
+{
+    if (data.startsWith("OggS")) {
+        return QStringLiteral("tts.ogg");
+    } else if (data.startsWith("fLaC")) {
+        return QStringLiteral("tts.flac");
+    } else if (data.startsWith("ID3") || (data.size() >= 2 && uchar(data[0]) == 0xff && (uchar(data[1]) & 0xe0) == 0xe0)) {
+        return QStringLiteral("tts.mp3");
+    }
+    // RIFF WAVE the audio output can't play, as compressed or extensible ones
+    return QStringLiteral("tts.wav");
+}
+
+TtsPlayer::TtsPlayer(QObject *parent)
+    : QObject(parent)
+{
+    // Way shorter than what the output buffers: it never runs dry while there is data
+    m_feedTimer.setInterval(20);
+    connect(&m_feedTimer, &QTimer::timeout, this, &TtsPlayer::feed);
+}
+
+TtsPlayer::~TtsPlayer()
+{
+    stop();
+}
+
+void TtsPlayer::enqueue(const QByteArray &audio)
+{
+    appendChunk(QString(), audio, true);
+}
+
+void TtsPlayer::appendChunk(const QString &stream, const QByteArray &data, bool last)
+{
+    int index = -1;
+    if (!stream.isEmpty()) {
+        for (int i = 0; i < m_queue.count(); ++i) {
+            if (m_queue[i].stream == stream && !m_queue[i].complete) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    if (index < 0) {
+        Utterance utterance;
+        utterance.stream = stream;
+        m_queue << utterance;
+        index = m_queue.count() - 1;
+    }
+
+    Utterance &utterance = m_queue[index];
+    utterance.data.append(data);
+    utterance.complete = last;
+
+    if (index == 1 && m_draining && m_outputDevice) {
+        // Arrived before the output ran dry: it may still follow without a gap
+        m_draining = false;
+        m_feedTimer.start();
+        feed();
+    } else if (index != 0) {
+        return;
+    } else if (m_outputDevice) {
+        feed();
+    } else if (!m_mediaPlayer || m_mediaPlayer->state() == QMediaPlayer::StoppedState) {
+        playNext();
+    }
+}
+
+void TtsPlayer::reserve(const QString &stream)
+{
+    if (stream.isEmpty()) {
+        return;
+    }
+
+    Utterance utterance;
+    utterance.stream = stream;
+    m_queue << utterance;
+}
+
+void TtsPlayer::release(const QString &stream)
+{
+    for (int i = 0; i < m_queue.count(); ++i) {
+        const Utterance &utterance = m_queue[i];
+        if (utterance.stream != stream || utterance.complete) {
+            continue;
+        }
+
+        if (!utterance.data.isEmpty()) {
+            // Part of it is there already, it plays until there
+            appendChunk(stream, QByteArray(), true);
+            return;
+        }
+
+        m_queue.removeAt(i);
+        // It was holding back the ones after it
+        if (i == 0 && !m_outputDevice && (!m_mediaPlayer || m_mediaPlayer->state() == QMediaPlayer::StoppedState)) {
+            playNext();
+        }
+        return;
+    }
+}
+
+void TtsPlayer::stop()
+{
+    m_queue.clear();
+    m_feedTimer.stop();
+    m_draining = false;
+
+    if (m_output) {
+        m_output->stop();
+        m_outputDevice = nullptr;
+    }
+    if (m_mediaPlayer) {
+        m_mediaPlayer->stop();
+    }
+
+    setPlaying(false);
+}
+
+bool TtsPlayer::isPlaying() const
+{
+    return m_playing;
+}
+
+int TtsPlayer::queued() const
+{
+    return m_queue.count();
+}
+
+bool TtsPlayer::parseHeader(Utterance &utterance)
+{
+    if (utterance.dataOffset == 0) {
+        utterance.dataOffset = parseWavHeader(utterance.data, utterance.complete, utterance.format);
+    }
+    return utterance.dataOffset != 0;
+}
+
+int TtsPlayer::parseWavHeader(const QByteArray &data, bool complete, QAudioFormat &format)
+{
+    // Anything cut short stays unknown while more can come
+    const int needMore = complete ? -1 : 0;
+
+    if (data.size() < 12) {
+        return needMore;
+    }
+
+    if (!data.startsWith("RIFF") || data.mid(8, 4) != "WAVE") {
+        return -1;
+    }
+
+    // Chunks until the samples, the format must come before them.
+    // The sizes of RIFF and data are not looked at: streamed files have 0xffffffff there
+    qint64 offset = 12;
+    bool haveFormat = false;
+    while (offset + 8 <= data.size()) {
+        const QByteArray id = data.mid(int(offset), 4);
+        const quint32 size = readUInt32(data.constData() + offset + 4);
+
+        if (id == "data") {
+            return haveFormat ? int(offset) + 8 : -1;
+        }
+
+        if (id == "fmt ") {
+            if (offset + 8 + 16 > data.size()) {
+                return needMore;
+            }
+            const char *fmt = data.constData() + offset + 8;
+            const quint16 tag = readUInt16(fmt);
+            const int bits = readUInt16(fmt + 14);
+            // 1 is integer PCM, 3 float, 0xfffe would need the extension to tell
+            if (tag != 1 && tag != 3) {
+                return -1;
+            }
+
+            format.setCodec(QStringLiteral("audio/pcm"));
+            format.setByteOrder(QAudioFormat::LittleEndian);
+            format.setChannelCount(readUInt16(fmt + 2));
+            format.setSampleRate(int(readUInt32(fmt + 4)));
+            format.setSampleSize(bits);
+            format.setSampleType(tag == 3 ? QAudioFormat::Float
+                                 : bits == 8 ? QAudioFormat::UnSignedInt : QAudioFormat::SignedInt);
+            haveFormat = true;
+        }
+
+        // Chunks are padded to an even size
+        offset += 8 + qint64(size) + (size & 1);
+        // A chunk before the samples can't be that big: not a header that makes sense
+        if (offset > std::numeric_limits<int>::max()) {
+            return -1;
+        }
+    }
+
+    return needMore;
+}
+
+void TtsPlayer::playNext()
+{
+    if (m_queue.isEmpty()) {
+        setPlaying(false);
+        return;
+    }
+
+    Utterance &utterance = m_queue.first();
+    if (!parseHeader(utterance)) {
+        // Waiting for the rest of the header
+        return;
+    }
+
+    if (utterance.dataOffset < 0) {
+        // Compressed or exotic: only a media player can decode it, and only once it's all there
+        if (!utterance.complete) {
+            return;
+        }
+
+        if (!m_mediaPlayer) {
+            m_mediaPlayer = new QMediaPlayer(this);
+            connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged, this,
+                    [this](QMediaPlayer::MediaStatus status) {
+                        if (status == QMediaPlayer::EndOfMedia || status == QMediaPlayer::InvalidMedia) {
+                            if (status == QMediaPlayer::InvalidMedia) {
+                                qWarning() << "Unable to play the text to speech audio:" << m_mediaPlayer->errorString();
+                            }
+                            finishCurrent();
+                        }
+                    });
+        }
+        m_mediaPlayer->setMedia(QMediaContent());
+        m_mediaBuffer.close();
+        m_mediaBuffer.setData(utterance.data);
+        m_mediaBuffer.open(QIODevice::ReadOnly);
+        // The backends pick the decoder from the name, there's no file here to tell otherwise
+        m_mediaPlayer->setMedia(QMediaContent(QUrl(mediaFileName(utterance.data))), &m_mediaBuffer);
+        m_mediaPlayer->play();
+        setPlaying(true);
+        return;
+    }
+
+    // The output is recreated only when the format changes
+    if (!m_output || m_output->format() != utterance.format) {
+        if (m_output) {
+            m_output->stop();
+            m_output->deleteLater();
+        }
+        m_output = new QAudioOutput(utterance.format, this);
+        connect(m_output, &QAudioOutput::stateChanged, this, &TtsPlayer::onOutputStateChanged);
+    }
+
+    m_written = utterance.dataOffset;
+    m_draining = false;
+    m_outputDevice = m_output->start();
+    if (!m_outputDevice) {
+        qWarning() << "Unable to open the audio output for text to speech";
+        m_queue.removeFirst();
+        playNext();
+        return;
+    }
+
+    setPlaying(true);
+    m_feedTimer.start();
+    feed();
+}
+
+void TtsPlayer::feed()
+{
+    if (!m_outputDevice || m_draining || m_queue.isEmpty()) {
+        return;
+    }
+
+    while (true) {
+        const Utterance &utterance = m_queue.first();
+        const int frameBytes = qMax(1, utterance.format.bytesPerFrame());
+
+        int size = qMin(m_output->bytesFree(), utterance.data.size() - m_written);
+        // Whole frames, unless it's the very end
+        if (!utterance.complete || m_written + size < utterance.data.size()) {
+            size -= size % frameBytes;
+        }
+        if (size > 0) {
+            const qint64 written = m_outputDevice->write(utterance.data.constData() + m_written, size);
+            if (written > 0) {
+                m_written += int(written);
+            }
+        }
+
+        if (!utterance.complete || m_written < utterance.data.size()) {
+            return;
+        }
+
+        // The next sentence in the same format follows in the same stream, without gaps
+        if (m_queue.count() > 1) {
+            Utterance &next = m_queue[1];
+            if (parseHeader(next) && next.dataOffset > 0 && next.format == utterance.format) {
+                m_queue.removeFirst();
+                m_written = next.dataOffset;
+                continue;
+            }
+        }
+
+        // Stopped when the output played it all
+        m_draining = true;
+        m_feedTimer.stop();
+        return;
+    }
+}
+
+void TtsPlayer::onOutputStateChanged()
+{
+    if (m_output->state() != QAudio::IdleState || !m_draining) {
+        if (m_output->error() != QAudio::NoError && m_output->error() != QAudio::UnderrunError) {
+            qWarning() << "Text to speech audio output error" << m_output->error();
+            m_draining = false;
+            m_output->stop();
+            m_outputDevice = nullptr;
+            m_feedTimer.stop();
+            finishCurrent();
+        }
+        return;
+    }
+
+    m_draining = false;
+    m_output->stop();
+    m_outputDevice = nullptr;
+    finishCurrent();
+}
+
+void TtsPlayer::finishCurrent()
+{
+    if (!m_queue.isEmpty()) {
+        m_queue.removeFirst();
+    }
+    playNext();
+}
+
+void TtsPlayer::setPlaying(bool playing)
+{
+    if (m_playing == playing) {
+        return;
+    }
+
+    m_playing = playing;
+    emit playingChanged();
+}
+
+#include "moc_ttsplayer.cpp"
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QAudioFormat>
+#include <QBuffer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+class QAudioOutput;
+class QMediaPlayer;
+
+/**
+ * Plays the audio of remote text to speech, one utterance after the other,
+ * straight from memory. PCM WAV goes to a single QAudioOutput that is kept
+ * open as long as the format doesn't change, so consecutive sentences play
+ * without gaps; it starts with the first chunk of audio, while the rest is
+ * still arriving. Anything else is handed to a QMediaPlayer, once complete.
+ */
+class TtsPlayer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool playing READ isPlaying NOTIFY playingChanged)
+
+public:
+    explicit TtsPlayer(QObject *parent = nullptr);
+    ~TtsPlayer() override;
+
+    /**
+     * Queues a whole utterance
+     */
+    void enqueue(const QByteArray &audio);
+
+    /**
+     * Adds a piece of the utterance identified by stream, which gets queued with
+     * its first piece. Pieces of different streams can be interleaved.
+     * @param last true if no more data will come for this stream
+     */
+    void appendChunk(const QString &stream, const QByteArray &data, bool last);
+
+    /**
+     * Queues an utterance for stream with no audio yet: what appendChunk adds
+     * to it later plays in this place, after what was queued before
+     */
+    void reserve(const QString &stream);
+
+    /**
+     * Gives up the place reserved for stream, if no audio arrived for it
+     */
+    void release(const QString &stream);
+
+    /**
+     * Stops what is playing and drops everything queued
+     */
+    void stop();
+
+    bool isPlaying() const;
+
+    // Utterances waiting, including the one playing
+    int queued() const;
+
+    /**
+     * Reads the header of a WAV file, which may have arrived only in part
+     * @param complete true if no more data will come
+     * @param format set to the format of the samples when found
+     * @returns where the samples start, 0 if more data is needed to tell,
+     * -1 if it's not PCM WAV the audio output can play
+     */
+    static int parseWavHeader(const QByteArray &data, bool complete, QAudioFormat &format);
+
+Q_SIGNALS:
+    void playingChanged();
+
+private:
+    struct Utterance {
+        QString stream;
+        QByteArray data;
+        bool complete = false;
+        // Where the samples start, 0 until the header is parsed, -1 if it's not a PCM WAV
+        int dataOffset = 0;
+        QAudioFormat format;
+    };
+
+    // Looks for the format in the header, false if more data is needed to tell
+    static bool parseHeader(Utterance &utterance);
+
+    void playNext();
+    void feed();
+    void finishCurrent();
+    void setPlaying(bool playing);
+    void onOutputStateChanged();
+
+    QList<Utterance> m_queue;
+    QAudioOutput *m_output = nullptr;
+    QIODevice *m_outputDevice = nullptr;
+    // Position in the playing utterance of the next byte to write
+    int m_written = 0;
+    // All written, waiting for the output to play it before it can be stopped
+    bool m_draining = false;
+    QTimer m_feedTimer;
+
+    QMediaPlayer *m_mediaPlayer = nullptr;
+    QBuffer m_mediaBuffer;
+    bool m_playing = false;
+};
+
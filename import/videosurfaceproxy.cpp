@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "videosurfaceproxy.h"
+
+#include <QDebug>
+#include <QDynamicPropertyChangeEvent>
+
+VideoSurfaceProxy::VideoSurfaceProxy(QObject *parent)
+    : QAbstractVideoSurface(parent)
+{
+}
+
+VideoSurfaceProxy::~VideoSurfaceProxy()
+{
+}
+
+QAbstractVideoSurface *VideoSurfaceProxy::target() const
+{
+    return m_target;
+}
+
+void VideoSurfaceProxy::setTarget(QAbstractVideoSurface *target)
+{
+    if (m_target == target) {
+        return;
+    }
+
+    // The player starts again on the new target, with what that one supports
+    if (isActive()) {
+        stop();
+    }
+
+    if (m_target) {
+        m_target->removeEventFilter(this);
+        disconnect(m_target.data(), nullptr, this, nullptr);
+    }
+
+    m_target = target;
+
+    if (m_target) {
+        m_target->installEventFilter(this);
+        connect(m_target.data(), &QAbstractVideoSurface::supportedFormatsChanged,
+                this, &QAbstractVideoSurface::supportedFormatsChanged);
+    }
+
+    syncGLContext();
+    emit supportedFormatsChanged();
+}
+
+bool VideoSurfaceProxy::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_target && event->type() == QEvent::DynamicPropertyChange
+        && static_cast<QDynamicPropertyChangeEvent *>(event)->propertyName() == "GLContext") {
+        syncGLContext();
+    }
+
+    return QAbstractVideoSurface::eventFilter(watched, event);
+}
+
+void VideoSurfaceProxy::syncGLContext()
+{
+    setProperty("GLContext", m_target ? m_target->property("GLContext") : QVariant());
+}
+
+QList<QVideoFrame::PixelFormat> VideoSurfaceProxy::supportedPixelFormats(QAbstractVideoBuffer::HandleType handleType) const
+{
+    if (!m_target) {
+        return QList<QVideoFrame::PixelFormat>();
+    }
+    return m_target->supportedPixelFormats(handleType);
+}
+
+bool VideoSurfaceProxy::isFormatSupported(const QVideoSurfaceFormat &format) const
+{
+    return m_target && m_target->isFormatSupported(format);
+}
+
+QVideoSurfaceFormat VideoSurfaceProxy::nearestFormat(const QVideoSurfaceFormat &format) const
+{
+    if (!m_target) {
+        return QVideoSurfaceFormat();
+    }
+    return m_target->nearestFormat(format);
+}
+
+bool VideoSurfaceProxy::start(const QVideoSurfaceFormat &format)
+{
+    if (!m_target || !m_target->start(format)) {
+        setError(UnsupportedFormatError);
+        return false;
+    }
+
+    if (m_handleType != format.handleType()) {
+        m_handleType = format.handleType();
+        emit handleTypeChanged();
+    }
+    return QAbstractVideoSurface::start(format);
+}
+
+void VideoSurfaceProxy::stop()
+{
+    if (m_target) {
+        m_target->stop();
+    }
+    QAbstractVideoSurface::stop();
+}
+
+bool VideoSurfaceProxy::present(const QVideoFrame &frame)
+{
+    if (!m_target) {
+        return false;
+    }
+
+    ++m_presentedFrames;
+    if (!m_target->present(frame)) {
+        ++m_droppedFrames;
+        setError(m_target->error());
+        return false;
+    }
+    return true;
+}
+
+QAbstractVideoBuffer::HandleType VideoSurfaceProxy::handleType() const
+{
+    return m_handleType;
+}
+
+quint64 VideoSurfaceProxy::presentedFrames() const
+{
+    return m_presentedFrames;
+}
+
+quint64 VideoSurfaceProxy::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+void VideoSurfaceProxy::resetStatistics()
+{
+    m_presentedFrames = 0;
+    m_droppedFrames = 0;
+}
+
+#include "moc_videosurfaceproxy.cpp"
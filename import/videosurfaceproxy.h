@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QAbstractVideoSurface>
+#include <QPointer>
+#include <QVideoSurfaceFormat>
+
+/**
+ * Stands between the media player and the surface of a QML VideoOutput:
+ * everything is forwarded as is, so the player negotiates directly what the
+ * surface supports, texture handles included, but which kind of frames
+ * end up being used gets known, and the frames are counted.
+ * The target can be changed without the player noticing.
+ * The "GLContext" dynamic property the VideoOutput sets on its surface once
+ * its scene graph is up is mirrored, as the backends look for it on the
+ * surface they got before offering texture formats.
+ */
+class VideoSurfaceProxy : public QAbstractVideoSurface
+{
+    Q_OBJECT
+
+public:
+    explicit VideoSurfaceProxy(QObject *parent = nullptr);
+    ~VideoSurfaceProxy() override;
+
+    QAbstractVideoSurface *target() const;
+    void setTarget(QAbstractVideoSurface *target);
+
+    QList<QVideoFrame::PixelFormat> supportedPixelFormats(QAbstractVideoBuffer::HandleType handleType = QAbstractVideoBuffer::NoHandle) const override;
+    bool isFormatSupported(const QVideoSurfaceFormat &format) const override;
+    QVideoSurfaceFormat nearestFormat(const QVideoSurfaceFormat &format) const override;
+
+    bool start(const QVideoSurfaceFormat &format) override;
+    void stop() override;
+    bool present(const QVideoFrame &frame) override;
+
+    /**
+     * How the frames of the current format are passed: NoHandle means
+     * mapped in memory and uploaded by the surface at each frame
+     */
+    QAbstractVideoBuffer::HandleType handleType() const;
+
+    // Frames the player produced, and those the surface refused
+    quint64 presentedFrames() const;
+    quint64 droppedFrames() const;
+    void resetStatistics();
+
+Q_SIGNALS:
+    void handleTypeChanged();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void syncGLContext();
+
+
+    QPointer<QAbstractVideoSurface> m_target;
+    QAbstractVideoBuffer::HandleType m_handleType = QAbstractVideoBuffer::NoHandle;
+    quint64 m_presentedFrames = 0;
+    quint64 m_droppedFrames = 0;
+};
+
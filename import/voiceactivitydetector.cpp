@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "voiceactivitydetector.h"
+
+#include <QtMath>
+
+// Speech windows in a row before it counts, so clicks and bumps don't
+static const int START_WINDOWS = 3;
+// Kept around the speech, in milliseconds
+static const int LEAD_MARGIN = 200;
+static const int TRAIL_MARGIN = 150;
+
+void VoiceActivityDetector::reset(int sampleRate)
+{
+    m_sampleRate = qMax(1, sampleRate);
+    m_windowSize = qMax(1, m_sampleRate / 50);
+    m_state = Silence;
+    m_energy = 0;
+    m_crossings = 0;
+    m_fill = 0;
+    m_lastSample = 0;
+    m_noiseFloor = -1;
+    m_speechWindows = 0;
+    m_silence = 0;
+    m_position = 0;
+    m_speechBegin = -1;
+    m_speechEnd = 0;
+}
+
+VoiceActivityDetector::State VoiceActivityDetector::process(const float *samples, int count)
+{
+    for (int i = 0; i < count && m_state != Ended; ++i) {
+        const float sample = samples[i];
+        m_energy += sample * sample;
+        if ((sample < 0) != (m_lastSample < 0)) {
+            ++m_crossings;
+        }
+        m_lastSample = sample;
+        ++m_position;
+
+        if (++m_fill == m_windowSize) {
+            endWindow();
+        }
+    }
+
+    return m_state;
+}
+
+void VoiceActivityDetector::endWindow()
+{
+    const float rms = qSqrt(m_energy / m_fill);
+    const float crossingRate = float(m_crossings) / m_fill;
+    m_energy = 0;
+    m_crossings = 0;
+    m_fill = 0;
+
+    // Capped, in case somebody is already talking when the recording starts
+    if (m_noiseFloor < 0) {
+        m_noiseFloor = qMin(rms, m_threshold);
+    }
+
+    const bool voiced = rms > qMax(m_threshold, m_noiseFloor * 4);
+    const bool fricative = rms > qMax(m_threshold / 2, m_noiseFloor * 2) && crossingRate > 0.3f;
+
+    if (voiced || fricative) {
+        ++m_speechWindows;
+        m_silence = 0;
+        if (m_state == Silence && m_speechWindows >= START_WINDOWS) {
+            const qint64 start = m_position - qint64(m_speechWindows) * m_windowSize;
+            m_speechBegin = qMax<qint64>(0, start - qint64(LEAD_MARGIN) * m_sampleRate / 1000);
+            m_state = Speech;
+        }
+        if (m_state == Speech) {
+            m_speechEnd = m_position;
+        }
+        return;
+    }
+
+    m_speechWindows = 0;
+    // Only learnt from silence, speech would just raise it
+    m_noiseFloor = 0.95f * m_noiseFloor + 0.05f * rms;
+
+    if (m_state == Speech) {
+        m_silence += m_windowSize;
+        if (m_silence * 1000 >= qint64(m_hangover) * m_sampleRate) {
+            m_state = Ended;
+        }
+    }
+}
+
+VoiceActivityDetector::State VoiceActivityDetector::state() const
+{
+    return m_state;
+}
+
+int VoiceActivityDetector::hangover() const
+{
+    return m_hangover;
+}
+
+void VoiceActivityDetector::setHangover(int hangover)
+{
+    m_hangover = qMax(0, hangover);
+}
+
+float VoiceActivityDetector::threshold() const
+{
+    return m_threshold;
+}
+
+void VoiceActivityDetector::setThreshold(float threshold)
+{
+    m_threshold = qMax(0.0f, threshold);
+}
+
+qint64 VoiceActivityDetector::position() const
+{
+    return m_position;
+}
+
+qint64 VoiceActivityDetector::speechBegin() const
+{
+    if (m_state == Silence) {
+        // Also covers the windows speech needs before it's confirmed
+        return qMax<qint64>(0, m_position - qint64(START_WINDOWS) * m_windowSize - qint64(LEAD_MARGIN) * m_sampleRate / 1000);
+    }
+    return m_speechBegin;
+}
+
+qint64 VoiceActivityDetector::speechEnd() const
+{
+    if (m_state == Silence) {
+        return speechBegin();
+    }
+    return qMin(m_position, m_speechEnd + qint64(TRAIL_MARGIN) * m_sampleRate / 1000);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 by the Mycroft GUI contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * Tells speech from silence in a mono signal, 20ms at a time, from the
+ * energy of each window and how often it crosses zero: voiced sounds are
+ * loud, fricatives like "s" are quieter but cross zero a lot more than
+ * background noise does. The noise floor is learned while nobody speaks,
+ * starting from the threshold at most.
+ *
+ * Speech starts after a few speech windows in a row, and ends once
+ * the hangover passed without any. Positions are in samples since reset(),
+ * with some margin around the speech so its edges don't get clipped.
+ */
+class VoiceActivityDetector
+{
+public:
+    enum State {
+        Silence = 0, // nothing said yet
+        Speech,
+        Ended // silent for longer than the hangover after speech
+    };
+
+    void reset(int sampleRate);
+
+    /**
+     * Feeds count samples between -1 and 1
+     * @returns the state after them
+     */
+    State process(const float *samples, int count);
+    State state() const;
+
+    /**
+     * Silence after the last speech needed to end it, in milliseconds
+     */
+    int hangover() const;
+    void setHangover(int hangover);
+
+    /**
+     * Minimum RMS of speech, whatever the noise floor is
+     */
+    float threshold() const;
+    void setThreshold(float threshold);
+
+    // Samples processed since reset
+    qint64 position() const;
+    // Where the kept audio starts: before the speech, or the earliest it could start while silent
+    qint64 speechBegin() const;
+    // Where the kept audio ends: after the last speech window, never past position()
+    qint64 speechEnd() const;
+
+private:
+    void endWindow();
+
+    State m_state = Silence;
+    int m_sampleRate = 16000;
+    int m_windowSize = 320;
+    int m_hangover = 800;
+    float m_threshold = 0.01f;
+
+    // Window being accumulated
+    double m_energy = 0;
+    int m_crossings = 0;
+    int m_fill = 0;
+    float m_lastSample = 0;
+
+    float m_noiseFloor = -1;
+    int m_speechWindows = 0;
+    qint64 m_silence = 0;
+    qint64 m_position = 0;
+    qint64 m_speechBegin = -1;
+    qint64 m_speechEnd = 0;
+};
+